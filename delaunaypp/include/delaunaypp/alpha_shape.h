@@ -0,0 +1,174 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "geometry.h"
+#include "mesh.h"
+
+namespace delaunaypp
+{
+	namespace internal
+	{
+		template<typename MeshType>
+		double circumradius(const MeshType &mesh, const std::size_t &triangle)
+		{
+			const auto &triangles = mesh.triangles();
+			const auto &a = mesh.vertex(triangles[3 * triangle]);
+			return std::sqrt(squared_distance(circumcenter(a, mesh.vertex(triangles[3 * triangle + 1]),
+				mesh.vertex(triangles[3 * triangle + 2])), a));
+		}
+
+		/**
+		* Chain the halfedges that separate included from excluded triangles into rings of vertex indices.
+		* candidates are the included triangles; included(t) tells whether triangle t is part of the shape.
+		*/
+		template<typename MeshType, typename Included>
+		std::vector<std::vector<std::size_t>> boundary_loops(const MeshType &mesh, const std::vector<std::size_t> &candidates,
+			Included included)
+		{
+			const auto &triangles = mesh.triangles();
+			const auto &halfedges = mesh.halfedges();
+			std::vector<std::size_t> boundary{};
+			for (const auto &triangle : candidates)
+			{
+				for (std::size_t i = 0; i < 3; i++)
+				{
+					if (!included(halfedges[3 * triangle + i] / 3))
+					{
+						boundary.push_back(3 * triangle + i);
+					}
+				}
+			}
+			std::sort(boundary.begin(), boundary.end());
+
+			// the shape lies left of every boundary halfedge a->b. The next one starts at b and is found by turning
+			// clockwise around b through included triangles, which keeps loops that touch at a vertex apart.
+			std::vector<bool> visited(boundary.size(), false);
+			std::vector<std::vector<std::size_t>> loops{};
+			for (std::size_t i = 0; i < boundary.size(); i++)
+			{
+				if (visited[i])
+				{
+					continue;
+				}
+				std::vector<std::size_t> loop{};
+				auto index = i;
+				while (!visited[index])
+				{
+					visited[index] = true;
+					const auto e = boundary[index];
+					loop.push_back(triangles[e]);
+					auto n = MeshType::next(e);
+					while (included(halfedges[n] / 3))
+					{
+						n = MeshType::next(halfedges[n]);
+					}
+					index = static_cast<std::size_t>(std::lower_bound(boundary.begin(), boundary.end(), n) - boundary.begin());
+				}
+				loops.push_back(std::move(loop));
+			}
+			return loops;
+		}
+	}
+
+	/**
+	* Alpha shape of a triangulation: the union of the finite triangles whose circumradius is at most alpha.
+	* Returns its boundary as rings of vertex indices, outer boundaries counter clockwise and holes clockwise.
+	* An infinite alpha gives the convex hull, smaller values carve it into a concave hull.
+	*/
+	template<typename PointType, typename T>
+	std::vector<std::vector<std::size_t>> alpha_shape(const mesh<PointType, T> &mesh, const double &alpha)
+	{
+		std::vector<std::size_t> candidates{};
+		std::vector<bool> inside(mesh.triangle_count(), false);
+		for (std::size_t t = 0; t < mesh.triangle_count(); t++)
+		{
+			if (!mesh.is_ghost(t) && internal::circumradius(mesh, t) <= alpha)
+			{
+				inside[t] = true;
+				candidates.push_back(t);
+			}
+		}
+		return internal::boundary_loops(mesh, candidates, [&inside](const std::size_t &t) { return inside[t]; });
+	}
+
+	/**
+	* The alpha spectrum of a triangulation: its finite triangles sorted by circumradius. Built once in
+	* O(n log n), after which the alpha shape for any alpha costs time proportional to the triangles it
+	* contains. The mesh must outlive the spectrum and stay unchanged.
+	*/
+	template<typename PointType, typename T = typename PointType::value_type>
+	class alpha_spectrum
+	{
+	public:
+		explicit alpha_spectrum(const mesh<PointType, T> &mesh);
+
+		std::vector<std::vector<std::size_t>> boundary(const double &alpha) const;
+		std::size_t triangle_count(const double &alpha) const;
+		const std::vector<double>& critical_values() const;
+
+	private:
+		const mesh<PointType, T> &mesh_;
+		// finite triangles by increasing circumradius, their radii, and every triangle's position in that order.
+		std::vector<std::size_t> order_;
+		std::vector<double> radii_;
+		std::vector<std::size_t> rank_;
+	};
+
+	template <typename PointType, typename T>
+	alpha_spectrum<PointType, T>::alpha_spectrum(const mesh<PointType, T>& mesh)
+		: mesh_(mesh), rank_(mesh.triangle_count(), std::numeric_limits<std::size_t>::max())
+	{
+		std::vector<std::pair<double, std::size_t>> keys{};
+		keys.reserve(mesh.finite_triangle_count());
+		for (std::size_t t = 0; t < mesh.triangle_count(); t++)
+		{
+			if (!mesh.is_ghost(t))
+			{
+				keys.emplace_back(internal::circumradius(mesh, t), t);
+			}
+		}
+		std::sort(keys.begin(), keys.end());
+		order_.resize(keys.size());
+		radii_.resize(keys.size());
+		for (std::size_t i = 0; i < keys.size(); i++)
+		{
+			radii_[i] = keys[i].first;
+			order_[i] = keys[i].second;
+			rank_[keys[i].second] = i;
+		}
+	}
+
+	/**
+	* Boundary rings of the alpha shape, as alpha_shape() returns them.
+	*/
+	template <typename PointType, typename T>
+	std::vector<std::vector<std::size_t>> alpha_spectrum<PointType, T>::boundary(const double& alpha) const
+	{
+		const auto count = triangle_count(alpha);
+		const std::vector<std::size_t> candidates(order_.begin(), order_.begin() + count);
+		const auto &rank = rank_;
+		return internal::boundary_loops(mesh_, candidates, [&rank, count](const std::size_t &t) { return rank[t] < count; });
+	}
+
+	/**
+	* Number of triangles in the alpha shape.
+	*/
+	template <typename PointType, typename T>
+	std::size_t alpha_spectrum<PointType, T>::triangle_count(const double& alpha) const
+	{
+		return static_cast<std::size_t>(std::upper_bound(radii_.begin(), radii_.end(), alpha) - radii_.begin());
+	}
+
+	/**
+	* The sorted circumradii, the alpha values at which the shape changes.
+	*/
+	template <typename PointType, typename T>
+	const std::vector<double>& alpha_spectrum<PointType, T>::critical_values() const
+	{
+		return radii_;
+	}
+}
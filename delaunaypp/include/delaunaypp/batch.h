@@ -0,0 +1,202 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "mesh.h"
+
+namespace delaunaypp
+{
+	/**
+	* Settings for triangulate_batch().
+	*/
+	struct batch_options
+	{
+		// worker threads, zero for one per hardware thread.
+		std::size_t threads = 0;
+
+		// sets are handed to the workers in chunks of about this many points.
+		std::size_t chunk_points = 4096;
+	};
+
+	/**
+	* Triangles of many point sets in one buffer. The triangles of set s are offsets[s] ... offsets[s + 1] - 1,
+	* and corner i of triangle t is triangles[3t + i], an index into the flat point buffer.
+	*/
+	struct batch_triangulation
+	{
+		std::vector<std::size_t> offsets;
+		std::vector<std::size_t> triangles;
+	};
+
+	namespace internal
+	{
+		/**
+		* Run task(worker, chunk) for every chunk in [0, count) on the given number of threads. Every worker starts
+		* with an even share of the chunks and takes them from the front; a worker that runs out steals the back
+		* half of the largest share left. Shares are (begin, end) pairs packed into one word and changed by compare
+		* and swap only. A chunk never returns to a share once it left, so the swaps cannot mistake an old share
+		* for a new one.
+		*/
+		template<typename Task>
+		void work_stealing(const std::size_t &count, std::size_t threads, Task task)
+		{
+			threads = std::max<std::size_t>(1, std::min(threads, count));
+			auto pack = [](const std::uint64_t &begin, const std::uint64_t &end) { return (begin << 32) | end; };
+			std::vector<std::atomic<std::uint64_t>> shares(threads);
+			for (std::size_t i = 0; i < threads; i++)
+			{
+				shares[i].store(pack(count * i / threads, count * (i + 1) / threads));
+			}
+
+			auto work = [&](const std::size_t &worker)
+			{
+				while (true)
+				{
+					auto share = shares[worker].load();
+					const auto begin = share >> 32;
+					const auto end = share & 0xffffffffu;
+					if (begin < end)
+					{
+						if (shares[worker].compare_exchange_weak(share, pack(begin + 1, end)))
+						{
+							task(worker, static_cast<std::size_t>(begin));
+						}
+						continue;
+					}
+
+					auto victim = worker;
+					std::uint64_t most = 0;
+					for (std::size_t i = 0; i < threads; i++)
+					{
+						const auto other = shares[i].load();
+						if ((other & 0xffffffffu) > (other >> 32) && (other & 0xffffffffu) - (other >> 32) > most)
+						{
+							most = (other & 0xffffffffu) - (other >> 32);
+							victim = i;
+						}
+					}
+					if (most == 0)
+					{
+						return;
+					}
+					auto stolen = shares[victim].load();
+					const auto stolen_begin = stolen >> 32;
+					const auto stolen_end = stolen & 0xffffffffu;
+					if (stolen_begin >= stolen_end)
+					{
+						continue;
+					}
+					const auto middle = stolen_end - (stolen_end - stolen_begin + 1) / 2;
+					if (shares[victim].compare_exchange_strong(stolen, pack(stolen_begin, middle)))
+					{
+						shares[worker].store(pack(middle, stolen_end));
+					}
+				}
+			};
+
+			std::vector<std::thread> workers{};
+			for (std::size_t i = 1; i < threads; i++)
+			{
+				workers.emplace_back(work, i);
+			}
+			work(0);
+			for (auto &worker : workers)
+			{
+				worker.join();
+			}
+		}
+	}
+
+	/**
+	* Triangulate many small, independent point sets at once. Set s holds points[offsets[s]] ...
+	* points[offsets[s + 1] - 1]. The sets are spread over the threads by work stealing; every thread keeps one
+	* mesh and one output buffer for all its sets, so after warming up a set costs no allocation. The results
+	* are then copied into one flat buffer in set order. A set gives the triangles mesh::triangulate() would.
+	*/
+	template<typename PointType, typename T = typename PointType::value_type>
+	batch_triangulation triangulate_batch(const std::vector<PointType> &points, const std::vector<std::size_t> &offsets,
+		const batch_options &options = batch_options())
+	{
+		for (std::size_t s = 0; s + 1 < offsets.size(); s++)
+		{
+			if (offsets[s] > offsets[s + 1])
+			{
+				throw std::runtime_error("Set offsets must not decrease.");
+			}
+		}
+		if (!offsets.empty() && offsets.back() > points.size())
+		{
+			throw std::runtime_error("Set offsets exceed the point buffer.");
+		}
+		batch_triangulation result{};
+		const auto set_count = offsets.empty() ? 0 : offsets.size() - 1;
+		result.offsets.assign(set_count + 1, 0);
+		if (set_count == 0)
+		{
+			return result;
+		}
+
+		// chunks of consecutive sets with about chunk_points points each.
+		std::vector<std::size_t> chunks{ 0 };
+		for (std::size_t s = 0; s < set_count; s++)
+		{
+			if (offsets[s + 1] - offsets[chunks.back()] >= options.chunk_points || s + 1 == set_count)
+			{
+				chunks.push_back(s + 1);
+			}
+		}
+		const auto chunk_count = chunks.size() - 1;
+		const auto threads = options.threads > 0 ? options.threads : static_cast<std::size_t>(std::thread::hardware_concurrency());
+
+		// each set's triangles go to the buffer of the worker that triangulated it.
+		struct arena
+		{
+			mesh<PointType, T> scratch;
+			std::vector<std::size_t> triangles;
+		};
+		std::vector<arena> arenas(std::max<std::size_t>(1, std::min(threads, chunk_count)));
+		std::vector<std::size_t> owners(set_count), starts(set_count);
+		internal::work_stealing(chunk_count, arenas.size(), [&](const std::size_t &worker, const std::size_t &chunk)
+		{
+			auto &local = arenas[worker];
+			for (auto s = chunks[chunk]; s < chunks[chunk + 1]; s++)
+			{
+				owners[s] = worker;
+				starts[s] = local.triangles.size();
+				local.scratch.assign(points.begin() + offsets[s], points.begin() + offsets[s + 1]);
+				local.scratch.triangulate();
+				const auto &triangles = local.scratch.triangles();
+				for (std::size_t t = 0; t < local.scratch.triangle_count(); t++)
+				{
+					if (!local.scratch.is_ghost(t))
+					{
+						local.triangles.push_back(offsets[s] + triangles[3 * t]);
+						local.triangles.push_back(offsets[s] + triangles[3 * t + 1]);
+						local.triangles.push_back(offsets[s] + triangles[3 * t + 2]);
+					}
+				}
+				result.offsets[s + 1] = local.scratch.finite_triangle_count();
+			}
+		});
+
+		for (std::size_t s = 0; s < set_count; s++)
+		{
+			result.offsets[s + 1] += result.offsets[s];
+		}
+		result.triangles.resize(3 * result.offsets.back());
+		internal::work_stealing(chunk_count, arenas.size(), [&](const std::size_t &, const std::size_t &chunk)
+		{
+			for (auto s = chunks[chunk]; s < chunks[chunk + 1]; s++)
+			{
+				const auto &source = arenas[owners[s]].triangles;
+				std::copy(source.begin() + starts[s], source.begin() + starts[s] + 3 * (result.offsets[s + 1] - result.offsets[s]),
+					result.triangles.begin() + 3 * result.offsets[s]);
+			}
+		});
+		return result;
+	}
+}
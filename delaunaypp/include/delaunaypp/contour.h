@@ -0,0 +1,258 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "interpolation.h"
+#include "mesh.h"
+#include "point.h"
+
+namespace delaunaypp
+{
+	/**
+	* Settings for extract_contours().
+	*/
+	struct contour_options
+	{
+		// worker threads, zero for one per hardware thread. Meshes with fewer triangles than parallel_threshold
+		// stay on the calling thread.
+		std::size_t threads = 1;
+		std::size_t parallel_threshold = 1 << 16;
+	};
+
+	/**
+	* One isoline. Higher values lie on its left. A closed line ends next to where it starts; the first point
+	* is not repeated. An open line starts and ends on the convex hull.
+	*/
+	struct contour_line
+	{
+		// index of the line's level in the requested levels.
+		std::size_t level;
+		bool closed;
+		std::vector<point<double>> points;
+	};
+
+	namespace internal
+	{
+		/**
+		* Number of values in the sorted, non empty vector that are smaller than value: std::lower_bound without
+		* branches, since the values of neighbouring triangles fall on either side of a level at random.
+		*/
+		inline std::size_t count_below(const std::vector<double> &sorted, const double &value)
+		{
+			const auto *base = sorted.data();
+			auto size = sorted.size();
+			while (size > 1)
+			{
+				const auto half = size / 2;
+				base = base[half - 1] < value ? base + half : base;
+				size -= half;
+			}
+			return static_cast<std::size_t>(base - sorted.data()) + (*base < value ? 1 : 0);
+		}
+	}
+
+	/**
+	* Isolines of the piecewise linear field given by one value per vertex, for all levels at once. A first pass
+	* over the triangles finds the range of levels crossing each of them by binary search in the sorted levels,
+	* which also numbers every line segment. Lines are then traced from triangle to triangle across the shared
+	* edges, so each segment is visited once and every crossing point computed once. Vertices with a value equal
+	* to a level count as below it, which keeps the lines apart where they touch vertices. The first pass runs
+	* over chunks of triangles and the tracing over blocks of levels with about equal numbers of segments, one
+	* per thread. Lines come in ascending order of level.
+	*/
+	template<typename PointType, typename T, typename ValueType>
+	std::vector<contour_line> extract_contours(const mesh<PointType, T> &mesh, const std::vector<ValueType> &values,
+		const std::vector<double> &levels, const contour_options &options = contour_options())
+	{
+		using MeshType = delaunaypp::mesh<PointType, T>;
+		if (values.size() < mesh.vertex_count())
+		{
+			throw std::runtime_error("Expected one value per vertex.");
+		}
+		std::vector<contour_line> lines{};
+		const auto count = mesh.triangle_count();
+		if (levels.empty() || mesh.finite_triangle_count() == 0)
+		{
+			return lines;
+		}
+		std::vector<std::size_t> order(levels.size());
+		for (std::size_t i = 0; i < order.size(); i++)
+		{
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&levels](const std::size_t &first, const std::size_t &second)
+		{
+			return levels[first] < levels[second];
+		});
+		std::vector<double> sorted(levels.size());
+		std::vector<std::size_t> rank(levels.size());
+		for (std::size_t i = 0; i < order.size(); i++)
+		{
+			sorted[i] = levels[order[i]];
+			rank[order[i]] = i;
+		}
+
+		auto threads = options.threads > 0 ? options.threads : static_cast<std::size_t>(std::thread::hardware_concurrency());
+		if (count < options.parallel_threshold)
+		{
+			threads = 1;
+		}
+		interpolation_options parallel{};
+		parallel.threads = threads;
+		parallel.parallel_threshold = 1;
+
+		// the levels crossing triangle t are first[t] ... first[t] + crossings[t] - 1: those from its smallest
+		// value up to, but not including, its largest.
+		const auto &triangles = mesh.triangles();
+		std::vector<std::uint32_t> first(count), crossings(count);
+		internal::parallel_ranges(count, parallel, [&](std::size_t begin, std::size_t end)
+		{
+			for (auto t = begin; t < end; t++)
+			{
+				if (mesh.is_ghost(t))
+				{
+					first[t] = 0;
+					crossings[t] = 0;
+					continue;
+				}
+				const auto a = static_cast<double>(values[triangles[3 * t]]);
+				const auto b = static_cast<double>(values[triangles[3 * t + 1]]);
+				const auto c = static_cast<double>(values[triangles[3 * t + 2]]);
+				const auto low = internal::count_below(sorted, std::min(a, std::min(b, c)));
+				first[t] = static_cast<std::uint32_t>(low);
+				crossings[t] = static_cast<std::uint32_t>(internal::count_below(sorted, std::max(a, std::max(b, c))) - low);
+			}
+		});
+
+		// number the segments triangle by triangle and count them per level.
+		std::vector<std::size_t> offsets(count + 1, 0);
+		std::vector<std::size_t> per_level(sorted.size() + 1, 0);
+		for (std::size_t t = 0; t < count; t++)
+		{
+			offsets[t + 1] = offsets[t] + crossings[t];
+			per_level[first[t]] += crossings[t] > 0 ? 1 : 0;
+			per_level[first[t] + crossings[t]] -= crossings[t] > 0 ? 1 : 0;
+		}
+		for (std::size_t k = 1; k < per_level.size(); k++)
+		{
+			per_level[k] += per_level[k - 1];
+		}
+		std::vector<std::size_t> blocks{ 0 };
+		std::size_t segments = 0;
+		for (std::size_t k = 0; k < sorted.size(); k++)
+		{
+			segments += per_level[k];
+			if (segments * threads >= offsets[count] * blocks.size() && blocks.size() < threads)
+			{
+				blocks.push_back(k + 1);
+			}
+		}
+		while (blocks.size() <= threads)
+		{
+			blocks.push_back(sorted.size());
+		}
+
+		std::vector<std::uint8_t> visited(offsets[count], 0);
+		std::vector<std::vector<contour_line>> traced(threads);
+		internal::parallel_ranges(threads, parallel, [&](std::size_t begin, std::size_t end)
+		{
+			for (auto block = begin; block < end; block++)
+			{
+				const auto low = blocks[block];
+				const auto high = blocks[block + 1];
+				std::vector<point<double>> before{};
+				for (std::size_t t = 0; t < count && low < high; t++)
+				{
+					const auto from = std::max<std::size_t>(first[t], low);
+					const auto to = std::min<std::size_t>(first[t] + crossings[t], high);
+					for (auto k = from; k < to; k++)
+					{
+						if (visited[offsets[t] + k - first[t]])
+						{
+							continue;
+						}
+						const auto level = sorted[k];
+						// the line enters a triangle over the edge running from above to below and leaves over the
+						// one running from below to above. Both follow from which corners lie above the level.
+						auto crossing_edge = [&](const std::size_t &triangle, const bool &entering)
+						{
+							static const std::uint8_t entries[8] = { 0, 0, 1, 1, 2, 0, 2, 0 };
+							static const std::uint8_t exits[8] = { 0, 2, 0, 2, 1, 1, 0, 0 };
+							const auto corners = (static_cast<double>(values[triangles[3 * triangle]]) > level ? 1 : 0) |
+								(static_cast<double>(values[triangles[3 * triangle + 1]]) > level ? 2 : 0) |
+								(static_cast<double>(values[triangles[3 * triangle + 2]]) > level ? 4 : 0);
+							return 3 * triangle + (entering ? entries[corners] : exits[corners]);
+						};
+						auto crossing_point = [&](const std::size_t &halfedge)
+						{
+							auto u = triangles[halfedge];
+							auto v = triangles[MeshType::next(halfedge)];
+							if (u > v)
+							{
+								std::swap(u, v);
+							}
+							const auto &p = mesh.vertex(u);
+							const auto &q = mesh.vertex(v);
+							const auto pu = static_cast<double>(values[u]);
+							const auto s = (level - pu) / (static_cast<double>(values[v]) - pu);
+							const auto px = static_cast<double>(p.x());
+							const auto py = static_cast<double>(p.y());
+							return point<double>(px + s * (static_cast<double>(q.x()) - px), py + s * (static_cast<double>(q.y()) - py));
+						};
+
+						// follow the line from t until it closes or reaches the hull, and an open line back from t to
+						// its start.
+						contour_line line{ order[k], false, {} };
+						line.points.push_back(crossing_point(crossing_edge(t, true)));
+						auto current = t;
+						while (true)
+						{
+							visited[offsets[current] + k - first[current]] = 1;
+							const auto exit = crossing_edge(current, false);
+							current = mesh.twin(exit) / 3;
+							if (current == t)
+							{
+								line.closed = true;
+								break;
+							}
+							line.points.push_back(crossing_point(exit));
+							if (mesh.is_ghost(current))
+							{
+								break;
+							}
+						}
+						current = t;
+						before.clear();
+						while (!line.closed)
+						{
+							current = mesh.twin(crossing_edge(current, true)) / 3;
+							if (mesh.is_ghost(current))
+							{
+								break;
+							}
+							visited[offsets[current] + k - first[current]] = 1;
+							before.push_back(crossing_point(crossing_edge(current, true)));
+						}
+						line.points.insert(line.points.begin(), before.rbegin(), before.rend());
+						traced[block].push_back(std::move(line));
+					}
+				}
+				// the triangles were scanned in order, so each level's lines stay in the same order on any thread.
+				std::stable_sort(traced[block].begin(), traced[block].end(), [&rank](const contour_line &first, const contour_line &second)
+				{
+					return rank[first.level] < rank[second.level];
+				});
+			}
+		});
+
+		for (auto &block : traced)
+		{
+			std::move(block.begin(), block.end(), std::back_inserter(lines));
+		}
+		return lines;
+	}
+}
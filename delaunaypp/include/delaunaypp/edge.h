@@ -64,8 +64,12 @@ namespace delaunaypp
 		template <typename PointType, typename T>
 		bool edge<PointType, T>::operator<(const edge& other) const
 		{
-			return (start() == other.start() ? end() < other.end() : start() < other.start()) &&
-				!(*this == other);
+			// edges are undirected, as in operator==, so compare the end points in sorted order.
+			const auto low = end() < start() ? end() : start();
+			const auto high = end() < start() ? start() : end();
+			const auto other_low = other.end() < other.start() ? other.end() : other.start();
+			const auto other_high = other.end() < other.start() ? other.start() : other.end();
+			return low < other_low || (low == other_low && high < other_high);
 		}
 
 		template <typename PointType, typename T>
@@ -0,0 +1,308 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace delaunaypp
+{
+	namespace io
+	{
+		/**
+		* Read only memory mapping of a whole file. The mapping is released when the object is destroyed.
+		*/
+		class mapped_file
+		{
+		public:
+			mapped_file() = default;
+			explicit mapped_file(const std::string &path);
+			~mapped_file();
+			mapped_file(const mapped_file &other) = delete;
+			mapped_file(mapped_file &&other) noexcept;
+			mapped_file& operator=(const mapped_file &other) = delete;
+			mapped_file& operator=(mapped_file &&other) noexcept;
+
+			const char* data() const;
+			std::size_t size() const;
+			bool is_open() const;
+			void close();
+
+		private:
+			const char *data_ = nullptr;
+			std::size_t size_ = 0;
+#if defined(_WIN32)
+			HANDLE file_ = INVALID_HANDLE_VALUE;
+			HANDLE mapping_ = nullptr;
+#else
+			int file_ = -1;
+#endif
+		};
+
+		/**
+		* Buffered binary file writer. Data is collected in a fixed size chunk and handed to the
+		* OS only when the chunk is full, so writing many small records stays cheap.
+		*/
+		class file_writer
+		{
+		public:
+			explicit file_writer(const std::string &path, std::size_t chunk_size = 1 << 20);
+			~file_writer();
+			file_writer(const file_writer &other) = delete;
+			file_writer& operator=(const file_writer &other) = delete;
+
+			void write(const void *data, std::size_t size);
+			template<typename Value>
+			void write_value(const Value &value);
+			void flush();
+			void close();
+			std::size_t bytes_written() const;
+
+		private:
+			std::FILE *file_;
+			std::vector<char> buffer_;
+			std::size_t used_;
+			std::size_t written_;
+		};
+
+		inline mapped_file::mapped_file(const std::string& path)
+		{
+#if defined(_WIN32)
+			file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+				OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file_ == INVALID_HANDLE_VALUE)
+			{
+				throw std::runtime_error("Unable to open file: " + path);
+			}
+			LARGE_INTEGER file_size;
+			if (!GetFileSizeEx(file_, &file_size))
+			{
+				close();
+				throw std::runtime_error("Unable to query file size: " + path);
+			}
+			size_ = static_cast<std::size_t>(file_size.QuadPart);
+			if (size_ == 0)
+			{
+				return;
+			}
+			mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping_ == nullptr)
+			{
+				close();
+				throw std::runtime_error("Unable to map file: " + path);
+			}
+			data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+			if (data_ == nullptr)
+			{
+				close();
+				throw std::runtime_error("Unable to map file: " + path);
+			}
+#else
+			file_ = ::open(path.c_str(), O_RDONLY);
+			if (file_ < 0)
+			{
+				throw std::runtime_error("Unable to open file: " + path);
+			}
+			struct stat file_stat;
+			if (::fstat(file_, &file_stat) != 0)
+			{
+				close();
+				throw std::runtime_error("Unable to query file size: " + path);
+			}
+			size_ = static_cast<std::size_t>(file_stat.st_size);
+			if (size_ == 0)
+			{
+				return;
+			}
+			auto address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_, 0);
+			if (address == MAP_FAILED)
+			{
+				close();
+				throw std::runtime_error("Unable to map file: " + path);
+			}
+			data_ = static_cast<const char*>(address);
+			::madvise(address, size_, MADV_SEQUENTIAL);
+#endif
+		}
+
+		inline mapped_file::~mapped_file()
+		{
+			close();
+		}
+
+		inline mapped_file::mapped_file(mapped_file&& other) noexcept
+		{
+			*this = std::move(other);
+		}
+
+		inline mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+		{
+			if (this == &other)
+			{
+				return *this;
+			}
+			close();
+			std::swap(data_, other.data_);
+			std::swap(size_, other.size_);
+			std::swap(file_, other.file_);
+#if defined(_WIN32)
+			std::swap(mapping_, other.mapping_);
+#endif
+			return *this;
+		}
+
+		inline const char* mapped_file::data() const
+		{
+			return data_;
+		}
+
+		inline std::size_t mapped_file::size() const
+		{
+			return size_;
+		}
+
+		inline bool mapped_file::is_open() const
+		{
+#if defined(_WIN32)
+			return file_ != INVALID_HANDLE_VALUE;
+#else
+			return file_ >= 0;
+#endif
+		}
+
+		inline void mapped_file::close()
+		{
+#if defined(_WIN32)
+			if (data_ != nullptr)
+			{
+				UnmapViewOfFile(data_);
+			}
+			if (mapping_ != nullptr)
+			{
+				CloseHandle(mapping_);
+			}
+			if (file_ != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(file_);
+			}
+			mapping_ = nullptr;
+			file_ = INVALID_HANDLE_VALUE;
+#else
+			if (data_ != nullptr)
+			{
+				::munmap(const_cast<char*>(data_), size_);
+			}
+			if (file_ >= 0)
+			{
+				::close(file_);
+			}
+			file_ = -1;
+#endif
+			data_ = nullptr;
+			size_ = 0;
+		}
+
+		inline file_writer::file_writer(const std::string& path, std::size_t chunk_size) :
+			file_(std::fopen(path.c_str(), "wb")), buffer_(chunk_size > 0 ? chunk_size : 1), used_(0), written_(0)
+		{
+			if (file_ == nullptr)
+			{
+				throw std::runtime_error("Unable to open file for writing: " + path);
+			}
+		}
+
+		inline file_writer::~file_writer()
+		{
+			try
+			{
+				close();
+			}
+			catch (...)
+			{
+			}
+		}
+
+		inline void file_writer::write(const void* data, std::size_t size)
+		{
+			auto bytes = static_cast<const char*>(data);
+			written_ += size;
+			if (used_ + size > buffer_.size())
+			{
+				flush();
+				if (size >= buffer_.size())
+				{
+					// large blocks go straight to the file.
+					if (std::fwrite(bytes, 1, size, file_) != size)
+					{
+						throw std::runtime_error("Unable to write to file.");
+					}
+					return;
+				}
+			}
+			std::memcpy(buffer_.data() + used_, bytes, size);
+			used_ += size;
+		}
+
+		template <typename Value>
+		void file_writer::write_value(const Value& value)
+		{
+			static_assert(std::is_trivially_copyable<Value>::value, "Value must be trivially copyable.");
+			write(&value, sizeof(Value));
+		}
+
+		inline void file_writer::flush()
+		{
+			if (used_ > 0 && std::fwrite(buffer_.data(), 1, used_, file_) != used_)
+			{
+				throw std::runtime_error("Unable to write to file.");
+			}
+			used_ = 0;
+		}
+
+		inline void file_writer::close()
+		{
+			if (file_ == nullptr)
+			{
+				return;
+			}
+			try
+			{
+				flush();
+			}
+			catch (...)
+			{
+				// close the file anyway, the destructor would only run into the same error again.
+				std::fclose(file_);
+				file_ = nullptr;
+				used_ = 0;
+				throw;
+			}
+			auto result = std::fclose(file_);
+			file_ = nullptr;
+			if (result != 0)
+			{
+				throw std::runtime_error("Unable to close file.");
+			}
+		}
+
+		inline std::size_t file_writer::bytes_written() const
+		{
+			return written_;
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "point.h"
+
+namespace delaunaypp
+{
+	/**
+	* Circumcenter of the triangle abc, computed relative to a to limit cancellation. The result is not
+	* finite for collinear points.
+	*/
+	template<typename PointType>
+	point<double> circumcenter(const PointType &a, const PointType &b, const PointType &c)
+	{
+		const auto bx = static_cast<double>(b.x()) - static_cast<double>(a.x());
+		const auto by = static_cast<double>(b.y()) - static_cast<double>(a.y());
+		const auto cx = static_cast<double>(c.x()) - static_cast<double>(a.x());
+		const auto cy = static_cast<double>(c.y()) - static_cast<double>(a.y());
+		const auto b_length = bx * bx + by * by;
+		const auto c_length = cx * cx + cy * cy;
+		const auto d = 0.5 / (bx * cy - by * cx);
+		return point<double>(static_cast<double>(a.x()) + (cy * b_length - by * c_length) * d,
+			static_cast<double>(a.y()) + (bx * c_length - cx * b_length) * d);
+	}
+
+	/**
+	* Power center of the weighted points (a, aw), (b, bw) and (c, cw): the point with equal power distance
+	* |x - p|^2 - w to all three. With equal weights this is the circumcenter.
+	*/
+	template<typename PointType>
+	point<double> power_center(const PointType &a, const double &aw, const PointType &b, const double &bw,
+		const PointType &c, const double &cw)
+	{
+		const auto bx = static_cast<double>(b.x()) - static_cast<double>(a.x());
+		const auto by = static_cast<double>(b.y()) - static_cast<double>(a.y());
+		const auto cx = static_cast<double>(c.x()) - static_cast<double>(a.x());
+		const auto cy = static_cast<double>(c.y()) - static_cast<double>(a.y());
+		const auto b_length = bx * bx + by * by - (bw - aw);
+		const auto c_length = cx * cx + cy * cy - (cw - aw);
+		const auto d = 0.5 / (bx * cy - by * cx);
+		return point<double>(static_cast<double>(a.x()) + (cy * b_length - by * c_length) * d,
+			static_cast<double>(a.y()) + (bx * c_length - cx * b_length) * d);
+	}
+
+	template<typename FirstPointType, typename SecondPointType>
+	double squared_distance(const FirstPointType &first, const SecondPointType &second)
+	{
+		const auto dx = static_cast<double>(first.x()) - static_cast<double>(second.x());
+		const auto dy = static_cast<double>(first.y()) - static_cast<double>(second.y());
+		return dx * dx + dy * dy;
+	}
+
+	/**
+	* Signed area of the triangle abc, positive when it is counter clockwise.
+	*/
+	template<typename PointType>
+	double signed_area(const PointType &a, const PointType &b, const PointType &c)
+	{
+		return 0.5 * ((static_cast<double>(b.x()) - static_cast<double>(a.x())) * (static_cast<double>(c.y()) - static_cast<double>(a.y())) -
+			(static_cast<double>(b.y()) - static_cast<double>(a.y())) * (static_cast<double>(c.x()) - static_cast<double>(a.x())));
+	}
+}
@@ -0,0 +1,432 @@
+#pragma once
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "geometry.h"
+#include "mesh.h"
+#include "point.h"
+
+namespace delaunaypp
+{
+	/**
+	* Undirected graph over the vertices of a mesh in compressed sparse row form. The neighbors of vertex v are
+	* targets[offsets[v]] ... targets[offsets[v + 1] - 1], and every edge is listed once from each end.
+	*/
+	struct adjacency_graph
+	{
+		std::vector<std::size_t> offsets;
+		std::vector<std::size_t> targets;
+	};
+
+	namespace internal
+	{
+		/**
+		* Call edge(halfedge) for one halfedge of every undirected finite edge of the mesh.
+		*/
+		template<typename MeshType, typename Edge>
+		void for_each_edge(const MeshType &mesh, Edge edge)
+		{
+			const auto &triangles = mesh.triangles();
+			const auto &halfedges = mesh.halfedges();
+			for (std::size_t e = 0; e < triangles.size(); e++)
+			{
+				if (e < halfedges[e] && triangles[e] != infinite_vertex && triangles[MeshType::next(e)] != infinite_vertex)
+				{
+					edge(e);
+				}
+			}
+		}
+
+		/**
+		* Counting sort of undirected edges into an adjacency_graph over vertex_count vertices.
+		*/
+		inline adjacency_graph make_graph(const std::size_t &vertex_count, const std::vector<std::pair<std::size_t, std::size_t>> &edges)
+		{
+			adjacency_graph graph{};
+			graph.offsets.assign(vertex_count + 1, 0);
+			for (const auto &edge : edges)
+			{
+				graph.offsets[edge.first + 1]++;
+				graph.offsets[edge.second + 1]++;
+			}
+			std::partial_sum(graph.offsets.begin(), graph.offsets.end(), graph.offsets.begin());
+			graph.targets.resize(2 * edges.size());
+			std::vector<std::size_t> fill(graph.offsets.begin(), graph.offsets.end() - 1);
+			for (const auto &edge : edges)
+			{
+				graph.targets[fill[edge.first]++] = edge.second;
+				graph.targets[fill[edge.second]++] = edge.first;
+			}
+			return graph;
+		}
+
+		/**
+		* Union-find with path halving and union by size.
+		*/
+		class disjoint_sets
+		{
+		public:
+			explicit disjoint_sets(const std::size_t &count)
+				: parent_(count), size_(count, 1)
+			{
+				std::iota(parent_.begin(), parent_.end(), std::size_t(0));
+			}
+
+			std::size_t find(std::size_t element)
+			{
+				while (parent_[element] != element)
+				{
+					parent_[element] = parent_[parent_[element]];
+					element = parent_[element];
+				}
+				return element;
+			}
+
+			// merge the sets of first and second; false when they already were one set.
+			bool unite(const std::size_t &first, const std::size_t &second)
+			{
+				auto a = find(first);
+				auto b = find(second);
+				if (a == b)
+				{
+					return false;
+				}
+				if (size_[a] < size_[b])
+				{
+					std::swap(a, b);
+				}
+				parent_[b] = a;
+				size_[a] += size_[b];
+				return true;
+			}
+
+		private:
+			std::vector<std::size_t> parent_;
+			std::vector<std::size_t> size_;
+		};
+
+		/**
+		* Static 2-d tree over the inserted vertices of a mesh, for the lune searches of the relative neighborhood
+		* graph. Node k covers a range of the vertex order, keeps the bounding box of its vertices and splits the
+		* range at the middle, by x or y, whichever the box is wider in, into nodes 2k + 1 and 2k + 2.
+		*/
+		template<typename MeshType>
+		class lune_tree
+		{
+		public:
+			explicit lune_tree(const MeshType &mesh);
+
+			// whether no vertex is closer than |ab| to both a and b.
+			bool is_empty(const std::size_t &a, const std::size_t &b) const;
+
+		private:
+			static constexpr std::size_t leaf_size = 8;
+			// a range of 2^64 vertices is split at most 64 times.
+			static constexpr std::size_t stack_size = 2 * 65;
+
+			struct entry
+			{
+				point<double> position;
+				std::size_t vertex;
+			};
+
+			const MeshType &mesh_;
+			// the vertices with their positions, so that the tree is built and the leaves are scanned in place.
+			std::vector<entry> entries_;
+			// min x, min y, max x, max y of every node.
+			std::vector<double> boxes_;
+
+			void build(const std::size_t &node, const std::size_t &begin, const std::size_t &end);
+			double box_distance(const std::size_t &node, const point<double> &position) const;
+		};
+
+		template <typename MeshType>
+		constexpr std::size_t lune_tree<MeshType>::leaf_size;
+
+		template <typename MeshType>
+		constexpr std::size_t lune_tree<MeshType>::stack_size;
+
+		template <typename MeshType>
+		lune_tree<MeshType>::lune_tree(const MeshType& mesh)
+			: mesh_(mesh)
+		{
+			for (std::size_t vertex = 0; vertex < mesh.vertex_count(); vertex++)
+			{
+				if (mesh.is_inserted(vertex))
+				{
+					const auto &point = mesh.vertex(vertex);
+					entries_.push_back({ { static_cast<double>(point.x()), static_cast<double>(point.y()) }, vertex });
+				}
+			}
+			if (entries_.empty())
+			{
+				return;
+			}
+			// splitting at the middle keeps the leaves on two levels, so the node indices stay below four per leaf.
+			boxes_.resize(16 * ((entries_.size() + leaf_size - 1) / leaf_size));
+			build(0, 0, entries_.size());
+		}
+
+		template <typename MeshType>
+		bool lune_tree<MeshType>::is_empty(const std::size_t& a, const std::size_t& b) const
+		{
+			if (entries_.empty())
+			{
+				return true;
+			}
+			const point<double> pa(static_cast<double>(mesh_.vertex(a).x()), static_cast<double>(mesh_.vertex(a).y()));
+			const point<double> pb(static_cast<double>(mesh_.vertex(b).x()), static_cast<double>(mesh_.vertex(b).y()));
+			const auto length = squared_distance(pa, pb);
+			// node, begin and end of every range left to search.
+			std::size_t stack[3 * stack_size];
+			std::size_t top = 0;
+			stack[top++] = 0;
+			stack[top++] = 0;
+			stack[top++] = entries_.size();
+			while (top > 0)
+			{
+				const auto end = stack[--top];
+				const auto begin = stack[--top];
+				const auto node = stack[--top];
+				if (box_distance(node, pa) >= length || box_distance(node, pb) >= length)
+				{
+					continue;
+				}
+				if (end - begin <= leaf_size)
+				{
+					for (auto i = begin; i < end; i++)
+					{
+						const auto &c = entries_[i];
+						if (c.vertex != a && c.vertex != b && squared_distance(pa, c.position) < length &&
+							squared_distance(pb, c.position) < length)
+						{
+							return false;
+						}
+					}
+					continue;
+				}
+				const auto middle = begin + (end - begin) / 2;
+				stack[top++] = 2 * node + 1;
+				stack[top++] = begin;
+				stack[top++] = middle;
+				stack[top++] = 2 * node + 2;
+				stack[top++] = middle;
+				stack[top++] = end;
+			}
+			return true;
+		}
+
+		template <typename MeshType>
+		void lune_tree<MeshType>::build(const std::size_t& node, const std::size_t& begin, const std::size_t& end)
+		{
+			auto box = boxes_.begin() + 4 * node;
+			box[0] = box[1] = std::numeric_limits<double>::infinity();
+			box[2] = box[3] = -std::numeric_limits<double>::infinity();
+			for (auto i = begin; i < end; i++)
+			{
+				const auto &point = entries_[i].position;
+				box[0] = std::min(box[0], point.x());
+				box[1] = std::min(box[1], point.y());
+				box[2] = std::max(box[2], point.x());
+				box[3] = std::max(box[3], point.y());
+			}
+			if (end - begin <= leaf_size)
+			{
+				return;
+			}
+			const auto middle = begin + (end - begin) / 2;
+			const auto by_x = box[2] - box[0] >= box[3] - box[1];
+			std::nth_element(entries_.begin() + begin, entries_.begin() + middle, entries_.begin() + end,
+				[by_x](const entry &first, const entry &second)
+			{
+				return by_x ? first.position.x() < second.position.x() : first.position.y() < second.position.y();
+			});
+			build(2 * node + 1, begin, middle);
+			build(2 * node + 2, middle, end);
+		}
+
+		template <typename MeshType>
+		double lune_tree<MeshType>::box_distance(const std::size_t& node, const point<double>& position) const
+		{
+			// squared distance from the position to the box, zero inside it.
+			const auto box = boxes_.begin() + 4 * node;
+			const auto dx = std::max(std::max(box[0] - position.x(), position.x() - box[2]), 0.0);
+			const auto dy = std::max(std::max(box[1] - position.y(), position.y() - box[3]), 0.0);
+			return dx * dx + dy * dy;
+		}
+	}
+
+	/**
+	* Every undirected finite edge of the mesh exactly once, as a pair of vertex indices, in linear time.
+	*/
+	template<typename PointType, typename T>
+	std::vector<std::pair<std::size_t, std::size_t>> unique_edges(const mesh<PointType, T> &mesh)
+	{
+		const auto &triangles = mesh.triangles();
+		std::vector<std::pair<std::size_t, std::size_t>> edges{};
+		edges.reserve(triangles.size() / 2);
+		internal::for_each_edge(mesh, [&](const std::size_t &e)
+		{
+			edges.emplace_back(triangles[e], triangles[mesh.next(e)]);
+		});
+		return edges;
+	}
+
+	/**
+	* Vertex to vertex adjacency of the triangulation, in linear time.
+	*/
+	template<typename PointType, typename T>
+	adjacency_graph adjacency(const mesh<PointType, T> &mesh)
+	{
+		return internal::make_graph(mesh.vertex_count(), unique_edges(mesh));
+	}
+
+	/**
+	* Euclidean minimum spanning tree of the mesh vertices, by Kruskal's algorithm over the Delaunay edges,
+	* which contain it. O(n log n). Vertices that were not inserted, such as duplicates, stay isolated.
+	*/
+	template<typename PointType, typename T>
+	adjacency_graph minimum_spanning_tree(const mesh<PointType, T> &mesh)
+	{
+		const auto &triangles = mesh.triangles();
+		std::vector<std::pair<double, std::size_t>> candidates{};
+		candidates.reserve(triangles.size() / 2);
+		internal::for_each_edge(mesh, [&](const std::size_t &e)
+		{
+			candidates.emplace_back(squared_distance(mesh.vertex(triangles[e]), mesh.vertex(triangles[mesh.next(e)])), e);
+		});
+		std::sort(candidates.begin(), candidates.end());
+
+		internal::disjoint_sets components(mesh.vertex_count());
+		std::vector<std::pair<std::size_t, std::size_t>> tree{};
+		for (const auto &candidate : candidates)
+		{
+			const auto a = triangles[candidate.second];
+			const auto b = triangles[mesh.next(candidate.second)];
+			if (components.unite(a, b))
+			{
+				tree.emplace_back(a, b);
+			}
+		}
+		return internal::make_graph(mesh.vertex_count(), tree);
+	}
+
+	/**
+	* Gabriel graph: the Delaunay edges whose closed diametral disk holds no other vertex. Only the two vertices
+	* opposite each edge need checking, so this is linear in the size of the mesh. With the disk closed, the
+	* result does not depend on how the triangulation split cocircular points.
+	*/
+	template<typename PointType, typename T>
+	adjacency_graph gabriel_graph(const mesh<PointType, T> &mesh)
+	{
+		const auto &triangles = mesh.triangles();
+		const auto &halfedges = mesh.halfedges();
+
+		// the opposite vertex c is in the diametral disk of ab when the angle acb is not acute.
+		auto blocks = [&](const std::size_t &a, const std::size_t &b, const std::size_t &c)
+		{
+			if (c == infinite_vertex)
+			{
+				return false;
+			}
+			const auto &pa = mesh.vertex(a);
+			const auto &pb = mesh.vertex(b);
+			const auto &pc = mesh.vertex(c);
+			return (static_cast<double>(pa.x()) - static_cast<double>(pc.x())) * (static_cast<double>(pb.x()) - static_cast<double>(pc.x())) +
+				(static_cast<double>(pa.y()) - static_cast<double>(pc.y())) * (static_cast<double>(pb.y()) - static_cast<double>(pc.y())) <= 0.0;
+		};
+		std::vector<std::pair<std::size_t, std::size_t>> edges{};
+		internal::for_each_edge(mesh, [&](const std::size_t &e)
+		{
+			const auto a = triangles[e];
+			const auto b = triangles[mesh.next(e)];
+			if (!blocks(a, b, triangles[mesh.prev(e)]) && !blocks(a, b, triangles[mesh.prev(halfedges[e])]))
+			{
+				edges.emplace_back(a, b);
+			}
+		});
+		return internal::make_graph(mesh.vertex_count(), edges);
+	}
+
+	/**
+	* Relative neighborhood graph: the edges ab with no vertex c closer to both a and b than they are to each
+	* other. It is a subgraph of the Gabriel graph. Greedy routing in a Delaunay triangulation always finds a
+	* neighbor closer to the target, so every vertex within |ab| of a is reached from a over Delaunay edges
+	* without leaving that disk, and searching the disk settles the edge. The disk may hold many vertices outside
+	* the lune, as when two long rows of points face each other, so a search that outgrows a few dozen vertices
+	* is given up for a search of the lune in a 2-d tree of the vertices, built the first time one is needed.
+	*
+	* That is O(n log n) in total for evenly spread points and for points on a few lines. The tree has no
+	* logarithmic bound in general: a node is entered when its box crosses one of the two circles bounding the
+	* lune, a circle crosses O(n^0.8) cells of a 2-d tree, and so adversarial input can take O(n^1.8).
+	*/
+	template<typename PointType, typename T>
+	adjacency_graph relative_neighborhood_graph(const mesh<PointType, T> &mesh)
+	{
+		// vertices a disk search may reach before the edge is left to the tree.
+		constexpr std::size_t search_limit = 64;
+		const auto gabriel = gabriel_graph(mesh);
+		const auto delaunay = adjacency(mesh);
+		std::unique_ptr<internal::lune_tree<delaunaypp::mesh<PointType, T>>> tree{};
+
+		std::vector<std::pair<std::size_t, std::size_t>> edges{};
+		std::vector<std::size_t> marks(mesh.vertex_count(), 0);
+		std::size_t stamp = 0;
+		std::vector<std::size_t> stack{};
+		for (std::size_t a = 0; a < mesh.vertex_count(); a++)
+		{
+			for (auto i = gabriel.offsets[a]; i < gabriel.offsets[a + 1]; i++)
+			{
+				const auto b = gabriel.targets[i];
+				if (b < a)
+				{
+					continue;
+				}
+				const auto length = squared_distance(mesh.vertex(a), mesh.vertex(b));
+				auto empty = true;
+				std::size_t reached = 0;
+				stamp++;
+				marks[a] = stamp;
+				stack.assign(1, a);
+				while (empty && !stack.empty() && reached <= search_limit)
+				{
+					const auto current = stack.back();
+					stack.pop_back();
+					for (auto j = delaunay.offsets[current]; j < delaunay.offsets[current + 1]; j++)
+					{
+						const auto c = delaunay.targets[j];
+						if (marks[c] == stamp || squared_distance(mesh.vertex(a), mesh.vertex(c)) >= length)
+						{
+							continue;
+						}
+						marks[c] = stamp;
+						reached++;
+						if (squared_distance(mesh.vertex(b), mesh.vertex(c)) < length)
+						{
+							empty = false;
+							break;
+						}
+						stack.push_back(c);
+					}
+				}
+				if (empty && !stack.empty())
+				{
+					if (!tree)
+					{
+						tree.reset(new internal::lune_tree<delaunaypp::mesh<PointType, T>>(mesh));
+					}
+					empty = tree->is_empty(a, b);
+				}
+				if (empty)
+				{
+					edges.emplace_back(a, b);
+				}
+			}
+		}
+		return internal::make_graph(mesh.vertex_count(), edges);
+	}
+}
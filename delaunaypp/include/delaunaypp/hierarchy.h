@@ -0,0 +1,257 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "mesh.h"
+
+namespace delaunaypp
+{
+	/**
+	* Settings for delaunay_hierarchy.
+	*/
+	struct hierarchy_options
+	{
+		// a vertex of one level is also in the level above with probability 1 / ratio.
+		std::size_t ratio = 30;
+
+		// levels above the triangulation itself.
+		std::size_t max_levels = 6;
+
+		std::uint32_t seed = 5489u;
+	};
+
+	/**
+	* Size of a delaunay_hierarchy. Level 0 is the triangulation itself, which the overhead leaves out.
+	*/
+	struct hierarchy_stats
+	{
+		std::vector<std::size_t> vertices_per_level;
+		std::vector<std::size_t> triangles_per_level;
+		std::size_t overhead_bytes;
+	};
+
+	/**
+	* Delaunay hierarchy (Devillers) over a mesh, for point location that does not depend on the order of the
+	* queries. Every vertex of the mesh goes up level by level with probability 1 / ratio each, and every level
+	* above the mesh is the Delaunay triangulation of its own vertices. A point is located by walking in the top
+	* level, stepping down at the nearest corner of the triangle found and walking on from there, level after
+	* level; each walk is short, so a query or an insertion takes expected O(log n) instead of the O(sqrt n) a
+	* walk from the last triangle needs for random points.
+	*
+	* The mesh must outlive the hierarchy. Vertices inserted through the hierarchy keep it in step; after any
+	* other change to the mesh call rebuild(). The hierarchy only speeds up the search, so a stale one still
+	* gives correct results, just slower.
+	*/
+	template<typename PointType, typename T = typename PointType::value_type>
+	class delaunay_hierarchy
+	{
+	public:
+		using MeshType = mesh<PointType, T>;
+
+		explicit delaunay_hierarchy(MeshType &mesh, const hierarchy_options &options = hierarchy_options());
+
+		std::size_t insert(const std::size_t &vertex);
+		std::size_t locate(const PointType &point) const;
+		void rebuild();
+		hierarchy_stats stats() const;
+
+	private:
+		MeshType &mesh_;
+		hierarchy_options options_;
+		std::minstd_rand generator_;
+		// levels_[k] is level k + 1; below_[k][v] is the index of its vertex v in the level under it.
+		std::vector<MeshType> levels_;
+		std::vector<std::vector<std::size_t>> below_;
+		// triangles found on the way down by the last insertion, one per level.
+		std::vector<std::size_t> path_;
+
+		std::size_t draw_level();
+		std::size_t descend(const PointType &point, std::vector<std::size_t> *path) const;
+		std::size_t nearest_corner(const MeshType &level, const std::size_t &triangle, const PointType &point) const;
+	};
+
+	template <typename PointType, typename T>
+	delaunay_hierarchy<PointType, T>::delaunay_hierarchy(MeshType& mesh, const hierarchy_options& options)
+		:mesh_(mesh), options_(options), generator_(options.seed)
+	{
+		if (options.ratio < 2)
+		{
+			throw std::runtime_error("The level ratio must be at least 2.");
+		}
+		rebuild();
+	}
+
+	/**
+	* Insert a vertex added to the mesh before, like mesh::insert(), and into the levels it is drawn for.
+	* Returns what mesh::insert() returns.
+	*/
+	template <typename PointType, typename T>
+	std::size_t delaunay_hierarchy<PointType, T>::insert(const std::size_t& vertex)
+	{
+		const auto &point = mesh_.vertex(vertex);
+		const auto triangle = descend(point, &path_);
+		const auto result = mesh_.insert(vertex, triangle);
+		if (result != vertex)
+		{
+			return result;
+		}
+
+		// a copy on every level it reaches, each inserted from the triangle the descent found there.
+		const auto height = draw_level();
+		auto below = vertex;
+		for (std::size_t k = 0; k < height; k++)
+		{
+			const auto copy = levels_[k].add_vertex(point);
+			levels_[k].insert(copy, path_[k]);
+			below_[k].push_back(below);
+			below = copy;
+		}
+		return result;
+	}
+
+	/**
+	* The triangle of the mesh containing the point, as mesh::locate() finds it.
+	*/
+	template <typename PointType, typename T>
+	std::size_t delaunay_hierarchy<PointType, T>::locate(const PointType& point) const
+	{
+		return mesh_.locate(point, descend(point, nullptr));
+	}
+
+	/**
+	* Draw the levels again from the vertices in the mesh. Every level is triangulated at once, in Hilbert order,
+	* like mesh::triangulate(), so a level of m vertices takes O(m log m) and all of them expected
+	* O(n / ratio log n).
+	*/
+	template <typename PointType, typename T>
+	void delaunay_hierarchy<PointType, T>::rebuild()
+	{
+		levels_.assign(options_.max_levels, MeshType());
+		below_.assign(options_.max_levels, std::vector<std::size_t>());
+		path_.assign(options_.max_levels, invalid_index);
+		generator_.seed(options_.seed);
+
+		std::vector<std::size_t> order{};
+		for (std::size_t vertex = 0; vertex < mesh_.vertex_count(); vertex++)
+		{
+			if (mesh_.is_inserted(vertex))
+			{
+				order.push_back(vertex);
+			}
+		}
+		std::vector<std::size_t> heights(order.size());
+		for (auto &height : heights)
+		{
+			height = draw_level();
+		}
+		// the copy of every vertex on the level below, starting from the mesh's own indices.
+		std::vector<std::size_t> copies(order);
+		for (std::size_t k = 0; k < levels_.size(); k++)
+		{
+			std::vector<PointType> points{};
+			std::size_t next = 0;
+			for (std::size_t i = 0; i < order.size(); i++)
+			{
+				if (heights[i] > k)
+				{
+					points.push_back(mesh_.vertex(order[i]));
+					below_[k].push_back(copies[i]);
+					copies[i] = next++;
+				}
+			}
+			if (points.empty())
+			{
+				break;
+			}
+			levels_[k] = MeshType(std::move(points));
+			levels_[k].triangulate();
+		}
+	}
+
+	/**
+	* Vertices and triangles, ghosts included, on every level and an estimate of the memory the levels above
+	* the mesh take.
+	*/
+	template <typename PointType, typename T>
+	hierarchy_stats delaunay_hierarchy<PointType, T>::stats() const
+	{
+		hierarchy_stats stats{ { mesh_.vertex_count() }, { mesh_.triangle_count() }, 0 };
+		for (std::size_t k = 0; k < levels_.size(); k++)
+		{
+			stats.vertices_per_level.push_back(levels_[k].vertex_count());
+			stats.triangles_per_level.push_back(levels_[k].triangle_count());
+			// a point, its edge and its copy below per vertex, three corners and three twins per triangle.
+			stats.overhead_bytes += levels_[k].vertex_count() * (sizeof(PointType) + 2 * sizeof(std::size_t)) +
+				levels_[k].triangle_count() * 6 * sizeof(std::size_t);
+		}
+		stats.overhead_bytes += sizeof(MeshType) * levels_.size();
+		return stats;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t delaunay_hierarchy<PointType, T>::draw_level()
+	{
+		std::size_t height = 0;
+		while (height < options_.max_levels && generator_() % options_.ratio == 0)
+		{
+			height++;
+		}
+		return height;
+	}
+
+	/**
+	* Walk down from the top level. Stores the triangle found on every level above the mesh in path, if given,
+	* and returns the triangle of the mesh to start the last walk from.
+	*/
+	template <typename PointType, typename T>
+	std::size_t delaunay_hierarchy<PointType, T>::descend(const PointType& point, std::vector<std::size_t> *path) const
+	{
+		auto hint = invalid_index;
+		for (auto k = levels_.size(); k > 0; k--)
+		{
+			const auto &level = levels_[k - 1];
+			const auto triangle = level.finite_triangle_count() > 0 ? level.locate(point, hint) : invalid_index;
+			if (path != nullptr)
+			{
+				(*path)[k - 1] = triangle;
+			}
+			if (triangle == invalid_index)
+			{
+				hint = invalid_index;
+				continue;
+			}
+			const auto corner = below_[k - 1][nearest_corner(level, triangle, point)];
+			const auto &under = k > 1 ? levels_[k - 2] : mesh_;
+			const auto edge = under.vertex_edge(corner);
+			hint = edge != invalid_index ? edge / 3 : invalid_index;
+		}
+		return hint;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t delaunay_hierarchy<PointType, T>::nearest_corner(const MeshType& level, const std::size_t& triangle,
+		const PointType& point) const
+	{
+		auto nearest = invalid_index;
+		auto distance = 0.0;
+		for (std::size_t i = 0; i < 3; i++)
+		{
+			const auto vertex = level.origin(3 * triangle + i);
+			if (vertex == infinite_vertex)
+			{
+				continue;
+			}
+			const auto dx = static_cast<double>(level.vertex(vertex).x()) - static_cast<double>(point.x());
+			const auto dy = static_cast<double>(level.vertex(vertex).y()) - static_cast<double>(point.y());
+			if (nearest == invalid_index || dx * dx + dy * dy < distance)
+			{
+				nearest = vertex;
+				distance = dx * dx + dy * dy;
+			}
+		}
+		return nearest;
+	}
+}
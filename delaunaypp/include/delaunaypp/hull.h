@@ -0,0 +1,96 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "predicates.h"
+
+namespace delaunaypp
+{
+	/**
+	* Convex hull of a point cloud using Andrew's monotone chain in O(n log n), for callers that do not need a
+	* triangulation. Returns the indices of the hull vertices in counter clockwise order starting at the
+	* lowest (x, y) point. Points lying on a hull edge and duplicates are left out.
+	*/
+	template<typename PointType>
+	std::vector<std::size_t> convex_hull(const std::vector<PointType> &points)
+	{
+		if (points.empty())
+		{
+			return {};
+		}
+
+		// points strictly inside the octagon of the points furthest in the eight compass directions cannot be on
+		// the hull (Akl and Toussaint). Dropping them first leaves little to sort for most inputs.
+		auto extent = [&points](const std::size_t &i, const std::size_t &k)
+		{
+			static const double directions[8][2] = { { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 } };
+			return directions[k][0] * points[i].x() + directions[k][1] * points[i].y();
+		};
+		std::size_t extremes[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		for (std::size_t i = 1; i < points.size(); i++)
+		{
+			for (std::size_t k = 0; k < 8; k++)
+			{
+				extremes[k] = extent(i, k) > extent(extremes[k], k) ? i : extremes[k];
+			}
+		}
+		// repeated corners would make every point look outside.
+		auto same = [&points](const std::size_t &first, const std::size_t &second)
+		{
+			return points[first] == points[second];
+		};
+		auto corners = static_cast<std::size_t>(std::unique(extremes, extremes + 8, same) - extremes);
+		corners -= corners > 1 && same(extremes[0], extremes[corners - 1]) ? 1 : 0;
+		std::vector<std::size_t> order{};
+		for (std::size_t i = 0; i < points.size(); i++)
+		{
+			for (std::size_t k = 0; k < corners; k++)
+			{
+				if (predicates::orient2d(points[extremes[k]], points[extremes[(k + 1) % corners]], points[i]) <= 0.0)
+				{
+					order.push_back(i);
+					break;
+				}
+			}
+		}
+		std::sort(order.begin(), order.end(), [&points](const std::size_t &first, const std::size_t &second)
+		{
+			const auto &a = points[first];
+			const auto &b = points[second];
+			return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());
+		});
+		order.erase(std::unique(order.begin(), order.end(), [&points](const std::size_t &first, const std::size_t &second)
+		{
+			return points[first] == points[second];
+		}), order.end());
+		if (order.size() < 3)
+		{
+			return order;
+		}
+
+		// lower chain left to right, then upper chain right to left. Only left turns are kept.
+		std::vector<std::size_t> hull(2 * order.size());
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < order.size(); i++)
+		{
+			while (count >= 2 && predicates::orient2d(points[hull[count - 2]], points[hull[count - 1]], points[order[i]]) <= 0.0)
+			{
+				count--;
+			}
+			hull[count++] = order[i];
+		}
+		const auto lower = count + 1;
+		for (auto i = order.size() - 1; i > 0; i--)
+		{
+			while (count >= lower && predicates::orient2d(points[hull[count - 2]], points[hull[count - 1]], points[order[i - 1]]) <= 0.0)
+			{
+				count--;
+			}
+			hull[count++] = order[i - 1];
+		}
+
+		// the last point repeats the first one.
+		hull.resize(count - 1);
+		return hull;
+	}
+}
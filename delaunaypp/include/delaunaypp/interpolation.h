@@ -0,0 +1,536 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "geometry.h"
+#include "mesh.h"
+
+namespace delaunaypp
+{
+	/**
+	* Settings for the batch interpolation functions.
+	*/
+	struct interpolation_options
+	{
+		// value written for queries outside the convex hull. Integer values need a finite one in their range
+		// instead of the default NaN.
+		double outside = std::numeric_limits<double>::quiet_NaN();
+
+		// worker threads, zero for one per hardware thread. Batches smaller than parallel_threshold stay on the
+		// calling thread.
+		std::size_t threads = 1;
+		std::size_t parallel_threshold = 1 << 16;
+
+		// visit the queries of interpolate_linear() along a Hilbert curve, so each walk starts next to its target.
+		// Turn off for queries that already come in a coherent order.
+		bool sort_queries = true;
+	};
+
+	/**
+	* Reusable buffers for natural neighbor queries. Give every thread its own; once the buffers have grown to
+	* the largest cavity seen, queries no longer allocate. The mesh itself is only read.
+	*/
+	struct natural_neighbor_scratch
+	{
+		// halfedges still to be checked, with the index of their triangle's circumcenter.
+		std::vector<std::pair<std::size_t, std::size_t>> stack;
+		// circumcenters of the cavity triangles, relative to the query.
+		std::vector<point<double>> centers;
+		// cavity boundary halfedges in counter clockwise order, with their triangle's circumcenter.
+		std::vector<std::pair<std::size_t, std::size_t>> boundary;
+		std::vector<std::size_t> neighbors;
+		std::vector<double> areas;
+		// triangle of the previous query, where the next walk starts.
+		std::size_t hint = invalid_index;
+	};
+
+	namespace internal
+	{
+		constexpr std::size_t interpolation_block = 256;
+
+		/**
+		* Split [0, count) into one contiguous range per thread and run task(begin, end) on each. The calling
+		* thread takes the first range.
+		*/
+		template<typename Task>
+		void parallel_ranges(const std::size_t &count, const interpolation_options &options, Task task)
+		{
+			auto threads = options.threads > 0 ? options.threads : static_cast<std::size_t>(std::thread::hardware_concurrency());
+			if (threads <= 1 || count < options.parallel_threshold)
+			{
+				task(std::size_t(0), count);
+				return;
+			}
+			threads = std::min(threads, count);
+			std::vector<std::thread> workers{};
+			const auto chunk = (count + threads - 1) / threads;
+			for (std::size_t begin = chunk; begin < count; begin += chunk)
+			{
+				workers.emplace_back(task, begin, std::min(count, begin + chunk));
+			}
+			task(std::size_t(0), std::min(count, chunk));
+			for (auto &worker : workers)
+			{
+				worker.join();
+			}
+		}
+
+		/**
+		* Reject NaN or infinity as the value outside the hull for integer values, which cannot hold it.
+		*/
+		template<typename ValueType>
+		void check_outside(const double &outside)
+		{
+			if (!std::is_floating_point<ValueType>::value && !std::isfinite(outside))
+			{
+				throw std::runtime_error("Integer values need a finite value outside the hull.");
+			}
+		}
+
+		/**
+		* Linear interpolation at the queries query(begin) ... query(end - 1), handed to store(i, value). Each query is
+		* located by walking from the triangle of the previous one, so runs of nearby queries cost a step or two.
+		* The weights are computed a block at a time from gathered coordinates in a branch free loop the compiler
+		* can vectorize.
+		*/
+		template<typename MeshType, typename ValueType, typename Query, typename Store>
+		void interpolate_range(const MeshType &mesh, const ValueType *values, Query query, const std::size_t &begin,
+			const std::size_t &end, Store store, const double &outside)
+		{
+			const auto block = interpolation_block;
+			double ax[block], ay[block], bx[block], by[block], cx[block], cy[block];
+			double qx[block], qy[block], va[block], vb[block], vc[block], result[block];
+			bool inside[block];
+			const auto &triangles = mesh.triangles();
+			auto hint = invalid_index;
+			for (auto first = begin; first < end; first += block)
+			{
+				const auto count = std::min(block, end - first);
+				for (std::size_t i = 0; i < count; i++)
+				{
+					const auto point = query(first + i);
+					qx[i] = static_cast<double>(point.x());
+					qy[i] = static_cast<double>(point.y());
+					auto triangle = walk(mesh, point, hint);
+					inside[i] = triangle != invalid_index && !mesh.is_ghost(triangle);
+					if (!inside[i])
+					{
+						// a dummy unit triangle keeps the weight loop free of branches.
+						ax[i] = 0.0; ay[i] = 0.0; bx[i] = 1.0; by[i] = 0.0; cx[i] = 0.0; cy[i] = 1.0;
+						va[i] = vb[i] = vc[i] = 0.0;
+						continue;
+					}
+					hint = triangle;
+					const auto &a = mesh.vertex(triangles[3 * triangle]);
+					const auto &b = mesh.vertex(triangles[3 * triangle + 1]);
+					const auto &c = mesh.vertex(triangles[3 * triangle + 2]);
+					ax[i] = static_cast<double>(a.x()); ay[i] = static_cast<double>(a.y());
+					bx[i] = static_cast<double>(b.x()); by[i] = static_cast<double>(b.y());
+					cx[i] = static_cast<double>(c.x()); cy[i] = static_cast<double>(c.y());
+					va[i] = static_cast<double>(values[triangles[3 * triangle]]);
+					vb[i] = static_cast<double>(values[triangles[3 * triangle + 1]]);
+					vc[i] = static_cast<double>(values[triangles[3 * triangle + 2]]);
+				}
+
+				for (std::size_t i = 0; i < count; i++)
+				{
+					const auto ux = qx[i] - cx[i];
+					const auto uy = qy[i] - cy[i];
+					const auto inverse = 1.0 / ((by[i] - cy[i]) * (ax[i] - cx[i]) + (cx[i] - bx[i]) * (ay[i] - cy[i]));
+					const auto wa = ((by[i] - cy[i]) * ux + (cx[i] - bx[i]) * uy) * inverse;
+					const auto wb = ((cy[i] - ay[i]) * ux + (ax[i] - cx[i]) * uy) * inverse;
+					result[i] = vc[i] + wa * (va[i] - vc[i]) + wb * (vb[i] - vc[i]);
+				}
+
+				for (std::size_t i = 0; i < count; i++)
+				{
+					store(first + i, static_cast<ValueType>(inside[i] ? result[i] : outside));
+				}
+			}
+		}
+		/**
+		* Sibson interpolation at query. The Bowyer-Watson cavity the query would carve is collected without touching
+		* the mesh; the area each natural neighbor would lose to the query's Voronoi cell is summed from the circumcenters
+		* of the cavity triangles and of the new triangles around the query.
+		*/
+		template<typename MeshType, typename ValueType>
+		double natural_neighbor_value(const MeshType &mesh, const ValueType *values, const typename MeshType::vertex_type &query,
+			natural_neighbor_scratch &scratch, const double &outside)
+		{
+			const auto &triangles = mesh.triangles();
+			const auto &halfedges = mesh.halfedges();
+			auto start = walk(mesh, query, scratch.hint);
+			if (start == invalid_index || mesh.is_ghost(start))
+			{
+				return outside;
+			}
+			scratch.hint = start;
+
+			const auto qx = static_cast<double>(query.x());
+			const auto qy = static_cast<double>(query.y());
+			auto shifted = [&](const std::size_t &vertex)
+			{
+				const auto &v = mesh.vertex(vertex);
+				return point<double>(static_cast<double>(v.x()) - qx, static_cast<double>(v.y()) - qy);
+			};
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				if (mesh.vertex(triangles[3 * start + i]) == query)
+				{
+					return static_cast<double>(values[triangles[3 * start + i]]);
+				}
+			}
+			auto linear = [&]()
+			{
+				const auto a = shifted(triangles[3 * start]);
+				const auto b = shifted(triangles[3 * start + 1]);
+				const auto c = shifted(triangles[3 * start + 2]);
+				const point<double> origin(0.0, 0.0);
+				const auto area = signed_area(a, b, c);
+				return (signed_area(origin, b, c) * static_cast<double>(values[triangles[3 * start]]) +
+					signed_area(a, origin, c) * static_cast<double>(values[triangles[3 * start + 1]]) +
+					signed_area(a, b, origin) * static_cast<double>(values[triangles[3 * start + 2]])) / area;
+			};
+
+			scratch.neighbors.clear();
+			scratch.areas.clear();
+			auto add_area = [&](const std::size_t &vertex, const double &area)
+			{
+				for (std::size_t i = 0; i < scratch.neighbors.size(); i++)
+				{
+					if (scratch.neighbors[i] == vertex)
+					{
+						scratch.areas[i] += area;
+						return;
+					}
+				}
+				scratch.neighbors.push_back(vertex);
+				scratch.areas.push_back(area);
+			};
+			auto cross = [](const point<double> &a, const point<double> &b) { return a.x() * b.y() - a.y() * b.x(); };
+			auto center = [&](const std::size_t &triangle)
+			{
+				return circumcenter(shifted(triangles[3 * triangle]), shifted(triangles[3 * triangle + 1]),
+					shifted(triangles[3 * triangle + 2]));
+			};
+
+			// depth first through the cavity, taking the two far edges of every triangle in order, so the boundary
+			// comes out counter clockwise. The cavity has no interior vertices, so no triangle is reached twice.
+			scratch.centers.clear();
+			scratch.boundary.clear();
+			scratch.stack.clear();
+			scratch.centers.push_back(center(start));
+			for (std::size_t i = 3; i-- > 0;)
+			{
+				scratch.stack.emplace_back(3 * start + i, 0);
+			}
+			while (!scratch.stack.empty())
+			{
+				const auto e = scratch.stack.back().first;
+				const auto owner = scratch.stack.back().second;
+				scratch.stack.pop_back();
+				const auto twin = halfedges[e];
+				const auto neighbour = twin / 3;
+				const auto from = triangles[e];
+				const auto to = triangles[MeshType::next(e)];
+				if (mesh.is_ghost(neighbour))
+				{
+					// on a hull edge Sibson interpolation reduces to linear interpolation along the edge.
+					if (predicates::orient2d(mesh.vertex(from), mesh.vertex(to), query) == 0.0)
+					{
+						return linear();
+					}
+					scratch.boundary.emplace_back(e, owner);
+					continue;
+				}
+				const auto &a = mesh.vertex(triangles[3 * neighbour]);
+				const auto &b = mesh.vertex(triangles[3 * neighbour + 1]);
+				const auto &c = mesh.vertex(triangles[3 * neighbour + 2]);
+				if (predicates::incircle(a, b, c, query) <= 0.0)
+				{
+					scratch.boundary.emplace_back(e, owner);
+					continue;
+				}
+
+				// around the vertex the edge ends at, the Voronoi cell boundary runs from the owner's circumcenter
+				// to the neighbour's; around its start vertex the other way.
+				const auto index = scratch.centers.size();
+				scratch.centers.push_back(center(neighbour));
+				const auto step = cross(scratch.centers[owner], scratch.centers[index]);
+				add_area(to, step);
+				add_area(from, -step);
+				scratch.stack.emplace_back(MeshType::prev(twin), index);
+				scratch.stack.emplace_back(MeshType::next(twin), index);
+			}
+
+			// each boundary edge a->b gains the circumcenter of the new triangle (a, b, query), which closes the
+			// stolen area of a and b.
+			const point<double> origin(0.0, 0.0);
+			auto first = origin, previous = origin;
+			for (std::size_t i = 0; i < scratch.boundary.size(); i++)
+			{
+				const auto e = scratch.boundary[i].first;
+				const auto &owner = scratch.centers[scratch.boundary[i].second];
+				const auto from = triangles[e];
+				const auto to = triangles[MeshType::next(e)];
+				const auto gained = circumcenter(origin, shifted(from), shifted(to));
+				add_area(to, cross(owner, gained));
+				add_area(from, cross(gained, owner));
+				if (i == 0)
+				{
+					first = gained;
+				}
+				else
+				{
+					add_area(from, cross(previous, gained));
+				}
+				previous = gained;
+			}
+			add_area(triangles[scratch.boundary.front().first], cross(previous, first));
+
+			auto total = 0.0, weighted = 0.0;
+			for (std::size_t i = 0; i < scratch.neighbors.size(); i++)
+			{
+				total += scratch.areas[i];
+				weighted += scratch.areas[i] * static_cast<double>(values[scratch.neighbors[i]]);
+			}
+			return total > 0.0 ? weighted / total : linear();
+		}
+	}
+
+	/**
+	* Piecewise linear interpolation of per vertex values at a batch of query points. output must have room
+	* for one value per query; queries outside the hull get options.outside.
+	*/
+	template<typename PointType, typename T, typename ValueType>
+	void interpolate_linear(const mesh<PointType, T> &mesh, const std::vector<ValueType> &values,
+		const std::vector<PointType> &queries, ValueType *output, const interpolation_options &options = interpolation_options())
+	{
+		if (values.size() < mesh.vertex_count())
+		{
+			throw std::runtime_error("Expected one value per vertex.");
+		}
+		internal::check_outside<ValueType>(options.outside);
+		const auto *data = values.data();
+		const auto *points = queries.data();
+		if (!options.sort_queries)
+		{
+			internal::parallel_ranges(queries.size(), options, [&](std::size_t begin, std::size_t end)
+			{
+				internal::interpolate_range(mesh, data, [points](const std::size_t &i) { return points[i]; }, begin, end,
+					[output](const std::size_t &i, const ValueType &value) { output[i] = value; }, options.outside);
+			});
+			return;
+		}
+
+		const auto order = internal::hilbert_order(queries);
+		const auto *sorted = order.data();
+		internal::parallel_ranges(queries.size(), options, [&](std::size_t begin, std::size_t end)
+		{
+			internal::interpolate_range(mesh, data, [points, sorted](const std::size_t &i) { return points[sorted[i]]; },
+				begin, end, [output, sorted](const std::size_t &i, const ValueType &value) { output[sorted[i]] = value; },
+				options.outside);
+		});
+	}
+
+	/**
+	* Interpolate onto a regular grid, such as a DEM, of columns x rows nodes. Node (row, column) lies at
+	* (origin_x + column * spacing, origin_y + row * spacing) and is written to output[row * columns + column];
+	* nodes outside the hull get options.outside.
+	*
+	* Rather than locating every node, each triangle is scan converted once: the ends of its span on every
+	* grid row are found with exact orientation tests, so nodes on shared edges and on the hull are always
+	* covered, and the span is filled from the triangle's plane in a loop the compiler can vectorize. With
+	* several threads every thread owns a band of rows.
+	*/
+	template<typename PointType, typename T, typename ValueType>
+	void rasterize_linear(const mesh<PointType, T> &mesh, const std::vector<ValueType> &values, const double &origin_x,
+		const double &origin_y, const double &spacing, const std::size_t &columns, const std::size_t &rows, ValueType *output,
+		const interpolation_options &options = interpolation_options())
+	{
+		if (values.size() < mesh.vertex_count())
+		{
+			throw std::runtime_error("Expected one value per vertex.");
+		}
+		internal::check_outside<ValueType>(options.outside);
+		const auto &triangles = mesh.triangles();
+		const auto node_x = [&](const long long &column) { return origin_x + static_cast<double>(column) * spacing; };
+		const auto node_y = [&](const long long &row) { return origin_y + static_cast<double>(row) * spacing; };
+
+		// split by rows; a band is at least parallel_threshold nodes.
+		auto band_options = options;
+		band_options.parallel_threshold = columns > 0 ? (options.parallel_threshold + columns - 1) / columns : 1;
+		internal::parallel_ranges(rows, band_options, [&](std::size_t first_row, std::size_t end_row)
+		{
+			std::fill(output + first_row * columns, output + end_row * columns, static_cast<ValueType>(options.outside));
+			// corners and values are gathered a block of triangles at a time, so that the scattered loads
+			// overlap instead of stalling the scan one by one.
+			const auto block = internal::interpolation_block;
+			double corners_x[3 * block], corners_y[3 * block], corner_values[3 * block];
+			for (std::size_t first = 0; first < mesh.triangle_count(); first += block)
+			{
+				std::size_t gathered = 0;
+				for (auto t = first; t < std::min(first + block, mesh.triangle_count()); t++)
+				{
+					if (mesh.is_ghost(t))
+					{
+						continue;
+					}
+					for (std::size_t i = 0; i < 3; i++)
+					{
+						const auto &corner = mesh.vertex(triangles[3 * t + i]);
+						corners_x[3 * gathered + i] = static_cast<double>(corner.x());
+						corners_y[3 * gathered + i] = static_cast<double>(corner.y());
+						corner_values[3 * gathered + i] = static_cast<double>(values[triangles[3 * t + i]]);
+					}
+					gathered++;
+				}
+
+				for (std::size_t k = 0; k < gathered; k++)
+				{
+					const auto *x = corners_x + 3 * k;
+					const auto *y = corners_y + 3 * k;
+
+					// grid rows of the bounding box. Rounding may put the end rows one off, which the span search
+					// below absorbs.
+					const auto min_y = std::min({ y[0], y[1], y[2] });
+					const auto max_y = std::max({ y[0], y[1], y[2] });
+					auto low_row = static_cast<long long>(std::ceil((min_y - origin_y) / spacing)) - 1;
+					auto high_row = static_cast<long long>(std::floor((max_y - origin_y) / spacing)) + 1;
+					low_row = std::max(low_row, static_cast<long long>(first_row));
+					high_row = std::min(high_row, static_cast<long long>(end_row) - 1);
+					if (low_row > high_row || columns == 0)
+					{
+						continue;
+					}
+					const auto last_column = static_cast<long long>(columns) - 1;
+
+					// the plane through the three values.
+					const auto va = corner_values[3 * k];
+					const auto vb = corner_values[3 * k + 1];
+					const auto vc = corner_values[3 * k + 2];
+					const auto ux = x[1] - x[0], uy = y[1] - y[0], wx = x[2] - x[0], wy = y[2] - y[0];
+					const auto inverse = 1.0 / (ux * wy - wx * uy);
+					const auto gradient_x = ((vb - va) * wy - (vc - va) * uy) * inverse;
+					const auto gradient_y = ((vc - va) * ux - (vb - va) * wx) * inverse;
+
+					auto inside = [&](const long long &column, const double &ny)
+					{
+						const auto nx = node_x(column);
+						return predicates::orient2d(x[0], y[0], x[1], y[1], nx, ny) >= 0.0 &&
+							predicates::orient2d(x[1], y[1], x[2], y[2], nx, ny) >= 0.0 &&
+							predicates::orient2d(x[2], y[2], x[0], y[0], nx, ny) >= 0.0;
+					};
+					for (auto row = low_row; row <= high_row; row++)
+					{
+						const auto ny = node_y(row);
+						if (ny < min_y || ny > max_y)
+						{
+							continue;
+						}
+
+						// estimate the span from the edges crossing the row, then settle its ends exactly.
+						auto span_low = std::numeric_limits<double>::infinity();
+						auto span_high = -std::numeric_limits<double>::infinity();
+						for (std::size_t i = 0; i < 3; i++)
+						{
+							const auto j = (i + 1) % 3;
+							if ((y[i] <= ny && ny <= y[j]) || (y[j] <= ny && ny <= y[i]))
+							{
+								const auto cross = y[i] == y[j] ? x[i] : x[i] + (ny - y[i]) * (x[j] - x[i]) / (y[j] - y[i]);
+								const auto bound_low = y[i] == y[j] ? std::min(x[i], x[j]) : cross;
+								const auto bound_high = y[i] == y[j] ? std::max(x[i], x[j]) : cross;
+								span_low = std::min(span_low, bound_low);
+								span_high = std::max(span_high, bound_high);
+							}
+						}
+						auto left = std::max(0ll, static_cast<long long>(std::ceil((span_low - origin_x) / spacing)));
+						auto right = std::min(last_column, static_cast<long long>(std::floor((span_high - origin_x) / spacing)));
+						while (left > 0 && inside(left - 1, ny))
+						{
+							left--;
+						}
+						while (left <= last_column && left <= right + 1 && !inside(left, ny))
+						{
+							left++;
+						}
+						if (left > last_column || !inside(left, ny))
+						{
+							continue;
+						}
+						right = std::max(right, left);
+						while (right < last_column && inside(right + 1, ny))
+						{
+							right++;
+						}
+						while (!inside(right, ny))
+						{
+							right--;
+						}
+						auto *target = output + static_cast<std::size_t>(row) * columns;
+						const auto base = va + gradient_y * (ny - y[0]);
+						for (auto column = left; column <= right; column++)
+						{
+							target[column] = static_cast<ValueType>(base + gradient_x * (node_x(column) - x[0]));
+						}
+					}
+				}
+			}
+		});
+	}
+
+	/**
+	* Natural neighbor (Sibson) interpolation of per vertex values at query. Unlike linear interpolation the result
+	* is smooth away from the data points. The mesh is not modified, so any number of threads may query it at once,
+	* each with its own scratch. Queries outside the hull get outside, which must be finite for integer values.
+	*/
+	template<typename PointType, typename T, typename ValueType>
+	ValueType interpolate_natural(const mesh<PointType, T> &mesh, const std::vector<ValueType> &values, const PointType &query,
+		natural_neighbor_scratch &scratch, const double &outside = std::numeric_limits<double>::quiet_NaN())
+	{
+		if (values.size() < mesh.vertex_count())
+		{
+			throw std::runtime_error("Expected one value per vertex.");
+		}
+		internal::check_outside<ValueType>(outside);
+		return static_cast<ValueType>(internal::natural_neighbor_value(mesh, values.data(), query, scratch, outside));
+	}
+
+	/**
+	* Natural neighbor interpolation at a batch of query points, ordered and split over threads like
+	* interpolate_linear(). Each thread allocates its scratch once for its whole range.
+	*/
+	template<typename PointType, typename T, typename ValueType>
+	void interpolate_natural(const mesh<PointType, T> &mesh, const std::vector<ValueType> &values,
+		const std::vector<PointType> &queries, ValueType *output, const interpolation_options &options = interpolation_options())
+	{
+		if (values.size() < mesh.vertex_count())
+		{
+			throw std::runtime_error("Expected one value per vertex.");
+		}
+		internal::check_outside<ValueType>(options.outside);
+		std::vector<std::size_t> order{};
+		if (options.sort_queries)
+		{
+			order = internal::hilbert_order(queries);
+		}
+		const auto *data = values.data();
+		const auto *sorted = order.empty() ? nullptr : order.data();
+		internal::parallel_ranges(queries.size(), options, [&](std::size_t begin, std::size_t end)
+		{
+			natural_neighbor_scratch scratch{};
+			for (auto i = begin; i < end; i++)
+			{
+				const auto index = sorted != nullptr ? sorted[i] : i;
+				output[index] = static_cast<ValueType>(internal::natural_neighbor_value(mesh, data, queries[index], scratch,
+					options.outside));
+			}
+		});
+	}
+}
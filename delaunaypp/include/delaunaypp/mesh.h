@@ -0,0 +1,1701 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "predicates.h"
+
+namespace delaunaypp
+{
+	/**
+	* Marks a missing vertex, halfedge or triangle.
+	*/
+	constexpr std::size_t invalid_index = std::numeric_limits<std::size_t>::max();
+
+	/**
+	* The vertex at infinity. Every convex hull edge is closed off by a ghost triangle that uses this vertex,
+	* so that every halfedge of the mesh has a twin.
+	*/
+	constexpr std::size_t infinite_vertex = std::numeric_limits<std::size_t>::max() - 1;
+
+	namespace internal
+	{
+		struct vertex_pair_hash
+		{
+			std::size_t operator()(const std::pair<std::size_t, std::size_t> &pair) const
+			{
+				return std::hash<std::size_t>()(pair.first * 0x9e3779b97f4a7c15ull ^ pair.second);
+			}
+		};
+
+		inline std::uint64_t hilbert_index(std::uint32_t x, std::uint32_t y)
+		{
+			const std::uint32_t n = 1u << 16;
+			std::uint64_t d = 0;
+			for (auto s = n / 2; s > 0; s /= 2)
+			{
+				std::uint32_t rx = (x & s) > 0 ? 1 : 0;
+				std::uint32_t ry = (y & s) > 0 ? 1 : 0;
+				d += static_cast<std::uint64_t>(s) * s * ((3 * rx) ^ ry);
+				if (ry == 0)
+				{
+					if (rx == 1)
+					{
+						x = n - 1 - x;
+						y = n - 1 - y;
+					}
+					std::swap(x, y);
+				}
+			}
+			return d;
+		}
+
+		/**
+		* Order the given points along a Hilbert curve so that consecutive points are spatially close. Fills
+		* order, using keys as scratch, so that callers sorting many point sets can keep both buffers.
+		*/
+		template<typename PointType>
+		void hilbert_order(const std::vector<PointType> &points, std::vector<std::size_t> &order,
+			std::vector<std::pair<std::uint64_t, std::size_t>> &keys)
+		{
+			order.resize(points.size());
+			if (points.empty())
+			{
+				return;
+			}
+
+			auto min_x = static_cast<double>(points[0].x());
+			auto min_y = static_cast<double>(points[0].y());
+			auto max_x = min_x;
+			auto max_y = min_y;
+			for (const auto &point : points)
+			{
+				min_x = std::min(min_x, static_cast<double>(point.x()));
+				min_y = std::min(min_y, static_cast<double>(point.y()));
+				max_x = std::max(max_x, static_cast<double>(point.x()));
+				max_y = std::max(max_y, static_cast<double>(point.y()));
+			}
+			auto scale_x = max_x > min_x ? 65535.0 / (max_x - min_x) : 0.0;
+			auto scale_y = max_y > min_y ? 65535.0 / (max_y - min_y) : 0.0;
+
+			keys.resize(points.size());
+			for (std::size_t i = 0; i < points.size(); i++)
+			{
+				auto x = static_cast<std::uint32_t>((static_cast<double>(points[i].x()) - min_x) * scale_x);
+				auto y = static_cast<std::uint32_t>((static_cast<double>(points[i].y()) - min_y) * scale_y);
+				keys[i] = std::make_pair(hilbert_index(x, y), i);
+			}
+			std::sort(keys.begin(), keys.end());
+			for (std::size_t i = 0; i < keys.size(); i++)
+			{
+				order[i] = keys[i].second;
+			}
+		}
+
+		template<typename PointType>
+		std::vector<std::size_t> hilbert_order(const std::vector<PointType> &points)
+		{
+			std::vector<std::size_t> order{};
+			std::vector<std::pair<std::uint64_t, std::size_t>> keys{};
+			hilbert_order(points, order, keys);
+			return order;
+		}
+
+		/**
+		* Biased randomized insertion order: the points are shuffled and split into rounds that double in size,
+		* each of them ordered along a Hilbert curve. Points on curves, such as polygon rings, make Hilbert order
+		* alone build long triangles across the curve that later insertions keep tearing down; a random sample
+		* first keeps the expected work per insertion constant.
+		*/
+		template<typename PointType>
+		std::vector<std::size_t> brio_order(const std::vector<PointType> &points)
+		{
+			std::vector<std::size_t> shuffled(points.size());
+			for (std::size_t i = 0; i < shuffled.size(); i++)
+			{
+				shuffled[i] = i;
+			}
+			std::minstd_rand generator(20240607u);
+			std::shuffle(shuffled.begin(), shuffled.end(), generator);
+
+			std::vector<std::size_t> order{};
+			order.reserve(points.size());
+			std::vector<PointType> round{};
+			std::size_t begin = 0;
+			while (begin < shuffled.size())
+			{
+				const auto end = std::min(shuffled.size(), std::max<std::size_t>(64, 2 * begin));
+				round.clear();
+				for (auto i = begin; i < end; i++)
+				{
+					round.push_back(points[shuffled[i]]);
+				}
+				for (const auto &index : hilbert_order(round))
+				{
+					order.push_back(shuffled[begin + index]);
+				}
+				begin = end;
+			}
+			return order;
+		}
+
+		/**
+		* Visibility walk from the start triangle towards point. Returns the finite triangle that contains
+		* the point, or the ghost triangle of the hull edge the point lies beyond.
+		*/
+		template<typename MeshType, typename PointType>
+		std::size_t walk(const MeshType &mesh, const PointType &point, std::size_t start)
+		{
+			if (mesh.finite_triangle_count() == 0)
+			{
+				return invalid_index;
+			}
+			auto current = start < mesh.triangle_count() ? start : 0;
+			if (mesh.is_ghost(current))
+			{
+				// step over to the finite side of the ghost's hull edge.
+				for (std::size_t i = 0; i < 3; i++)
+				{
+					auto e = 3 * current + i;
+					if (mesh.origin(e) != infinite_vertex && mesh.origin(MeshType::next(e)) != infinite_vertex)
+					{
+						current = mesh.twin(e) / 3;
+						break;
+					}
+				}
+			}
+
+			// a cheap random rotation of the first tested edge keeps the walk from cycling
+			// in triangulations that are not Delaunay.
+			auto state = static_cast<std::uint32_t>(current * 2654435761u + 1u);
+			auto entry = invalid_index;
+			while (true)
+			{
+				state = state * 1664525u + 1013904223u;
+				auto rotation = static_cast<std::size_t>((state >> 16) % 3);
+				auto crossed = false;
+				for (std::size_t k = 0; k < 3; k++)
+				{
+					auto e = 3 * current + (k + rotation) % 3;
+					if (e == entry)
+					{
+						continue;
+					}
+					const auto &a = mesh.vertex(mesh.origin(e));
+					const auto &b = mesh.vertex(mesh.origin(MeshType::next(e)));
+					if (predicates::orient2d(a, b, point) < 0.0)
+					{
+						entry = mesh.twin(e);
+						current = entry / 3;
+						if (mesh.is_ghost(current))
+						{
+							return current;
+						}
+						crossed = true;
+						break;
+					}
+				}
+				if (!crossed)
+				{
+					return current;
+				}
+			}
+		}
+	}
+
+	/**
+	* Indexed, incrementally built Delaunay triangulation stored as halfedges.
+	*
+	* Triangle t owns the halfedges 3t, 3t + 1 and 3t + 2. Halfedge e starts at vertex origin(e) and ends at
+	* origin(next(e)); twin(e) is the oppositely oriented halfedge of the neighbouring triangle. Finite triangles
+	* are counter clockwise. Each convex hull edge is closed off by a ghost triangle using infinite_vertex.
+	* Vertex indices are the indices of the points given to the mesh.
+	*
+	* Given a weight per vertex, the mesh is the regular (weighted Delaunay) triangulation instead, the dual of
+	* the power diagram. A vertex whose weight is too small to own a power cell is redundant and stays out of
+	* the mesh, or is hidden again by a later insertion; is_inserted() tells which vertices are in use.
+	*
+	* Edges forced in by constrain() make it a constrained Delaunay triangulation. Flips never remove them and
+	* insertions do not reach across them; a vertex inserted on a constrained edge splits it in two.
+	*/
+	template<typename PointType, typename T = typename PointType::value_type>
+	class mesh
+	{
+	public:
+		using vertex_type = PointType;
+		using value_type = T;
+
+		mesh() = default;
+		explicit mesh(std::vector<PointType> vertices);
+		mesh(std::vector<PointType> vertices, std::vector<double> weights);
+
+		template<typename Iterator>
+		void assign(Iterator begin, Iterator end);
+		void triangulate();
+		void clear();
+		std::size_t add_vertex(const PointType &point);
+		std::size_t add_vertex(const PointType &point, const double &weight);
+		std::size_t insert(const std::size_t &vertex, const std::size_t &hint = invalid_index);
+		std::size_t split(const std::size_t &halfedge, const std::size_t &vertex);
+		std::size_t update_positions(const std::vector<PointType> &positions);
+		std::size_t update_positions(const std::vector<std::size_t> &indices, const std::vector<PointType> &positions);
+		std::size_t erase(const std::vector<std::size_t> &vertices);
+		void set_vertex(const std::size_t &index, const PointType &point);
+		void constrain(const std::size_t &a, const std::size_t &b);
+
+		std::size_t locate(const PointType &point, const std::size_t &hint = invalid_index) const;
+
+		std::size_t vertex_count() const;
+		std::size_t triangle_count() const;
+		std::size_t finite_triangle_count() const;
+		const PointType& vertex(const std::size_t &index) const;
+		const std::vector<PointType>& vertices() const;
+		bool is_weighted() const;
+		double weight(const std::size_t &index) const;
+		const std::vector<double>& weights() const;
+		const std::vector<std::size_t>& triangles() const;
+		const std::vector<std::size_t>& halfedges() const;
+		std::size_t origin(const std::size_t &halfedge) const;
+		std::size_t twin(const std::size_t &halfedge) const;
+		std::size_t vertex_edge(const std::size_t &vertex) const;
+		bool is_ghost(const std::size_t &triangle) const;
+		bool is_inserted(const std::size_t &vertex) const;
+		bool is_constrained() const;
+		bool is_constrained(const std::size_t &halfedge) const;
+		const std::vector<std::size_t>& recent_triangles() const;
+		std::size_t rebuild_count() const;
+		std::vector<std::size_t> hull() const;
+
+		static std::size_t next(const std::size_t &halfedge);
+		static std::size_t prev(const std::size_t &halfedge);
+
+	private:
+		std::vector<PointType> vertices_;
+		// empty for an unweighted mesh.
+		std::vector<double> weights_;
+		std::vector<std::size_t> triangles_;
+		std::vector<std::size_t> halfedges_;
+		std::vector<std::size_t> vertex_edges_;
+		std::size_t infinite_edge_ = invalid_index;
+		std::size_t finite_count_ = 0;
+		std::size_t last_ = invalid_index;
+		std::size_t rebuilds_ = 0;
+
+		// vertices waiting for three non collinear points to start the triangulation.
+		std::vector<std::size_t> pending_;
+		std::vector<std::size_t> waiting_;
+
+		// scratch buffers reused between insertions.
+		std::vector<std::uint32_t> marks_;
+		std::uint32_t stamp_ = 0;
+		std::vector<std::size_t> stack_;
+		std::vector<std::size_t> cavity_;
+		std::vector<std::size_t> boundary_;
+		std::vector<std::size_t> link_;
+		std::size_t infinite_link_ = invalid_index;
+		std::vector<std::size_t> recent_;
+		std::vector<std::size_t> polygon_;
+		std::vector<std::size_t> outside_;
+		std::vector<std::size_t> dead_;
+		std::vector<std::pair<std::size_t, std::size_t>> crossed_;
+		std::vector<std::size_t> order_;
+		std::vector<std::pair<std::uint64_t, std::size_t>> keys_;
+
+		// constrained edges as (smaller, larger) vertex pairs.
+		std::unordered_set<std::pair<std::size_t, std::size_t>, internal::vertex_pair_hash> constraints_;
+
+		bool in_conflict(const std::size_t &triangle, const std::size_t &vertex) const;
+		bool ghost_conflict(const std::size_t &a, const std::size_t &b, const std::size_t &vertex) const;
+		void carve(const std::size_t &vertex, const bool &keep_hull);
+		bool is_constrained(const std::size_t &a, const std::size_t &b) const;
+		std::size_t find_halfedge(const std::size_t &a, const std::size_t &b) const;
+		std::size_t force_edge(const std::size_t &a, const std::size_t &b, std::vector<std::size_t> &queue);
+		bool has_valid_star(const std::size_t &vertex) const;
+		bool remove(const std::size_t &vertex, std::vector<std::size_t> &queue);
+		std::vector<std::size_t> members() const;
+		void rebuild(const std::vector<std::size_t> &vertices);
+		void set_triangle(const std::size_t &slot, const std::size_t &a, const std::size_t &b, const std::size_t &c,
+			const std::size_t &ab, const std::size_t &bc, const std::size_t &ca);
+		void flip(const std::size_t &halfedge);
+		std::size_t legalize(std::vector<std::size_t> &queue);
+		void compact();
+		void set_vertex_edge(const std::size_t &vertex, const std::size_t &halfedge);
+		std::size_t& link(const std::size_t &vertex);
+		std::uint32_t next_stamp();
+		void bootstrap();
+		void create_first_triangle(std::size_t a, std::size_t b, std::size_t c);
+	};
+
+	template <typename PointType, typename T>
+	mesh<PointType, T>::mesh(std::vector<PointType> vertices)
+		:vertices_(std::move(vertices))
+	{
+	}
+
+	template <typename PointType, typename T>
+	mesh<PointType, T>::mesh(std::vector<PointType> vertices, std::vector<double> weights)
+		:vertices_(std::move(vertices)), weights_(std::move(weights))
+	{
+		if (weights_.size() != vertices_.size())
+		{
+			throw std::runtime_error("Expected one weight per vertex.");
+		}
+	}
+
+	/**
+	* Replace the vertices by the points in [begin, end) and drop the triangulation, keeping every buffer's
+	* capacity, so that one mesh can triangulate many small point sets without allocating.
+	*/
+	template <typename PointType, typename T>
+	template <typename Iterator>
+	void mesh<PointType, T>::assign(Iterator begin, Iterator end)
+	{
+		vertices_.assign(begin, end);
+		weights_.clear();
+		clear();
+	}
+
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::triangulate()
+	{
+		clear();
+		vertex_edges_.assign(vertices_.size(), invalid_index);
+		triangles_.reserve(vertices_.size() * 6 + 12);
+		halfedges_.reserve(vertices_.size() * 6 + 12);
+
+		// insert along a space filling curve so every walk starts right next to its target.
+		internal::hilbert_order(vertices_, order_, keys_);
+		for (const auto &index : order_)
+		{
+			insert(index, last_);
+		}
+	}
+
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::clear()
+	{
+		triangles_.clear();
+		halfedges_.clear();
+		std::fill(vertex_edges_.begin(), vertex_edges_.end(), invalid_index);
+		infinite_edge_ = invalid_index;
+		finite_count_ = 0;
+		last_ = invalid_index;
+		pending_.clear();
+		recent_.clear();
+		dead_.clear();
+		constraints_.clear();
+	}
+
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::add_vertex(const PointType& point)
+	{
+		vertices_.push_back(point);
+		vertex_edges_.resize(vertices_.size(), invalid_index);
+		if (!weights_.empty())
+		{
+			weights_.push_back(0.0);
+		}
+		return vertices_.size() - 1;
+	}
+
+	/**
+	* Add a weighted vertex. The first weighted vertex makes the mesh weighted, with weight zero for the
+	* vertices before it; the triangulation so far stays valid.
+	*/
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::add_vertex(const PointType& point, const double& weight)
+	{
+		weights_.resize(vertices_.size(), 0.0);
+		weights_.push_back(weight);
+		vertices_.push_back(point);
+		vertex_edges_.resize(vertices_.size(), invalid_index);
+		return vertices_.size() - 1;
+	}
+
+	/**
+	* Insert a vertex added before, walking from the hint triangle. Returns the vertex, the vertex already at
+	* the same position, or invalid_index for a redundant weighted vertex.
+	*/
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::insert(const std::size_t& vertex, const std::size_t& hint)
+	{
+		if (vertex_edges_.size() < vertices_.size())
+		{
+			vertex_edges_.resize(vertices_.size(), invalid_index);
+		}
+		recent_.clear();
+		if (triangles_.empty())
+		{
+			// a repeated position waits in the vertex queued first, like it would be merged into an inserted one.
+			for (const auto &waiting : pending_)
+			{
+				if (weights_.empty() && vertices_[waiting] == vertices_[vertex])
+				{
+					return waiting;
+				}
+			}
+			pending_.push_back(vertex);
+			bootstrap();
+			return vertex;
+		}
+
+		const auto &point = vertices_[vertex];
+		auto start = locate(point, hint);
+		if (!weights_.empty())
+		{
+			// a weighted point that does not destroy the triangle it lies in has no power cell. This also
+			// settles duplicates: the heavier one wins.
+			if (!in_conflict(start, vertex))
+			{
+				return invalid_index;
+			}
+		}
+		else if (!is_ghost(start))
+		{
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				auto existing = triangles_[3 * start + i];
+				if (vertices_[existing] == point)
+				{
+					return existing;
+				}
+			}
+		}
+
+		cavity_.clear();
+		cavity_.push_back(start);
+		carve(vertex, false);
+		return vertex;
+	}
+
+	/**
+	* Split the hull edge of the given halfedge by vertex, which must lie on the edge or just inside its
+	* triangle. The hull edges are kept as they are, so a split point that rounding moved off the edge does
+	* not change the hull. Returns invalid_index when the vertex is not in the edge's triangle.
+	*/
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::split(const std::size_t& halfedge, const std::size_t& vertex)
+	{
+		if (vertex_edges_.size() < vertices_.size())
+		{
+			vertex_edges_.resize(vertices_.size(), invalid_index);
+		}
+		recent_.clear();
+		const auto &point = vertices_[vertex];
+		const auto &a = vertices_[triangles_[halfedge]];
+		const auto &b = vertices_[triangles_[next(halfedge)]];
+		const auto &c = vertices_[triangles_[prev(halfedge)]];
+		if (predicates::orient2d(a, b, point) < 0.0 || predicates::orient2d(b, c, point) <= 0.0 ||
+			predicates::orient2d(c, a, point) <= 0.0)
+		{
+			return invalid_index;
+		}
+
+		cavity_.clear();
+		cavity_.push_back(halfedge / 3);
+		cavity_.push_back(halfedges_[halfedge] / 3);
+		carve(vertex, true);
+		return vertex;
+	}
+
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::carve(const std::size_t& vertex, const bool& keep_hull)
+	{
+		// grow the seed triangles in cavity_ to all triangles whose circumcircle contains the point
+		// (the Bowyer-Watson cavity) and collect the halfedges on its boundary. With keep_hull no further
+		// ghost joins the cavity. Constrained edges bound the cavity too, except one the vertex lies on.
+		auto conflict = next_stamp();
+		auto checked = conflict + 1;
+		boundary_.clear();
+		stack_.clear();
+		crossed_.clear();
+		for (const auto &seed : cavity_)
+		{
+			marks_[seed] = conflict;
+			stack_.push_back(seed);
+		}
+		while (!stack_.empty())
+		{
+			auto current = stack_.back();
+			stack_.pop_back();
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				auto e = 3 * current + i;
+				auto neighbour = halfedges_[e] / 3;
+				if (marks_[neighbour] == conflict)
+				{
+					continue;
+				}
+				if (!constraints_.empty() && is_constrained(triangles_[e], triangles_[next(e)]))
+				{
+					if (predicates::orient2d(vertices_[triangles_[e]], vertices_[triangles_[next(e)]], vertices_[vertex]) != 0.0)
+					{
+						// the triangle beyond may still be reached around the constraint, so it is not marked.
+						boundary_.push_back(e);
+						continue;
+					}
+					crossed_.emplace_back(triangles_[e], triangles_[next(e)]);
+				}
+				if (marks_[neighbour] != checked && !(keep_hull && is_ghost(neighbour)) && in_conflict(neighbour, vertex))
+				{
+					marks_[neighbour] = conflict;
+					cavity_.push_back(neighbour);
+					stack_.push_back(neighbour);
+				}
+				else
+				{
+					marks_[neighbour] = checked;
+					boundary_.push_back(e);
+				}
+			}
+		}
+
+		// replace the cavity by a fan of triangles around the new vertex. Every boundary halfedge a->b
+		// becomes the triangle (a, b, vertex); cavity slots are reused first.
+		for (const auto &triangle : cavity_)
+		{
+			if (!is_ghost(triangle)) finite_count_--;
+		}
+		if (!weights_.empty())
+		{
+			// vertices inside a weighted cavity are hidden; the boundary vertices get their edge back below.
+			for (const auto &triangle : cavity_)
+			{
+				for (std::size_t i = 0; i < 3; i++)
+				{
+					set_vertex_edge(triangles_[3 * triangle + i], invalid_index);
+				}
+			}
+			// fill the lowest slots so that compacting the spare ones never moves a new triangle.
+			if (cavity_.size() > boundary_.size())
+			{
+				std::sort(cavity_.begin(), cavity_.end());
+			}
+		}
+		auto &edge_info = stack_;
+		edge_info.clear();
+		for (const auto &e : boundary_)
+		{
+			edge_info.push_back(triangles_[e]);
+			edge_info.push_back(triangles_[next(e)]);
+			edge_info.push_back(halfedges_[e]);
+		}
+
+		for (std::size_t j = 0; j < boundary_.size(); j++)
+		{
+			std::size_t slot;
+			if (j < cavity_.size())
+			{
+				slot = cavity_[j];
+			}
+			else
+			{
+				slot = triangles_.size() / 3;
+				triangles_.resize(triangles_.size() + 3);
+				halfedges_.resize(halfedges_.size() + 3);
+			}
+			auto a = edge_info[3 * j];
+			auto b = edge_info[3 * j + 1];
+			auto outside = edge_info[3 * j + 2];
+			triangles_[3 * slot] = a;
+			triangles_[3 * slot + 1] = b;
+			triangles_[3 * slot + 2] = vertex;
+			halfedges_[3 * slot] = outside;
+			halfedges_[outside] = 3 * slot;
+			link(a) = slot;
+			set_vertex_edge(a, 3 * slot);
+			if (a != infinite_vertex && b != infinite_vertex) finite_count_++;
+			recent_.push_back(slot);
+		}
+		for (auto j = boundary_.size(); j < cavity_.size(); j++)
+		{
+			const auto slot = cavity_[j];
+			triangles_[3 * slot] = triangles_[3 * slot + 1] = triangles_[3 * slot + 2] = invalid_index;
+			dead_.push_back(slot);
+		}
+		if (marks_.size() < triangles_.size() / 3)
+		{
+			marks_.resize(triangles_.size() / 3, 0);
+		}
+
+		// stitch the fan: the edge b->vertex of (a, b, vertex) is the twin of vertex->b of (b, c, vertex).
+		for (const auto &slot : recent_)
+		{
+			auto other = link(triangles_[3 * slot + 1]);
+			halfedges_[3 * slot + 1] = 3 * other + 2;
+			halfedges_[3 * other + 2] = 3 * slot + 1;
+		}
+		set_vertex_edge(vertex, 3 * recent_.front() + 2);
+		last_ = recent_.front();
+		for (const auto &edge : crossed_)
+		{
+			constraints_.erase(std::minmax(edge.first, edge.second));
+			constraints_.insert(std::minmax(edge.first, vertex));
+			constraints_.insert(std::minmax(vertex, edge.second));
+		}
+		compact();
+	}
+
+	/**
+	* Move every vertex to the matching entry of positions, which must hold one point per vertex. See the index
+	* based overload; only vertices whose position changed are visited.
+	*/
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::update_positions(const std::vector<PointType>& positions)
+	{
+		if (positions.size() != vertices_.size())
+		{
+			throw std::runtime_error("Expected one position per vertex.");
+		}
+		std::vector<std::size_t> moved{};
+		std::vector<PointType> targets{};
+		for (std::size_t i = 0; i < positions.size(); i++)
+		{
+			if (!(positions[i] == vertices_[i]))
+			{
+				moved.push_back(i);
+				targets.push_back(positions[i]);
+			}
+		}
+		return update_positions(moved, targets);
+	}
+
+	/**
+	* Kinetic update: move the given vertices and repair the triangulation in place. A vertex that stays inside
+	* its star (all its triangles keep their orientation and the hull stays convex) is moved directly; any other
+	* vertex is taken out and inserted again at its new position. Lawson flips, driven by a queue of the edges
+	* around the moved vertices, then restore the Delaunay property. The work depends on the moved vertices and
+	* the flips, not on the size of the mesh. A given vertex outside the mesh is inserted at its new position;
+	* the other vertices outside it, such as erased ones, stay out. Returns the number of flips and reinsertions.
+	*/
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::update_positions(const std::vector<std::size_t>& indices, const std::vector<PointType>& positions)
+	{
+		if (indices.size() != positions.size())
+		{
+			throw std::runtime_error("Expected one position per vertex index.");
+		}
+		if (!weights_.empty())
+		{
+			// flips alone cannot hide or reveal weighted vertices.
+			throw std::runtime_error("Moving the vertices of a weighted mesh is not supported.");
+		}
+		if (!constraints_.empty())
+		{
+			throw std::runtime_error("Moving the vertices of a constrained mesh is not supported.");
+		}
+		if (vertex_edges_.size() < vertices_.size())
+		{
+			vertex_edges_.resize(vertices_.size(), invalid_index);
+		}
+		recent_.clear();
+		if (finite_count_ == 0)
+		{
+			auto remaining = members();
+			for (std::size_t i = 0; i < indices.size(); i++)
+			{
+				vertices_[indices[i]] = positions[i];
+			}
+			remaining.insert(remaining.end(), indices.begin(), indices.end());
+			rebuild(remaining);
+			return 0;
+		}
+
+		// visit the vertices in the order of their triangles, which follows the Hilbert curve of the
+		// original insertion, so that neighbouring stars are still in cache.
+		std::vector<std::pair<std::size_t, std::size_t>> order(indices.size());
+		for (std::size_t i = 0; i < indices.size(); i++)
+		{
+			order[i] = std::make_pair(vertex_edge(indices[i]), i);
+		}
+		std::sort(order.begin(), order.end());
+
+		std::vector<std::size_t> queue{};
+		std::vector<std::size_t> reinsert{};
+		std::vector<std::size_t> anchors{};
+		std::vector<std::size_t> moved{};
+		const auto stamp = next_stamp();
+		for (std::size_t k = 0; k < order.size(); k++)
+		{
+			const auto i = order[k].second;
+			const auto &vertex = indices[i];
+			if (!is_inserted(vertex))
+			{
+				vertices_[vertex] = positions[i];
+				reinsert.push_back(vertex);
+				anchors.push_back(invalid_index);
+				continue;
+			}
+
+			const auto previous = vertices_[vertex];
+			vertices_[vertex] = positions[i];
+			if (has_valid_star(vertex))
+			{
+				// every edge of the star may have lost the Delaunay property.
+				auto e = vertex_edges_[vertex];
+				do
+				{
+					if (marks_[e / 3] != stamp)
+					{
+						marks_[e / 3] = stamp;
+						moved.push_back(e / 3);
+					}
+					e = halfedges_[prev(e)];
+				} while (e != vertex_edges_[vertex]);
+				continue;
+			}
+
+			// the vertex crossed its star: take it out where it was and insert it again later, starting the
+			// walk at a former neighbour.
+			vertices_[vertex] = previous;
+			auto anchor = triangles_[next(vertex_edges_[vertex])];
+			if (anchor == infinite_vertex)
+			{
+				anchor = triangles_[prev(vertex_edges_[vertex])];
+			}
+			if (!remove(vertex, queue))
+			{
+				// start over with the vertices the local update would have ended up with.
+				auto remaining = members();
+				remaining.insert(remaining.end(), reinsert.begin(), reinsert.end());
+				for (std::size_t j = k; j < order.size(); j++)
+				{
+					vertices_[indices[order[j].second]] = positions[order[j].second];
+					remaining.push_back(indices[order[j].second]);
+				}
+				rebuild(remaining);
+				return 0;
+			}
+			vertices_[vertex] = positions[i];
+			reinsert.push_back(vertex);
+			anchors.push_back(anchor);
+		}
+
+		// queue each edge of the touched triangles once. Slots reused by remove() are queued already.
+		for (const auto &triangle : moved)
+		{
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				auto e = 3 * triangle + i;
+				auto twin = halfedges_[e];
+				if (triangles_[e] != invalid_index && (twin > e || marks_[twin / 3] != stamp))
+				{
+					queue.push_back(e);
+				}
+			}
+		}
+		auto changes = legalize(queue);
+		compact();
+		for (std::size_t i = 0; i < reinsert.size(); i++)
+		{
+			auto hint = anchors[i] != invalid_index && is_inserted(anchors[i]) ? vertex_edges_[anchors[i]] / 3 : last_;
+			insert(reinsert[i], hint);
+			changes++;
+		}
+		recent_.clear();
+		return changes;
+	}
+
+	/**
+	* Take the given vertices out of the mesh by local deletion: each star is filled again and Lawson flips
+	* restore the Delaunay property, so the work depends on the erased vertices, not on the size of the mesh.
+	* The indices stay valid; an erased vertex can be inserted again, or given a new position with set_vertex()
+	* first. Constrained edges at an erased vertex are dropped. Stars too degenerate to fill locally make the
+	* mesh triangulate the remaining vertices again. Returns the number of flips.
+	*/
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::erase(const std::vector<std::size_t>& vertices)
+	{
+		if (!weights_.empty())
+		{
+			// filling a star cannot reveal the weighted vertices it hid.
+			throw std::runtime_error("Erasing the vertices of a weighted mesh is not supported.");
+		}
+		recent_.clear();
+		std::vector<std::size_t> queue{};
+		for (std::size_t i = 0; i < vertices.size(); i++)
+		{
+			const auto &vertex = vertices[i];
+			if (!is_inserted(vertex))
+			{
+				pending_.erase(std::remove(pending_.begin(), pending_.end(), vertex), pending_.end());
+				continue;
+			}
+			if (!constraints_.empty())
+			{
+				const auto start = vertex_edges_[vertex];
+				auto e = start;
+				do
+				{
+					constraints_.erase(std::minmax(vertex, triangles_[next(e)]));
+					e = halfedges_[prev(e)];
+				} while (e != start);
+			}
+			if (remove(vertex, queue))
+			{
+				continue;
+			}
+
+			// insert what is left from scratch, skipping the vertices still to be erased.
+			std::vector<bool> erased(vertices_.size(), false);
+			for (auto j = i; j < vertices.size(); j++)
+			{
+				erased[vertices[j]] = true;
+			}
+			auto remaining = members();
+			remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&erased](const std::size_t &v)
+			{
+				return erased[v];
+			}), remaining.end());
+			rebuild(remaining);
+			return 0;
+		}
+		auto flips = legalize(queue);
+		compact();
+		return flips;
+	}
+
+	/**
+	* The vertices in the mesh or waiting for its first triangle.
+	*/
+	template <typename PointType, typename T>
+	std::vector<std::size_t> mesh<PointType, T>::members() const
+	{
+		std::vector<bool> waiting(vertices_.size(), false);
+		for (const auto &vertex : pending_)
+		{
+			waiting[vertex] = true;
+		}
+		std::vector<std::size_t> result{};
+		for (std::size_t v = 0; v < vertices_.size(); v++)
+		{
+			if (waiting[v] || is_inserted(v))
+			{
+				result.push_back(v);
+			}
+		}
+		return result;
+	}
+
+	/**
+	* Triangulate the given vertices from scratch, where local repairs gave up, keeping the constraints between
+	* them. Every other vertex is left out of the mesh.
+	*/
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::rebuild(const std::vector<std::size_t>& vertices)
+	{
+		std::vector<bool> kept(vertices_.size(), false);
+		std::vector<std::size_t> remaining{};
+		std::vector<PointType> points{};
+		for (const auto &vertex : vertices)
+		{
+			if (!kept[vertex])
+			{
+				kept[vertex] = true;
+				remaining.push_back(vertex);
+				points.push_back(vertices_[vertex]);
+			}
+		}
+		auto constraints = std::move(constraints_);
+		clear();
+		rebuilds_++;
+		for (const auto &index : internal::hilbert_order(points))
+		{
+			insert(remaining[index], last_);
+		}
+		for (const auto &constraint : constraints)
+		{
+			if (kept[constraint.first] && kept[constraint.second])
+			{
+				constrain(constraint.first, constraint.second);
+			}
+		}
+		recent_.clear();
+	}
+
+	/**
+	* Give a vertex that is not in the mesh, such as an erased one, a new position so that its index can be
+	* reused by insert().
+	*/
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::set_vertex(const std::size_t& index, const PointType& point)
+	{
+		if (is_inserted(index))
+		{
+			throw std::runtime_error("Only vertices outside the mesh can be given a new position.");
+		}
+		vertices_[index] = point;
+	}
+
+	/**
+	* Force the segment between two inserted vertices into the mesh as a constrained edge. The edges it crosses
+	* are flipped away and Lawson flips around the new edges make the mesh constrained Delaunay again; vertices
+	* lying on the segment split it into several constrained edges. Segments must not cross each other.
+	* clear() and triangulate() drop all constraints.
+	*/
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::constrain(const std::size_t& a, const std::size_t& b)
+	{
+		if (!weights_.empty())
+		{
+			throw std::runtime_error("Constraining the edges of a weighted mesh is not supported.");
+		}
+		if (a == b || !is_inserted(a) || !is_inserted(b))
+		{
+			throw std::runtime_error("A constraint needs two distinct vertices of the mesh.");
+		}
+		recent_.clear();
+		std::vector<std::size_t> queue{};
+		auto start = a;
+		while (start != b)
+		{
+			start = force_edge(start, b, queue);
+			legalize(queue);
+		}
+	}
+
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::locate(const PointType& point, const std::size_t& hint) const
+	{
+		return internal::walk(*this, point, hint < triangle_count() ? hint : last_);
+	}
+
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::vertex_count() const
+	{
+		return vertices_.size();
+	}
+
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::triangle_count() const
+	{
+		return triangles_.size() / 3;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::finite_triangle_count() const
+	{
+		return finite_count_;
+	}
+
+	template <typename PointType, typename T>
+	const PointType& mesh<PointType, T>::vertex(const std::size_t& index) const
+	{
+		return vertices_[index];
+	}
+
+	template <typename PointType, typename T>
+	const std::vector<PointType>& mesh<PointType, T>::vertices() const
+	{
+		return vertices_;
+	}
+
+	template <typename PointType, typename T>
+	bool mesh<PointType, T>::is_weighted() const
+	{
+		return !weights_.empty();
+	}
+
+	/**
+	* Weight of a vertex, zero in an unweighted mesh.
+	*/
+	template <typename PointType, typename T>
+	double mesh<PointType, T>::weight(const std::size_t& index) const
+	{
+		return weights_.empty() ? 0.0 : weights_[index];
+	}
+
+	/**
+	* One weight per vertex, or nothing for an unweighted mesh.
+	*/
+	template <typename PointType, typename T>
+	const std::vector<double>& mesh<PointType, T>::weights() const
+	{
+		return weights_;
+	}
+
+	template <typename PointType, typename T>
+	const std::vector<std::size_t>& mesh<PointType, T>::triangles() const
+	{
+		return triangles_;
+	}
+
+	template <typename PointType, typename T>
+	const std::vector<std::size_t>& mesh<PointType, T>::halfedges() const
+	{
+		return halfedges_;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::origin(const std::size_t& halfedge) const
+	{
+		return triangles_[halfedge];
+	}
+
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::twin(const std::size_t& halfedge) const
+	{
+		return halfedges_[halfedge];
+	}
+
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::vertex_edge(const std::size_t& vertex) const
+	{
+		if (vertex == infinite_vertex)
+		{
+			return infinite_edge_;
+		}
+		return vertex < vertex_edges_.size() ? vertex_edges_[vertex] : invalid_index;
+	}
+
+	template <typename PointType, typename T>
+	bool mesh<PointType, T>::is_ghost(const std::size_t& triangle) const
+	{
+		return triangles_[3 * triangle] == infinite_vertex ||
+			triangles_[3 * triangle + 1] == infinite_vertex ||
+			triangles_[3 * triangle + 2] == infinite_vertex;
+	}
+
+	template <typename PointType, typename T>
+	bool mesh<PointType, T>::is_inserted(const std::size_t& vertex) const
+	{
+		return vertex_edge(vertex) != invalid_index;
+	}
+
+	template <typename PointType, typename T>
+	bool mesh<PointType, T>::is_constrained() const
+	{
+		return !constraints_.empty();
+	}
+
+	template <typename PointType, typename T>
+	bool mesh<PointType, T>::is_constrained(const std::size_t& halfedge) const
+	{
+		return !constraints_.empty() && is_constrained(triangles_[halfedge], triangles_[next(halfedge)]);
+	}
+
+	template <typename PointType, typename T>
+	const std::vector<std::size_t>& mesh<PointType, T>::recent_triangles() const
+	{
+		return recent_;
+	}
+
+	/**
+	* Number of times erase() or update_positions() triangulated the remaining vertices again from scratch instead
+	* of repairing the mesh locally, which takes time in the size of the mesh.
+	*/
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::rebuild_count() const
+	{
+		return rebuilds_;
+	}
+
+	/**
+	* Vertex indices of the convex hull in counter clockwise order, read off the ring of ghost triangles
+	* in O(h). Vertices lying on a hull edge are part of the ring. Empty while there is no finite triangle.
+	*/
+	template <typename PointType, typename T>
+	std::vector<std::size_t> mesh<PointType, T>::hull() const
+	{
+		std::vector<std::size_t> ring{};
+		if (infinite_edge_ == invalid_index)
+		{
+			return ring;
+		}
+
+		// every ghost is (infinite, x, y) up to rotation with the hull edge x->y running clockwise. The twin of
+		// infinite->x belongs to the ghost of the previous clockwise edge, so following it walks the hull
+		// counter clockwise.
+		auto e = infinite_edge_;
+		do
+		{
+			ring.push_back(triangles_[next(e)]);
+			e = next(halfedges_[e]);
+		} while (e != infinite_edge_);
+		return ring;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::next(const std::size_t& halfedge)
+	{
+		return halfedge % 3 == 2 ? halfedge - 2 : halfedge + 1;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::prev(const std::size_t& halfedge)
+	{
+		return halfedge % 3 == 0 ? halfedge + 2 : halfedge - 1;
+	}
+
+	template <typename PointType, typename T>
+	bool mesh<PointType, T>::in_conflict(const std::size_t& triangle, const std::size_t& vertex) const
+	{
+		auto a = triangles_[3 * triangle];
+		auto b = triangles_[3 * triangle + 1];
+		auto c = triangles_[3 * triangle + 2];
+		if (a == infinite_vertex) return ghost_conflict(b, c, vertex);
+		if (b == infinite_vertex) return ghost_conflict(c, a, vertex);
+		if (c == infinite_vertex) return ghost_conflict(a, b, vertex);
+		if (!weights_.empty())
+		{
+			return predicates::power_test(vertices_[a], weights_[a], vertices_[b], weights_[b], vertices_[c], weights_[c],
+				vertices_[vertex], weights_[vertex]) > 0.0;
+		}
+		return predicates::incircle(vertices_[a], vertices_[b], vertices_[c], vertices_[vertex]) > 0.0;
+	}
+
+	template <typename PointType, typename T>
+	bool mesh<PointType, T>::ghost_conflict(const std::size_t& a, const std::size_t& b, const std::size_t& vertex) const
+	{
+		// the finite side of a ghost's hull edge a->b is on its right. A point conflicts with the ghost when it
+		// is strictly outside the hull edge, or on the edge line between a and b; weighted, when it destroys
+		// the edge on that line.
+		const auto &first = vertices_[a];
+		const auto &second = vertices_[b];
+		const auto &point = vertices_[vertex];
+		auto orientation = predicates::orient2d(first, second, point);
+		if (orientation != 0.0)
+		{
+			return orientation > 0.0;
+		}
+		if (!weights_.empty())
+		{
+			return predicates::power_test(first, weights_[a], second, weights_[b], point, weights_[vertex]) > 0.0;
+		}
+		if (first.x() != second.x())
+		{
+			return point.x() > std::min(first.x(), second.x()) && point.x() < std::max(first.x(), second.x());
+		}
+		return point.y() > std::min(first.y(), second.y()) && point.y() < std::max(first.y(), second.y());
+	}
+
+	template <typename PointType, typename T>
+	bool mesh<PointType, T>::is_constrained(const std::size_t& a, const std::size_t& b) const
+	{
+		return constraints_.count(std::minmax(a, b)) > 0;
+	}
+
+	/**
+	* The halfedge from a to b, or invalid_index when they are not neighbours.
+	*/
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::find_halfedge(const std::size_t& a, const std::size_t& b) const
+	{
+		const auto start = vertex_edges_[a];
+		auto e = start;
+		do
+		{
+			if (triangles_[next(e)] == b)
+			{
+				return e;
+			}
+			e = halfedges_[prev(e)];
+		} while (e != start);
+		return invalid_index;
+	}
+
+	/**
+	* Constrain the segment from a towards b up to the first vertex on it, which is returned. The edges crossing
+	* the segment are collected by walking along it and flipped until none is left (Sloan's method); an edge
+	* whose quadrilateral is not convex waits until its neighbours were flipped. The new edges are added to
+	* queue for legalize().
+	*/
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::force_edge(const std::size_t& a, const std::size_t& b, std::vector<std::size_t>& queue)
+	{
+		if (find_halfedge(a, b) != invalid_index)
+		{
+			constraints_.insert(std::minmax(a, b));
+			return b;
+		}
+		const auto &from = vertices_[a];
+		const auto &to = vertices_[b];
+		auto side = [&](const std::size_t &vertex) { return predicates::orient2d(from, to, vertices_[vertex]); };
+		auto ahead = [&](const std::size_t &vertex)
+		{
+			const auto &point = vertices_[vertex];
+			return (point.x() - from.x()) * (to.x() - from.x()) + (point.y() - from.y()) * (to.y() - from.y()) > 0;
+		};
+
+		// the triangle around a that the segment leaves through its far edge x->y, or a vertex on the segment.
+		const auto start = vertex_edges_[a];
+		auto e = start;
+		auto crossing = invalid_index;
+		do
+		{
+			const auto x = triangles_[next(e)];
+			const auto y = triangles_[prev(e)];
+			if (x != infinite_vertex && side(x) == 0.0 && ahead(x))
+			{
+				constraints_.insert(std::minmax(a, x));
+				return x;
+			}
+			if (x != infinite_vertex && y != infinite_vertex && side(x) < 0.0 && side(y) > 0.0)
+			{
+				crossing = next(e);
+				break;
+			}
+			e = halfedges_[prev(e)];
+		} while (e != start);
+		if (crossing == invalid_index)
+		{
+			throw std::runtime_error("Could not find the constraint in the mesh.");
+		}
+
+		// walk along the segment; every crossed edge is stored with its vertex right of the segment first.
+		std::deque<std::pair<std::size_t, std::size_t>> crossed{};
+		auto end = b;
+		while (true)
+		{
+			const auto x = triangles_[crossing];
+			const auto y = triangles_[next(crossing)];
+			if (is_constrained(x, y))
+			{
+				throw std::runtime_error("Constraints must not cross.");
+			}
+			crossed.emplace_back(x, y);
+			const auto twin = halfedges_[crossing];
+			const auto z = triangles_[prev(twin)];
+			if (z == b)
+			{
+				break;
+			}
+			if (z == infinite_vertex)
+			{
+				throw std::runtime_error("Could not find the constraint in the mesh.");
+			}
+			const auto turn = side(z);
+			if (turn == 0.0)
+			{
+				end = z;
+				break;
+			}
+			crossing = turn < 0.0 ? prev(twin) : next(twin);
+		}
+
+		// flip the crossed edges away. A new edge that still crosses goes back into the line.
+		const auto &last = vertices_[end];
+		auto crosses = [&](const std::size_t &p, const std::size_t &q)
+		{
+			if (p == a || q == a || p == end || q == end)
+			{
+				return false;
+			}
+			const auto first = predicates::orient2d(from, last, vertices_[p]);
+			const auto second = predicates::orient2d(from, last, vertices_[q]);
+			return (first < 0.0 && second > 0.0) || (first > 0.0 && second < 0.0);
+		};
+		std::vector<std::pair<std::size_t, std::size_t>> created{};
+		while (!crossed.empty())
+		{
+			const auto edge = crossed.front();
+			crossed.pop_front();
+			const auto halfedge = find_halfedge(edge.first, edge.second);
+			const auto p = triangles_[prev(halfedge)];
+			const auto q = triangles_[prev(halfedges_[halfedge])];
+			const auto &u = vertices_[edge.first];
+			const auto &v = vertices_[edge.second];
+			const auto first = predicates::orient2d(vertices_[p], vertices_[q], u);
+			const auto second = predicates::orient2d(vertices_[p], vertices_[q], v);
+			if (!((first < 0.0 && second > 0.0) || (first > 0.0 && second < 0.0)))
+			{
+				crossed.push_back(edge);
+				continue;
+			}
+			flip(halfedge);
+			if (crosses(p, q))
+			{
+				crossed.emplace_back(p, q);
+			}
+			else
+			{
+				created.emplace_back(p, q);
+			}
+		}
+		constraints_.insert(std::minmax(a, end));
+		for (const auto &edge : created)
+		{
+			queue.push_back(find_halfedge(edge.first, edge.second));
+		}
+		return end;
+	}
+
+	template <typename PointType, typename T>
+	bool mesh<PointType, T>::has_valid_star(const std::size_t& vertex) const
+	{
+		// the finite triangles around the vertex must stay counter clockwise. For a hull vertex the hull must stay
+		// convex at the vertex and at its two hull neighbours.
+		const auto start = vertex_edges_[vertex];
+		auto e = start;
+		auto ghost = invalid_index;
+		do
+		{
+			auto a = triangles_[next(e)];
+			auto b = triangles_[prev(e)];
+			if (a == infinite_vertex)
+			{
+				ghost = e;
+			}
+			else if (b != infinite_vertex && predicates::orient2d(vertices_[vertex], vertices_[a], vertices_[b]) <= 0.0)
+			{
+				return false;
+			}
+			e = halfedges_[prev(e)];
+		} while (e != start);
+		if (ghost == invalid_index)
+		{
+			return true;
+		}
+
+		// ghost is vertex->infinity in the ghost (vertex, infinity, before), whose hull edge is before->vertex.
+		// The hull runs clockwise beyond_before -> before -> vertex -> after -> beyond_after.
+		auto before = triangles_[prev(ghost)];
+		auto after = triangles_[prev(halfedges_[ghost])];
+		auto beyond_before = triangles_[prev(halfedges_[next(ghost)])];
+		auto beyond_after = triangles_[prev(halfedges_[prev(halfedges_[ghost])])];
+		return predicates::orient2d(vertices_[before], vertices_[vertex], vertices_[after]) <= 0.0 &&
+			predicates::orient2d(vertices_[vertex], vertices_[after], vertices_[beyond_after]) <= 0.0 &&
+			predicates::orient2d(vertices_[beyond_before], vertices_[before], vertices_[vertex]) <= 0.0;
+	}
+
+	/**
+	* Take a vertex out of the mesh. Its star is filled by ear clipping the polygon of its neighbours, using ears
+	* that do not contain the vertex; at the hull the clipping stops at the new, convex hull chain, which is
+	* closed off by ghosts. The new edges are added to queue and the star's spare slots are left dead until
+	* compact(). Returns false for degenerate stars that cannot be filled this way.
+	*/
+	template <typename PointType, typename T>
+	bool mesh<PointType, T>::remove(const std::size_t& vertex, std::vector<std::size_t>& queue)
+	{
+		// the neighbours in counter clockwise order. outside_[i] is the twin of the star edge from
+		// polygon_[i] to polygon_[i + 1].
+		polygon_.clear();
+		outside_.clear();
+		cavity_.clear();
+		std::size_t finite = 0;
+		const auto start = vertex_edges_[vertex];
+		auto e = start;
+		do
+		{
+			polygon_.push_back(triangles_[next(e)]);
+			outside_.push_back(halfedges_[next(e)]);
+			cavity_.push_back(e / 3);
+			if (!is_ghost(e / 3)) finite++;
+			e = halfedges_[prev(e)];
+		} while (e != start);
+		if (finite == finite_count_)
+		{
+			return false;
+		}
+		auto infinite = std::find(polygon_.begin(), polygon_.end(), infinite_vertex);
+		const auto on_hull = infinite != polygon_.end();
+		if (on_hull)
+		{
+			auto shift = infinite - polygon_.begin();
+			std::rotate(polygon_.begin(), infinite, polygon_.end());
+			std::rotate(outside_.begin(), outside_.begin() + shift, outside_.end());
+		}
+
+		const auto &removed = vertices_[vertex];
+		finite_count_ -= finite;
+		std::size_t used = 0;
+		while (polygon_.size() > 3)
+		{
+			const auto n = polygon_.size();
+			auto clipped = false;
+			for (std::size_t j = 0; j < n; j++)
+			{
+				auto before = (j + n - 1) % n;
+				auto after = (j + 1) % n;
+				auto a = polygon_[before];
+				auto b = polygon_[j];
+				auto c = polygon_[after];
+				if (a == infinite_vertex || b == infinite_vertex || c == infinite_vertex)
+				{
+					continue;
+				}
+				if (predicates::orient2d(vertices_[a], vertices_[b], vertices_[c]) > 0.0 &&
+					predicates::orient2d(vertices_[c], vertices_[a], removed) <= 0.0)
+				{
+					auto slot = cavity_[used++];
+					set_triangle(slot, a, b, c, outside_[before], outside_[j], invalid_index);
+					// the new polygon edge a->c faces the ear's edge c->a.
+					outside_[before] = 3 * slot + 2;
+					polygon_.erase(polygon_.begin() + j);
+					outside_.erase(outside_.begin() + j);
+					clipped = true;
+					break;
+				}
+			}
+			if (!clipped)
+			{
+				break;
+			}
+		}
+		if (!on_hull && polygon_.size() > 3)
+		{
+			return false;
+		}
+
+		// fan what is left from its first vertex: the last triangle, or the ghosts of the new hull chain.
+		const auto n = polygon_.size();
+		auto previous = invalid_index;
+		for (std::size_t j = 1; j + 1 < n; j++)
+		{
+			if (on_hull && j + 2 < n && predicates::orient2d(vertices_[polygon_[j]], vertices_[polygon_[j + 1]],
+				vertices_[polygon_[j + 2]]) > 0.0)
+			{
+				return false;
+			}
+			auto slot = cavity_[used++];
+			set_triangle(slot, polygon_[0], polygon_[j], polygon_[j + 1], j == 1 ? outside_[0] : 3 * previous + 2,
+				outside_[j], j + 2 == n ? outside_[n - 1] : invalid_index);
+			previous = slot;
+		}
+
+		for (std::size_t i = 0; i < cavity_.size(); i++)
+		{
+			auto slot = cavity_[i];
+			if (i < used)
+			{
+				if (!is_ghost(slot)) finite_count_++;
+				queue.push_back(3 * slot);
+				queue.push_back(3 * slot + 1);
+				queue.push_back(3 * slot + 2);
+			}
+			else
+			{
+				triangles_[3 * slot] = triangles_[3 * slot + 1] = triangles_[3 * slot + 2] = invalid_index;
+				dead_.push_back(slot);
+			}
+		}
+		vertex_edges_[vertex] = invalid_index;
+		return true;
+	}
+
+	/**
+	* Write the triangle (a, b, c) to slot and link each of its halfedges with the given twin, unless that is
+	* invalid_index.
+	*/
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::set_triangle(const std::size_t& slot, const std::size_t& a, const std::size_t& b,
+		const std::size_t& c, const std::size_t& ab, const std::size_t& bc, const std::size_t& ca)
+	{
+		const std::size_t corners[3] = { a, b, c };
+		const std::size_t twins[3] = { ab, bc, ca };
+		for (std::size_t i = 0; i < 3; i++)
+		{
+			triangles_[3 * slot + i] = corners[i];
+			set_vertex_edge(corners[i], 3 * slot + i);
+			if (twins[i] != invalid_index)
+			{
+				halfedges_[3 * slot + i] = twins[i];
+				halfedges_[twins[i]] = 3 * slot + i;
+			}
+		}
+	}
+
+	/**
+	* Flip the edge of halfedge a->b in (a, b, c) with its twin in (b, a, d) to the edge c-d.
+	*/
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::flip(const std::size_t& halfedge)
+	{
+		const auto twin = halfedges_[halfedge];
+		const auto a = triangles_[halfedge];
+		const auto b = triangles_[next(halfedge)];
+		const auto c = triangles_[prev(halfedge)];
+		const auto d = triangles_[prev(twin)];
+		const auto bc = halfedges_[next(halfedge)];
+		const auto ca = halfedges_[prev(halfedge)];
+		const auto ad = halfedges_[next(twin)];
+		const auto db = halfedges_[prev(twin)];
+		const auto first = halfedge / 3;
+		const auto second = twin / 3;
+		set_triangle(first, a, d, c, ad, invalid_index, ca);
+		set_triangle(second, d, b, c, db, bc, 3 * first + 1);
+	}
+
+	/**
+	* Lawson's flip algorithm: flip the queued edges that are not locally Delaunay and queue the edges around
+	* each flip, until the queue is empty. Hull edges and constrained edges are never flipped. Returns the
+	* number of flips.
+	*/
+	template <typename PointType, typename T>
+	std::size_t mesh<PointType, T>::legalize(std::vector<std::size_t>& queue)
+	{
+		std::size_t flips = 0;
+		while (!queue.empty())
+		{
+			auto e = queue.back();
+			queue.pop_back();
+			auto triangle = e / 3;
+			if (triangles_[3 * triangle] == invalid_index)
+			{
+				continue;
+			}
+			auto twin = halfedges_[e];
+			if (is_ghost(triangle) || is_ghost(twin / 3) ||
+				(!constraints_.empty() && is_constrained(triangles_[e], triangles_[next(e)])))
+			{
+				continue;
+			}
+			const auto &d = vertices_[triangles_[prev(twin)]];
+			if (predicates::incircle(vertices_[triangles_[e]], vertices_[triangles_[next(e)]], vertices_[triangles_[prev(e)]], d) > 0.0)
+			{
+				flip(e);
+				flips++;
+				auto other = twin / 3;
+				queue.push_back(3 * triangle);
+				queue.push_back(3 * triangle + 2);
+				queue.push_back(3 * other);
+				queue.push_back(3 * other + 1);
+			}
+		}
+		return flips;
+	}
+
+	/**
+	* Fill the dead slots left by remove() with the last triangles.
+	*/
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::compact()
+	{
+		std::sort(dead_.begin(), dead_.end());
+		for (auto it = dead_.rbegin(); it != dead_.rend(); ++it)
+		{
+			const auto slot = *it;
+			const auto last = triangle_count() - 1;
+			if (last != slot)
+			{
+				for (std::size_t i = 0; i < 3; i++)
+				{
+					auto vertex = triangles_[3 * last + i];
+					triangles_[3 * slot + i] = vertex;
+					halfedges_[3 * slot + i] = halfedges_[3 * last + i];
+					halfedges_[halfedges_[3 * last + i]] = 3 * slot + i;
+					if (vertex_edge(vertex) == 3 * last + i)
+					{
+						set_vertex_edge(vertex, 3 * slot + i);
+					}
+				}
+			}
+			triangles_.resize(3 * last);
+			halfedges_.resize(3 * last);
+		}
+		dead_.clear();
+		if (last_ >= triangle_count())
+		{
+			last_ = invalid_index;
+		}
+	}
+
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::set_vertex_edge(const std::size_t& vertex, const std::size_t& halfedge)
+	{
+		if (vertex == infinite_vertex)
+		{
+			infinite_edge_ = halfedge;
+		}
+		else
+		{
+			vertex_edges_[vertex] = halfedge;
+		}
+	}
+
+	template <typename PointType, typename T>
+	std::size_t& mesh<PointType, T>::link(const std::size_t& vertex)
+	{
+		if (vertex == infinite_vertex)
+		{
+			return infinite_link_;
+		}
+		if (link_.size() < vertices_.size())
+		{
+			link_.resize(vertices_.size());
+		}
+		return link_[vertex];
+	}
+
+	template <typename PointType, typename T>
+	std::uint32_t mesh<PointType, T>::next_stamp()
+	{
+		if (marks_.size() < triangles_.size() / 3)
+		{
+			marks_.resize(triangles_.size() / 3, 0);
+		}
+		if (stamp_ >= std::numeric_limits<std::uint32_t>::max() - 2)
+		{
+			std::fill(marks_.begin(), marks_.end(), 0);
+			stamp_ = 0;
+		}
+		stamp_ += 2;
+		return stamp_;
+	}
+
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::bootstrap()
+	{
+		// the first triangle needs three distinct, non collinear points.
+		const auto &first = vertices_[pending_.front()];
+		auto second = invalid_index;
+		for (const auto &candidate : pending_)
+		{
+			if (!(vertices_[candidate] == first))
+			{
+				second = candidate;
+				break;
+			}
+		}
+		if (second == invalid_index)
+		{
+			return;
+		}
+		for (const auto &candidate : pending_)
+		{
+			if (predicates::orient2d(first, vertices_[second], vertices_[candidate]) != 0.0)
+			{
+				// the queue is swapped out rather than moved, so both buffers keep their capacity.
+				waiting_.clear();
+				waiting_.swap(pending_);
+				auto a = waiting_.front();
+				auto c = candidate;
+				create_first_triangle(a, second, c);
+				for (const auto &index : waiting_)
+				{
+					if (index != a && index != second && index != c)
+					{
+						insert(index, last_);
+					}
+				}
+				return;
+			}
+		}
+	}
+
+	template <typename PointType, typename T>
+	void mesh<PointType, T>::create_first_triangle(std::size_t a, std::size_t b, std::size_t c)
+	{
+		if (predicates::orient2d(vertices_[a], vertices_[b], vertices_[c]) < 0.0)
+		{
+			std::swap(b, c);
+		}
+		const auto inf = infinite_vertex;
+		triangles_ = { a, b, c, b, a, inf, c, b, inf, a, c, inf };
+		halfedges_ = { 3, 6, 9, 0, 11, 7, 1, 5, 10, 2, 8, 4 };
+		vertex_edges_[a] = 0;
+		vertex_edges_[b] = 1;
+		vertex_edges_[c] = 2;
+		infinite_edge_ = 5;
+		finite_count_ = 1;
+		last_ = 0;
+		marks_.assign(4, 0);
+		recent_ = { 0, 1, 2, 3 };
+	}
+}
@@ -0,0 +1,664 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fileio.h"
+#include "mesh.h"
+#include "meshio.h"
+
+namespace delaunaypp
+{
+	namespace io
+	{
+		/**
+		* Settings for encode_mesh().
+		*/
+		struct mesh_codec_options
+		{
+			// every coordinate is rounded to one of 2^bits steps across the extent of the vertices on its axis.
+			std::uint32_t bits = 20;
+		};
+
+		/**
+		* Header of the compressed mesh format. It is followed by the smallest coordinate and the step of every
+		* axis as little endian doubles, connectivity_bytes of packed operation codes and the coordinate
+		* residuals as varints up to the end.
+		*/
+		struct compressed_mesh_header
+		{
+			char magic[4];
+			std::uint32_t version;
+			std::uint32_t dimension;
+			std::uint32_t bits;
+			// vertices decoded, and how many of them come from the traversal of the triangles.
+			std::uint64_t vertex_count;
+			std::uint64_t traversed_count;
+			// triangles traversed, ghosts included.
+			std::uint64_t triangle_count;
+			std::uint64_t connectivity_bytes;
+		};
+
+		static_assert(sizeof(compressed_mesh_header) == 48, "Unexpected compressed mesh header size.");
+
+		constexpr char compressed_mesh_magic[4] = { 'D', 'P', 'P', 'C' };
+		constexpr std::uint32_t compressed_mesh_version = 1;
+
+		namespace internal
+		{
+			// operation codes, one per triangle after the first: a new vertex takes one bit, the others three.
+			enum mesh_operation : std::uint8_t
+			{
+				new_vertex,
+				left_neighbour,
+				right_neighbour,
+				end_of_loop,
+				split_loop
+			};
+
+			class bit_writer
+			{
+			public:
+				void write(const std::uint32_t &bits, const unsigned &count)
+				{
+					word_ |= static_cast<std::uint64_t>(bits) << used_;
+					used_ += count;
+					if (used_ >= 32)
+					{
+						for (unsigned i = 0; i < 4; i++)
+						{
+							bytes_.push_back(static_cast<char>((word_ >> (8 * i)) & 0xff));
+						}
+						word_ >>= 32;
+						used_ -= 32;
+					}
+				}
+
+				std::vector<char> finish()
+				{
+					for (; used_ > 0; used_ = used_ > 8 ? used_ - 8 : 0)
+					{
+						bytes_.push_back(static_cast<char>(word_ & 0xff));
+						word_ >>= 8;
+					}
+					return std::move(bytes_);
+				}
+
+			private:
+				std::vector<char> bytes_;
+				std::uint64_t word_ = 0;
+				unsigned used_ = 0;
+			};
+
+			inline void write_varint(std::vector<char> &bytes, std::uint64_t value)
+			{
+				while (value >= 0x80)
+				{
+					bytes.push_back(static_cast<char>((value & 0x7f) | 0x80));
+					value >>= 7;
+				}
+				bytes.push_back(static_cast<char>(value));
+			}
+
+			inline std::uint64_t read_varint(const char *&source, const char *end)
+			{
+				std::uint64_t value = 0;
+				for (unsigned shift = 0; source < end && shift < 64; shift += 7)
+				{
+					const auto byte = static_cast<std::uint8_t>(*source++);
+					value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+					if (byte < 0x80)
+					{
+						return value;
+					}
+				}
+				throw std::runtime_error("Compressed mesh is truncated.");
+			}
+
+			inline std::uint64_t zigzag(const std::int64_t &value)
+			{
+				return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+			}
+
+			inline std::int64_t unzigzag(const std::uint64_t &value)
+			{
+				return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+			}
+
+			/**
+			* The position of a new vertex guessed from the edge it is attached to, a and b, and the corner o
+			* across that edge: the fourth corner of the parallelogram where all are finite. Missing positions
+			* belong to the infinite vertex.
+			*/
+			inline std::int64_t predict(const std::int64_t *a, const std::int64_t *b, const std::int64_t *o)
+			{
+				if (a != nullptr && b != nullptr)
+				{
+					return o != nullptr ? *a + *b - *o : (*a + *b) / 2;
+				}
+				return a != nullptr ? *a : (b != nullptr ? *b : 0);
+			}
+		}
+
+		/**
+		* Compress the vertices and the triangulation of the mesh. Coordinates are quantized on a grid of
+		* 2^options.bits steps per axis, so a decoded vertex is off by at most half a step; connectivity is kept
+		* exactly.
+		*
+		* Connectivity is coded after Rossignac's Edgebreaker. Ghosts make the triangulation a closed surface of
+		* genus 0, which is traversed from a ghost, triangle by triangle, across the boundary of the part done
+		* so far. Each triangle adds a vertex or closes onto the boundary left of the gate, right of it, on both
+		* sides, or elsewhere, splitting the boundary; that choice is all that is stored, in about two bits per
+		* triangle. Where a split lands on the boundary is not stored, since the decoder can work it out from the
+		* codes that follow. Vertices are numbered in the order the traversal meets them, and each is stored as
+		* the difference to the parallelogram prediction from the triangle it is attached to, as a zigzag varint.
+		* Vertices outside the triangulation follow, each as the difference to the one before.
+		*
+		* The decoded vertices come in the traversal order, which keeps neighbours close in memory, not in the
+		* order of the mesh; constraints and weights are not kept.
+		*/
+		template<typename PointType, typename T>
+		std::vector<char> encode_mesh(const mesh<PointType, T> &mesh, const mesh_codec_options &options = mesh_codec_options())
+		{
+			using MeshType = delaunaypp::mesh<PointType, T>;
+			if (options.bits < 1 || options.bits > 31)
+			{
+				throw std::runtime_error("Quantization takes 1 to 31 bits.");
+			}
+			const auto dimension = PointType::dimension();
+			const auto count = mesh.vertex_count();
+			std::vector<double> origin(dimension, 0.0), step(dimension, 1.0);
+			for (std::size_t i = 0; i < dimension && count > 0; i++)
+			{
+				auto low = static_cast<double>(mesh.vertex(0)[i]);
+				auto high = low;
+				for (std::size_t v = 1; v < count; v++)
+				{
+					low = std::min(low, static_cast<double>(mesh.vertex(v)[i]));
+					high = std::max(high, static_cast<double>(mesh.vertex(v)[i]));
+				}
+				origin[i] = low;
+				step[i] = high > low ? (high - low) / static_cast<double>((std::uint64_t(1) << options.bits) - 1) : 1.0;
+			}
+			// quantized coordinates, with room for the infinite vertex at the end.
+			std::vector<std::int64_t> grid(dimension * (count + 1), 0);
+			for (std::size_t v = 0; v < count; v++)
+			{
+				for (std::size_t i = 0; i < dimension; i++)
+				{
+					grid[dimension * v + i] = static_cast<std::int64_t>(std::llround((static_cast<double>(mesh.vertex(v)[i]) - origin[i]) / step[i]));
+				}
+			}
+			auto slot = [count](const std::size_t &vertex)
+			{
+				return vertex == infinite_vertex ? count : vertex;
+			};
+			auto position = [&](const std::size_t &vertex) -> const std::int64_t*
+			{
+				return vertex == infinite_vertex ? nullptr : &grid[dimension * vertex];
+			};
+			std::vector<char> residuals{};
+			auto store = [&](const std::size_t &vertex, const std::int64_t *a, const std::int64_t *b, const std::int64_t *o)
+			{
+				for (std::size_t i = 0; i < dimension && vertex != infinite_vertex; i++)
+				{
+					auto guess = internal::predict(a != nullptr ? a + i : nullptr, b != nullptr ? b + i : nullptr, o != nullptr ? o + i : nullptr);
+					internal::write_varint(residuals, internal::zigzag(grid[dimension * vertex + i] - guess));
+				}
+			};
+
+			const auto &triangles = mesh.triangles();
+			std::vector<std::uint8_t> reached(count + 1, 0);
+			std::vector<std::uint8_t> done(mesh.triangle_count(), 0);
+			internal::bit_writer connectivity{};
+			std::uint64_t traversed = 0;
+			std::uint64_t triangle_count = 0;
+			auto start = invalid_index;
+			for (std::size_t t = 0; t < mesh.triangle_count() && mesh.finite_triangle_count() > 0 && start == invalid_index; t++)
+			{
+				start = mesh.is_ghost(t) ? t : invalid_index;
+			}
+			if (start != invalid_index)
+			{
+				// the first triangle is a ghost turned so that the infinite vertex is its third corner.
+				auto gate = 3 * start;
+				while (triangles[MeshType::prev(gate)] != infinite_vertex)
+				{
+					gate = MeshType::next(gate);
+				}
+				const auto first = triangles[gate];
+				const auto second = triangles[MeshType::next(gate)];
+				store(first, nullptr, nullptr, nullptr);
+				store(second, position(first), nullptr, nullptr);
+				reached[first] = reached[second] = reached[count] = 1;
+				done[start] = 1;
+				traversed = 3;
+				triangle_count = 1;
+
+				// the gate is a halfedge of a done triangle on the boundary, from b to a, with the next triangle
+				// across it.
+				std::vector<std::size_t> gates{};
+				while (true)
+				{
+					const auto h = mesh.twin(gate);
+					done[h / 3] = 1;
+					triangle_count++;
+					const auto w = triangles[MeshType::prev(h)];
+					if (!reached[slot(w)])
+					{
+						connectivity.write(0, 1);
+						reached[slot(w)] = 1;
+						traversed++;
+						store(w, position(triangles[h]), position(triangles[gate]), position(triangles[MeshType::prev(gate)]));
+						gate = MeshType::prev(h);
+						continue;
+					}
+					const auto left = done[mesh.twin(MeshType::next(h)) / 3] != 0;
+					const auto right = done[mesh.twin(MeshType::prev(h)) / 3] != 0;
+					if (left && right)
+					{
+						connectivity.write(5, 3);
+						if (gates.empty())
+						{
+							break;
+						}
+						gate = gates.back();
+						gates.pop_back();
+					}
+					else if (left)
+					{
+						connectivity.write(1, 3);
+						gate = MeshType::prev(h);
+					}
+					else if (right)
+					{
+						connectivity.write(3, 3);
+						gate = MeshType::next(h);
+					}
+					else
+					{
+						// the boundary splits at w: the part from a to w first, the part from w to b later.
+						connectivity.write(7, 3);
+						gates.push_back(MeshType::next(h));
+						gate = MeshType::prev(h);
+					}
+				}
+			}
+			// the vertices the triangulation does not reach.
+			auto previous = static_cast<const std::int64_t*>(nullptr);
+			std::uint64_t vertex_count = traversed > 0 ? traversed - 1 : 0;
+			for (std::size_t v = 0; v < count; v++)
+			{
+				if (!reached[v])
+				{
+					store(v, previous, nullptr, nullptr);
+					previous = position(v);
+					vertex_count++;
+				}
+			}
+
+			const auto codes = connectivity.finish();
+			compressed_mesh_header header{};
+			std::memcpy(header.magic, compressed_mesh_magic, sizeof(header.magic));
+			header.version = compressed_mesh_version;
+			header.dimension = static_cast<std::uint32_t>(dimension);
+			header.bits = options.bits;
+			header.vertex_count = vertex_count;
+			header.traversed_count = traversed;
+			header.triangle_count = triangle_count;
+			header.connectivity_bytes = codes.size();
+
+			std::vector<char> result(sizeof(header) + 2 * dimension * sizeof(double));
+			std::memcpy(result.data(), &header, sizeof(header));
+			std::memcpy(result.data() + sizeof(header), origin.data(), dimension * sizeof(double));
+			std::memcpy(result.data() + sizeof(header) + dimension * sizeof(double), step.data(), dimension * sizeof(double));
+			result.reserve(result.size() + codes.size() + residuals.size());
+			result.insert(result.end(), codes.begin(), codes.end());
+			result.insert(result.end(), residuals.begin(), residuals.end());
+			return result;
+		}
+
+		/**
+		* Decode what encode_mesh() made into vertices and finite triangles, counter clockwise.
+		*
+		* The codes are read twice. The first pass works out where every split lands: the boundary left to a
+		* split is traversed completely before the rest, up to its own end code, so its length follows from the
+		* codes in between, like matching parentheses. The second pass repeats the traversal on the boundary
+		* kept as a linked list, walking from the gate to a split's vertex along the shorter side. It adds every
+		* triangle and every new vertex as it goes, so decoding is linear in practice.
+		*/
+		template<typename PointType, typename T = typename PointType::value_type>
+		indexed_mesh<PointType> decode_mesh(const char *data, const std::size_t &size)
+		{
+			compressed_mesh_header header;
+			if (size < sizeof(header))
+			{
+				throw std::runtime_error("Too small to be a compressed mesh.");
+			}
+			std::memcpy(&header, data, sizeof(header));
+			if (std::memcmp(header.magic, compressed_mesh_magic, sizeof(header.magic)) != 0 || header.version != compressed_mesh_version)
+			{
+				throw std::runtime_error("Not a supported delaunaypp compressed mesh.");
+			}
+			const std::size_t dimension = header.dimension;
+			if (dimension < PointType::dimension())
+			{
+				throw std::runtime_error("Compressed mesh does not match the point type.");
+			}
+			// every size is checked against the data before anything is allocated from it: an operation takes at
+			// least a bit and a coordinate at least a byte.
+			auto rest = size - sizeof(header);
+			if (rest / (2 * sizeof(double)) < dimension || rest - 2 * dimension * sizeof(double) < header.connectivity_bytes)
+			{
+				throw std::runtime_error("Compressed mesh is truncated.");
+			}
+			rest -= 2 * dimension * sizeof(double) + static_cast<std::size_t>(header.connectivity_bytes);
+			if ((header.triangle_count > 0 && header.triangle_count - 1 > header.connectivity_bytes * 8) ||
+				header.vertex_count > rest / dimension || header.traversed_count > header.vertex_count + 1 ||
+				(header.traversed_count > 0) != (header.triangle_count > 0))
+			{
+				throw std::runtime_error("Compressed mesh is truncated.");
+			}
+			std::vector<double> origin(dimension), step(dimension);
+			std::memcpy(origin.data(), data + sizeof(header), dimension * sizeof(double));
+			std::memcpy(step.data(), data + sizeof(header) + dimension * sizeof(double), dimension * sizeof(double));
+			const auto *codes = data + sizeof(header) + 2 * dimension * sizeof(double);
+			const auto *source = codes + header.connectivity_bytes;
+			const auto *end = data + size;
+
+			// operation codes, and the length of the boundary every split leaves to be done first.
+			const auto operations = static_cast<std::size_t>(header.triangle_count > 0 ? header.triangle_count - 1 : 0);
+			std::vector<std::uint8_t> ops(operations);
+			std::vector<std::size_t> splits{};
+			{
+				std::uint64_t word = 0;
+				unsigned available = 0;
+				std::size_t read = 0;
+				auto bits = [&](const unsigned &count)
+				{
+					if (available < count)
+					{
+						std::uint64_t more = 0;
+						const auto bytes = std::min<std::size_t>(4, static_cast<std::size_t>(header.connectivity_bytes) - read);
+						for (std::size_t i = 0; i < bytes; i++)
+						{
+							more |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(codes[read + i])) << (8 * i);
+						}
+						read += bytes;
+						word |= more << available;
+						available += 8 * static_cast<unsigned>(bytes);
+						if (available < count)
+						{
+							throw std::runtime_error("Compressed mesh is truncated.");
+						}
+					}
+					const auto value = static_cast<std::uint32_t>(word & ((std::uint64_t(1) << count) - 1));
+					word >>= count;
+					available -= count;
+					return value;
+				};
+				static const std::uint8_t names[4] = { internal::left_neighbour, internal::right_neighbour,
+					internal::end_of_loop, internal::split_loop };
+
+				// the boundary grows by one with a new vertex and shrinks by one on either side. An end code
+				// closes a boundary of three, so a finished one started with three minus its total change.
+				std::vector<std::pair<std::int64_t, std::size_t>> open{ { 0, invalid_index } };
+				for (std::size_t k = 0; k < operations; k++)
+				{
+					if (open.empty())
+					{
+						throw std::runtime_error("Compressed mesh has inconsistent connectivity.");
+					}
+					ops[k] = bits(1) == 0 ? static_cast<std::uint8_t>(internal::new_vertex) : static_cast<std::uint8_t>(names[bits(2)]);
+					switch (ops[k])
+					{
+					case internal::new_vertex:
+						open.back().first++;
+						break;
+					case internal::left_neighbour:
+					case internal::right_neighbour:
+						open.back().first--;
+						break;
+					case internal::split_loop:
+						open.emplace_back(0, splits.size());
+						splits.push_back(0);
+						break;
+					default:
+					{
+						const auto length = 3 - open.back().first;
+						const auto split = open.back().second;
+						open.pop_back();
+						if (split != invalid_index)
+						{
+							if (length < 3)
+							{
+								throw std::runtime_error("Compressed mesh has inconsistent connectivity.");
+							}
+							splits[split] = static_cast<std::size_t>(length);
+							open.back().first -= length - 1;
+						}
+						else if (length != 3)
+						{
+							throw std::runtime_error("Compressed mesh has inconsistent connectivity.");
+						}
+					}
+					}
+				}
+				if (!open.empty() && operations > 0)
+				{
+					throw std::runtime_error("Compressed mesh has inconsistent connectivity.");
+				}
+			}
+
+			indexed_mesh<PointType> result{};
+			const auto vertex_count = static_cast<std::size_t>(header.vertex_count);
+			const auto traversed = static_cast<std::size_t>(header.traversed_count);
+			// vertices are numbered in traversal order; number 2 is the infinite one, which is left out.
+			std::vector<std::int64_t> grid(dimension * (vertex_count + 1), 0);
+			result.vertices.resize(vertex_count);
+			auto output = [traversed](const std::size_t &vertex)
+			{
+				return traversed > 0 && vertex > 2 ? vertex - 1 : vertex;
+			};
+			auto position = [&](const std::size_t &vertex) -> const std::int64_t*
+			{
+				return traversed > 0 && vertex == 2 ? nullptr : &grid[dimension * vertex];
+			};
+			auto load = [&](const std::size_t &vertex, const std::int64_t *a, const std::int64_t *b, const std::int64_t *o)
+			{
+				auto &point = result.vertices[output(vertex)];
+				for (std::size_t i = 0; i < dimension; i++)
+				{
+					const auto value = internal::predict(a != nullptr ? a + i : nullptr, b != nullptr ? b + i : nullptr,
+						o != nullptr ? o + i : nullptr) + internal::unzigzag(internal::read_varint(source, end));
+					grid[dimension * vertex + i] = value;
+					if (i < PointType::dimension())
+					{
+						point[i] = static_cast<T>(origin[i] + static_cast<double>(value) * step[i]);
+					}
+				}
+			};
+
+			if (traversed > 0)
+			{
+				if (traversed < 3)
+				{
+					throw std::runtime_error("Compressed mesh has inconsistent connectivity.");
+				}
+				// the boundary as a ring of nodes, each the start of a boundary edge, with the corner across that
+				// edge in the triangle already done.
+				std::vector<std::size_t> next(3 + operations), prev(3 + operations), vertex(3 + operations), opposite(3 + operations);
+				std::size_t nodes = 3;
+				for (std::size_t i = 0; i < 3; i++)
+				{
+					next[i] = (i + 1) % 3;
+					prev[i] = (i + 2) % 3;
+					vertex[i] = i;
+					opposite[i] = (i + 2) % 3;
+				}
+				load(0, nullptr, nullptr, nullptr);
+				load(1, position(0), nullptr, nullptr);
+				result.triangles.reserve(3 * (operations + 1));
+				std::vector<std::pair<std::size_t, std::size_t>> gates{};
+				std::size_t gate = 0;
+				std::size_t length = 3;
+				std::size_t added = 3;
+				std::size_t split = 0;
+				for (std::size_t k = 0; k < operations; k++)
+				{
+					const auto g = gate;
+					const auto a = next[g];
+					const auto b = vertex[g];
+					auto w = invalid_index;
+					switch (ops[k])
+					{
+					case internal::new_vertex:
+					{
+						if (added == traversed)
+						{
+							throw std::runtime_error("Compressed mesh has inconsistent connectivity.");
+						}
+						w = added++;
+						load(w, position(vertex[a]), position(b), position(opposite[g]));
+						const auto node = nodes++;
+						vertex[node] = w;
+						opposite[node] = b;
+						next[node] = a;
+						prev[node] = g;
+						next[g] = node;
+						prev[a] = node;
+						opposite[g] = vertex[a];
+						gate = node;
+						length++;
+						break;
+					}
+					case internal::left_neighbour:
+					{
+						// w is the vertex before b, which leaves the boundary.
+						const auto p = prev[g];
+						w = vertex[p];
+						next[p] = a;
+						prev[a] = p;
+						opposite[p] = b;
+						gate = p;
+						length--;
+						break;
+					}
+					case internal::right_neighbour:
+					{
+						// w is the vertex after a, which leaves the boundary.
+						const auto q = next[a];
+						w = vertex[q];
+						opposite[g] = vertex[a];
+						next[g] = q;
+						prev[q] = g;
+						length--;
+						break;
+					}
+					case internal::end_of_loop:
+						w = vertex[prev[g]];
+						if (!gates.empty())
+						{
+							gate = gates.back().first;
+							length = gates.back().second;
+							gates.pop_back();
+						}
+						break;
+					default:
+					{
+						// w is the given number of places on from b; from a to w goes first, from w to b later.
+						const auto places = splits[split++];
+						if (places + 2 > length)
+						{
+							throw std::runtime_error("Compressed mesh has inconsistent connectivity.");
+						}
+						auto node = a;
+						if (places - 1 <= length - places)
+						{
+							for (std::size_t i = 1; i < places; i++)
+							{
+								node = next[node];
+							}
+						}
+						else
+						{
+							node = g;
+							for (std::size_t i = 0; i < length - places; i++)
+							{
+								node = prev[node];
+							}
+						}
+						w = vertex[node];
+						const auto copy = nodes++;
+						vertex[copy] = w;
+						opposite[copy] = b;
+						next[copy] = a;
+						prev[copy] = prev[node];
+						next[prev[node]] = copy;
+						prev[a] = copy;
+						next[g] = node;
+						prev[node] = g;
+						opposite[g] = vertex[a];
+						gates.emplace_back(g, length - places + 1);
+						gate = copy;
+						length = places;
+					}
+					}
+					const auto c = vertex[a];
+					if (c != 2 && b != 2 && w != 2)
+					{
+						result.triangles.push_back(output(c));
+						result.triangles.push_back(output(b));
+						result.triangles.push_back(output(w));
+					}
+				}
+				if (added != traversed)
+				{
+					throw std::runtime_error("Compressed mesh has inconsistent connectivity.");
+				}
+			}
+
+			// the vertices outside the triangulation, each relative to the one before.
+			const auto first = traversed;
+			const auto last = traversed > 0 ? vertex_count + 1 : vertex_count;
+			for (auto v = first; v < last; v++)
+			{
+				load(v, v > first ? position(v - 1) : nullptr, nullptr, nullptr);
+			}
+			return result;
+		}
+
+		template<typename PointType, typename T = typename PointType::value_type>
+		indexed_mesh<PointType> decode_mesh(const std::vector<char> &data)
+		{
+			return decode_mesh<PointType, T>(data.data(), data.size());
+		}
+
+		/**
+		* Write the mesh compressed by encode_mesh().
+		*/
+		template<typename PointType, typename T>
+		void write_compressed(const std::string &path, const mesh<PointType, T> &mesh, const mesh_codec_options &options = mesh_codec_options())
+		{
+			const auto data = encode_mesh(mesh, options);
+			file_writer writer(path);
+			writer.write(data.data(), data.size());
+			writer.close();
+		}
+
+		/**
+		* Read a file written by write_compressed().
+		*/
+		template<typename PointType, typename T = typename PointType::value_type>
+		indexed_mesh<PointType> read_compressed(const std::string &path)
+		{
+			mapped_file file(path);
+			return decode_mesh<PointType, T>(file.data(), file.size());
+		}
+	}
+}
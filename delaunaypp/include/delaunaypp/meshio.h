@@ -0,0 +1,245 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fileio.h"
+#include "mesh.h"
+
+namespace delaunaypp
+{
+	namespace io
+	{
+		/**
+		* Header of the raw indexed mesh format. It is followed by vertex_count * dimension little endian
+		* doubles and triangle_count * 3 vertex indices of index_size bytes each.
+		*/
+		struct mesh_file_header
+		{
+			char magic[4];
+			std::uint32_t version;
+			std::uint32_t dimension;
+			std::uint32_t index_size;
+			std::uint64_t vertex_count;
+			std::uint64_t triangle_count;
+		};
+
+		static_assert(sizeof(mesh_file_header) == 32, "Unexpected mesh file header size.");
+
+		constexpr char mesh_file_magic[4] = { 'D', 'P', 'P', 'M' };
+		constexpr std::uint32_t mesh_file_version = 1;
+
+		/**
+		* Vertices and vertex index triples read back from a mesh file.
+		*/
+		template<typename PointType>
+		struct indexed_mesh
+		{
+			std::vector<PointType> vertices;
+			std::vector<std::size_t> triangles;
+		};
+
+		namespace internal
+		{
+			inline bool is_finite_triangle(const std::vector<std::size_t> &triangles, const std::size_t &t)
+			{
+				return triangles[3 * t] != infinite_vertex &&
+					triangles[3 * t + 1] != infinite_vertex &&
+					triangles[3 * t + 2] != infinite_vertex;
+			}
+
+			inline std::size_t count_finite(const std::vector<std::size_t> &triangles)
+			{
+				std::size_t count = 0;
+				for (std::size_t t = 0; t < triangles.size() / 3; t++)
+				{
+					if (is_finite_triangle(triangles, t)) count++;
+				}
+				return count;
+			}
+
+			template<typename Index>
+			void write_indices(file_writer &writer, const std::vector<std::size_t> &triangles)
+			{
+				Index record[3];
+				for (std::size_t t = 0; t < triangles.size() / 3; t++)
+				{
+					if (!is_finite_triangle(triangles, t))
+					{
+						continue;
+					}
+					record[0] = static_cast<Index>(triangles[3 * t]);
+					record[1] = static_cast<Index>(triangles[3 * t + 1]);
+					record[2] = static_cast<Index>(triangles[3 * t + 2]);
+					writer.write(record, sizeof(record));
+				}
+			}
+		}
+
+		/**
+		* Write vertices and triangles as a binary little endian PLY file. Triangles are index triples into
+		* vertices; ghost triangles are skipped. 2D vertices are written with z = 0.
+		*/
+		template<typename PointType>
+		void write_ply(const std::string &path, const std::vector<PointType> &vertices, const std::vector<std::size_t> &triangles)
+		{
+			if (vertices.size() > std::numeric_limits<std::uint32_t>::max())
+			{
+				throw std::runtime_error("PLY output is limited to 2^32 vertices.");
+			}
+			auto face_count = internal::count_finite(triangles);
+
+			file_writer writer(path);
+			std::string header = "ply\nformat binary_little_endian 1.0\ncomment delaunaypp\n";
+			header += "element vertex " + std::to_string(vertices.size()) + "\n";
+			header += "property double x\nproperty double y\nproperty double z\n";
+			header += "element face " + std::to_string(face_count) + "\n";
+			header += "property list uchar uint vertex_indices\nend_header\n";
+			writer.write(header.data(), header.size());
+
+			double coordinates[3];
+			for (const auto &vertex : vertices)
+			{
+				coordinates[0] = static_cast<double>(vertex[0]);
+				coordinates[1] = static_cast<double>(vertex[1]);
+				coordinates[2] = PointType::dimension() > 2 ? static_cast<double>(vertex[2]) : 0.0;
+				writer.write(coordinates, sizeof(coordinates));
+			}
+
+			// count byte followed by three 32 bit indices.
+			char record[13];
+			record[0] = 3;
+			for (std::size_t t = 0; t < triangles.size() / 3; t++)
+			{
+				if (!internal::is_finite_triangle(triangles, t))
+				{
+					continue;
+				}
+				for (std::size_t i = 0; i < 3; i++)
+				{
+					auto index = static_cast<std::uint32_t>(triangles[3 * t + i]);
+					std::memcpy(record + 1 + 4 * i, &index, sizeof(index));
+				}
+				writer.write(record, sizeof(record));
+			}
+			writer.close();
+		}
+
+		template<typename PointType, typename T>
+		void write_ply(const std::string &path, const mesh<PointType, T> &mesh)
+		{
+			write_ply(path, mesh.vertices(), mesh.triangles());
+		}
+
+		/**
+		* Write vertices and triangles in the raw indexed format. Indices are 32 bit unless there are more
+		* vertices than fit. Ghost triangles are skipped.
+		*/
+		template<typename PointType>
+		void write_indexed_binary(const std::string &path, const std::vector<PointType> &vertices, const std::vector<std::size_t> &triangles)
+		{
+			mesh_file_header header{};
+			std::memcpy(header.magic, mesh_file_magic, sizeof(header.magic));
+			header.version = mesh_file_version;
+			header.dimension = static_cast<std::uint32_t>(PointType::dimension());
+			header.index_size = vertices.size() > std::numeric_limits<std::uint32_t>::max() ? 8 : 4;
+			header.vertex_count = vertices.size();
+			header.triangle_count = internal::count_finite(triangles);
+
+			file_writer writer(path);
+			writer.write_value(header);
+			for (const auto &vertex : vertices)
+			{
+				for (std::size_t i = 0; i < PointType::dimension(); i++)
+				{
+					writer.write_value(static_cast<double>(vertex[i]));
+				}
+			}
+			if (header.index_size == 4)
+			{
+				internal::write_indices<std::uint32_t>(writer, triangles);
+			}
+			else
+			{
+				internal::write_indices<std::uint64_t>(writer, triangles);
+			}
+			writer.close();
+		}
+
+		template<typename PointType, typename T>
+		void write_indexed_binary(const std::string &path, const mesh<PointType, T> &mesh)
+		{
+			write_indexed_binary(path, mesh.vertices(), mesh.triangles());
+		}
+
+		/**
+		* Read a file written by write_indexed_binary.
+		*/
+		template<typename PointType, typename T = typename PointType::value_type>
+		indexed_mesh<PointType> read_indexed_binary(const std::string &path)
+		{
+			mapped_file file(path);
+			mesh_file_header header;
+			if (file.size() < sizeof(header))
+			{
+				throw std::runtime_error("File is too small to be a mesh file.");
+			}
+			std::memcpy(&header, file.data(), sizeof(header));
+			if (std::memcmp(header.magic, mesh_file_magic, sizeof(header.magic)) != 0 || header.version != mesh_file_version)
+			{
+				throw std::runtime_error("Not a supported delaunaypp mesh file.");
+			}
+			if (header.dimension < PointType::dimension() || (header.index_size != 4 && header.index_size != 8))
+			{
+				throw std::runtime_error("Mesh file does not match the point type.");
+			}
+			// each section by division, since the sizes the header claims may not fit in a std::size_t.
+			auto rest = file.size() - sizeof(header);
+			if (header.vertex_count > rest / (header.dimension * sizeof(double)))
+			{
+				throw std::runtime_error("Mesh file is truncated.");
+			}
+			rest -= static_cast<std::size_t>(header.vertex_count) * header.dimension * sizeof(double);
+			if (header.triangle_count > rest / (3 * header.index_size))
+			{
+				throw std::runtime_error("Mesh file is truncated.");
+			}
+
+			indexed_mesh<PointType> result;
+			result.vertices.resize(static_cast<std::size_t>(header.vertex_count));
+			auto source = file.data() + sizeof(header);
+			for (auto &vertex : result.vertices)
+			{
+				for (std::size_t i = 0; i < PointType::dimension(); i++)
+				{
+					double value;
+					std::memcpy(&value, source + i * sizeof(double), sizeof(double));
+					vertex[i] = static_cast<T>(value);
+				}
+				source += header.dimension * sizeof(double);
+			}
+
+			result.triangles.resize(static_cast<std::size_t>(header.triangle_count * 3));
+			for (auto &index : result.triangles)
+			{
+				if (header.index_size == 4)
+				{
+					std::uint32_t value;
+					std::memcpy(&value, source, sizeof(value));
+					index = value;
+				}
+				else
+				{
+					std::uint64_t value;
+					std::memcpy(&value, source, sizeof(value));
+					index = static_cast<std::size_t>(value);
+				}
+				source += header.index_size;
+			}
+			return result;
+		}
+	}
+}
@@ -0,0 +1,178 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "geometry.h"
+#include "mesh.h"
+
+namespace delaunaypp
+{
+	/**
+	* Delaunay triangulation of a point set on the flat torus. Corner i of triangle t is the point
+	* triangles[3t + i], shifted by offsets[6t + 2i] domain widths along x and offsets[6t + 2i + 1] domain heights
+	* along y. The first corner of every triangle is never shifted, so triangles that do not wrap across the
+	* domain boundary have zero offsets throughout. Every triangle of the torus is listed once.
+	*/
+	struct periodic_triangulation
+	{
+		std::vector<std::size_t> triangles;
+		std::vector<std::int32_t> offsets;
+	};
+
+	/**
+	* Triangulate points periodically over the domain [min_x, max_x) x [min_y, max_y). Points outside the domain
+	* are wrapped into it and points that then coincide are used once. Only the copies of the points within a
+	* margin of the domain boundary are triangulated along with the points themselves, so the cost is close to
+	* that of an ordinary triangulation. Each triangle is kept from the copy whose circumcenter lies in a
+	* fundamental region, the domain shifted by an irrational fraction of the point spacing so that the
+	* cocircular points of grids are not cut apart. The triangulation is complete once the kept circumcircles
+	* fit inside the margin and there are exactly twice as many triangles as points, which holds for every
+	* triangulation of the torus. Otherwise the margin is doubled and the points triangulated again.
+	*/
+	template<typename PointType, typename T = typename PointType::value_type>
+	periodic_triangulation periodic_delaunay(const std::vector<PointType> &points, const double &min_x, const double &min_y,
+		const double &max_x, const double &max_y)
+	{
+		const auto width = max_x - min_x;
+		const auto height = max_y - min_y;
+		if (!(width > 0.0) || !(height > 0.0))
+		{
+			throw std::runtime_error("The periodic domain must have a positive width and height.");
+		}
+		periodic_triangulation result{};
+		if (points.empty())
+		{
+			return result;
+		}
+
+		auto wrap = [](const double &value, const double &low, const double &length)
+		{
+			auto wrapped = low + std::fmod(value - low, length);
+			if (wrapped < low) wrapped += length;
+			return wrapped < low + length ? wrapped : low;
+		};
+		std::vector<std::pair<double, double>> wrapped(points.size());
+		for (std::size_t i = 0; i < points.size(); i++)
+		{
+			wrapped[i] = std::make_pair(wrap(static_cast<double>(points[i].x()), min_x, width),
+				wrap(static_cast<double>(points[i].y()), min_y, height));
+		}
+
+		// about three point spacings hold the circumcircles of evenly spread points. Any empty circle is smaller
+		// than the domain's diagonal, so a margin beyond width + height must succeed.
+		const auto spacing = std::sqrt(width * height / static_cast<double>(points.size()));
+		const auto region_x = min_x + std::min(0.3819660112501051 * spacing, 0.5 * width);
+		const auto region_y = min_y + std::min(0.2360679774997897 * spacing, 0.5 * height);
+		const auto shift = std::max(region_x - min_x, region_y - min_y);
+		auto margin = 3.0 * spacing;
+		std::vector<std::size_t> representative(points.size());
+		while (true)
+		{
+			// the points themselves first, so that vertex i is point i, then their copies within the margin.
+			std::vector<PointType> extended{};
+			std::vector<std::size_t> source{};
+			std::vector<std::int32_t> shifts{};
+			const auto expected = points.size() + points.size() / 8;
+			extended.reserve(expected);
+			source.reserve(expected);
+			shifts.reserve(2 * expected);
+			auto add = [&](const std::size_t &index, const std::int32_t &dx, const std::int32_t &dy)
+			{
+				const auto x = wrapped[index].first + dx * width;
+				const auto y = wrapped[index].second + dy * height;
+				if (x >= min_x - margin && x <= max_x + margin && y >= min_y - margin && y <= max_y + margin)
+				{
+					extended.emplace_back(static_cast<T>(x), static_cast<T>(y));
+					source.push_back(index);
+					shifts.push_back(dx);
+					shifts.push_back(dy);
+				}
+			};
+			for (std::size_t index = 0; index < points.size(); index++)
+			{
+				add(index, 0, 0);
+			}
+			const auto steps_x = static_cast<std::int32_t>(std::ceil(margin / width));
+			const auto steps_y = static_cast<std::int32_t>(std::ceil(margin / height));
+			for (auto dx = -steps_x; dx <= steps_x; dx++)
+			{
+				for (auto dy = -steps_y; dy <= steps_y; dy++)
+				{
+					for (std::size_t index = 0; (dx != 0 || dy != 0) && index < points.size(); index++)
+					{
+						add(index, dx, dy);
+					}
+				}
+			}
+
+			mesh<PointType, T> cover(std::move(extended));
+			cover.triangulate();
+
+			// the mesh keeps one of the points at each position; every copy stands for the one kept in the domain.
+			std::size_t count = 0;
+			for (std::size_t i = 0; i < points.size(); i++)
+			{
+				representative[i] = i;
+				if (cover.is_inserted(i))
+				{
+					count++;
+					continue;
+				}
+				const auto t = cover.locate(cover.vertex(i));
+				for (std::size_t k = 0; k < 3; k++)
+				{
+					if (cover.vertex(cover.triangles()[3 * t + k]) == cover.vertex(i))
+					{
+						representative[i] = cover.triangles()[3 * t + k];
+					}
+				}
+			}
+			result.triangles.reserve(3 * 2 * count);
+			result.offsets.reserve(6 * 2 * count);
+			result.triangles.clear();
+			result.offsets.clear();
+			const auto &triangles = cover.triangles();
+			auto complete = true;
+			for (std::size_t t = 0; t < cover.triangle_count(); t++)
+			{
+				if (cover.is_ghost(t))
+				{
+					continue;
+				}
+				const auto &a = cover.vertex(triangles[3 * t]);
+				const auto center = circumcenter(a, cover.vertex(triangles[3 * t + 1]), cover.vertex(triangles[3 * t + 2]));
+				if (!(center.x() >= region_x && center.x() < region_x + width && center.y() >= region_y && center.y() < region_y + height))
+				{
+					continue;
+				}
+				// a circle that leaves the covered band may hold points that were not triangulated.
+				if (squared_distance(center, a) >= (margin - shift) * (margin - shift))
+				{
+					complete = false;
+					break;
+				}
+				const auto first = triangles[3 * t];
+				for (std::size_t i = 0; i < 3; i++)
+				{
+					const auto vertex = triangles[3 * t + i];
+					result.triangles.push_back(representative[source[vertex]]);
+					result.offsets.push_back(shifts[2 * vertex] - shifts[2 * first]);
+					result.offsets.push_back(shifts[2 * vertex + 1] - shifts[2 * first + 1]);
+				}
+			}
+			if (complete && result.triangles.size() == 6 * count)
+			{
+				return result;
+			}
+			if (margin > width + height)
+			{
+				throw std::runtime_error("Could not triangulate the points periodically.");
+			}
+			margin *= 2.0;
+		}
+	}
+}
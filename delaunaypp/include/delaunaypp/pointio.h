@@ -0,0 +1,457 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <clocale>
+#include <iterator>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+#include "fileio.h"
+
+namespace delaunaypp
+{
+	namespace io
+	{
+		/**
+		* Header of the binary point format. It is followed by count * dimension little endian doubles,
+		* stored point after point.
+		*/
+		struct point_file_header
+		{
+			char magic[4];
+			std::uint32_t version;
+			std::uint32_t dimension;
+			std::uint32_t flags;
+			std::uint64_t count;
+		};
+
+		static_assert(sizeof(point_file_header) == 24, "Unexpected point file header size.");
+
+		constexpr char point_file_magic[4] = { 'D', 'P', 'P', 'P' };
+		constexpr std::uint32_t point_file_version = 1;
+
+		namespace internal
+		{
+			inline bool is_space(const char c)
+			{
+				return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f' || c == ',';
+			}
+
+			inline double power_of_ten(int exponent)
+			{
+				static const double powers[] = {
+					1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+					1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+				return powers[exponent];
+			}
+
+			// slow but correctly rounded fallback that does not depend on the global C locale.
+			inline double parse_double_slow(const char *first, const char *last)
+			{
+				std::istringstream stream(std::string(first, last));
+				stream.imbue(std::locale::classic());
+				double value = 0.0;
+				stream >> value;
+				if (stream.fail())
+				{
+					throw std::runtime_error("Invalid number: " + std::string(first, last));
+				}
+				return value;
+			}
+
+			/**
+			* Parse a double from [first, last). On return first points past the parsed token.
+			* Returns false if no number could be read.
+			*/
+			inline bool parse_double(const char *&first, const char *last, double &value)
+			{
+#if defined(__cpp_lib_to_chars)
+				// from_chars takes no plus sign, the fallback below does.
+				auto start = first;
+				if (start != last && *start == '+')
+				{
+					++start;
+					if (start != last && *start == '-')
+					{
+						return false;
+					}
+				}
+				auto result = std::from_chars(start, last, value);
+				if (result.ec != std::errc())
+				{
+					return false;
+				}
+				first = result.ptr;
+				return true;
+#else
+				auto current = first;
+				auto negative = false;
+				if (current != last && (*current == '-' || *current == '+'))
+				{
+					negative = *current == '-';
+					++current;
+				}
+
+				std::uint64_t mantissa = 0;
+				auto digits = 0;
+				auto exponent = 0;
+				auto any_digit = false;
+				while (current != last && *current >= '0' && *current <= '9')
+				{
+					any_digit = true;
+					if (digits < 19)
+					{
+						mantissa = mantissa * 10 + static_cast<std::uint64_t>(*current - '0');
+						if (mantissa != 0) digits++;
+					}
+					else
+					{
+						exponent++;
+						digits++;
+					}
+					++current;
+				}
+				if (current != last && *current == '.')
+				{
+					++current;
+					while (current != last && *current >= '0' && *current <= '9')
+					{
+						any_digit = true;
+						if (digits < 19)
+						{
+							mantissa = mantissa * 10 + static_cast<std::uint64_t>(*current - '0');
+							if (mantissa != 0) digits++;
+							exponent--;
+						}
+						else
+						{
+							digits++;
+						}
+						++current;
+					}
+				}
+				if (!any_digit)
+				{
+					return false;
+				}
+				if (current != last && (*current == 'e' || *current == 'E'))
+				{
+					auto exp_current = current + 1;
+					auto exp_negative = false;
+					if (exp_current != last && (*exp_current == '-' || *exp_current == '+'))
+					{
+						exp_negative = *exp_current == '-';
+						++exp_current;
+					}
+					if (exp_current != last && *exp_current >= '0' && *exp_current <= '9')
+					{
+						auto exp_value = 0;
+						while (exp_current != last && *exp_current >= '0' && *exp_current <= '9')
+						{
+							if (exp_value < 100000) exp_value = exp_value * 10 + (*exp_current - '0');
+							++exp_current;
+						}
+						exponent += exp_negative ? -exp_value : exp_value;
+						current = exp_current;
+					}
+				}
+
+				// exact when both the mantissa and the power of ten are representable.
+				if (digits <= 19 && mantissa <= (std::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+				{
+					auto result = static_cast<double>(mantissa);
+					result = exponent < 0 ? result / power_of_ten(-exponent) : result * power_of_ten(exponent);
+					value = negative ? -result : result;
+				}
+				else
+				{
+					value = parse_double_slow(first, current);
+				}
+				first = current;
+				return true;
+#endif
+			}
+
+			/**
+			* Format a double with round trip precision into buffer, independent of the C locale.
+			*/
+			inline int format_double(char *buffer, std::size_t size, const double value)
+			{
+				auto length = std::snprintf(buffer, size, "%.17g", value);
+				auto decimal_point = std::localeconv()->decimal_point;
+				if (decimal_point != nullptr && decimal_point[0] != '.' && decimal_point[0] != '\0')
+				{
+					for (auto i = 0; i < length; i++)
+					{
+						if (buffer[i] == decimal_point[0]) buffer[i] = '.';
+					}
+				}
+				return length;
+			}
+
+			template<typename PointType>
+			void read_header(const mapped_file &file, point_file_header &header)
+			{
+				if (file.size() < sizeof(point_file_header))
+				{
+					throw std::runtime_error("File is too small to be a point file.");
+				}
+				std::memcpy(&header, file.data(), sizeof(point_file_header));
+				if (std::memcmp(header.magic, point_file_magic, sizeof(header.magic)) != 0)
+				{
+					throw std::runtime_error("Not a delaunaypp point file.");
+				}
+				if (header.version != point_file_version)
+				{
+					throw std::runtime_error("Unsupported point file version.");
+				}
+				if (header.dimension < PointType::dimension())
+				{
+					throw std::runtime_error("Point file dimension is smaller than the point dimension.");
+				}
+				// by division, since the size the header claims may not fit in a std::size_t.
+				if (header.dimension == 0 || header.count > (file.size() - sizeof(point_file_header)) / (header.dimension * sizeof(double)))
+				{
+					throw std::runtime_error("Point file is truncated.");
+				}
+			}
+		}
+
+		/**
+		* Memory mapped view of a binary point file. Points are decoded on access straight from the mapping,
+		* so iterating the view (e.g. to construct a delaunay object) does not need an intermediate buffer.
+		*/
+		template<typename PointType, typename T = typename PointType::value_type>
+		class mapped_points
+		{
+		public:
+			/**
+			* Random access over the decoded points. Like std::vector<bool>, dereferencing yields the point by value
+			* rather than a reference into the file, so the iterator meets the random access requirements apart
+			* from the type of reference.
+			*/
+			class const_iterator
+			{
+			public:
+				using iterator_category = std::random_access_iterator_tag;
+				using value_type = PointType;
+				using difference_type = std::ptrdiff_t;
+				using pointer = const PointType*;
+				using reference = PointType;
+
+				const_iterator() = default;
+				const_iterator(const mapped_points *points, std::size_t index) : points_(points), index_(index) {}
+
+				PointType operator*() const { return (*points_)[index_]; }
+				PointType operator[](difference_type offset) const { return (*points_)[index_ + offset]; }
+				const_iterator& operator++() { ++index_; return *this; }
+				const_iterator operator++(int) { auto copy = *this; ++index_; return copy; }
+				const_iterator& operator--() { --index_; return *this; }
+				const_iterator operator--(int) { auto copy = *this; --index_; return copy; }
+				const_iterator& operator+=(difference_type offset) { index_ += offset; return *this; }
+				const_iterator& operator-=(difference_type offset) { index_ -= offset; return *this; }
+				const_iterator operator+(difference_type offset) const { return const_iterator(points_, index_ + offset); }
+				const_iterator operator-(difference_type offset) const { return const_iterator(points_, index_ - offset); }
+				difference_type operator-(const const_iterator &other) const
+				{
+					return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+				}
+				bool operator==(const const_iterator &other) const { return index_ == other.index_; }
+				bool operator!=(const const_iterator &other) const { return index_ != other.index_; }
+				bool operator<(const const_iterator &other) const { return index_ < other.index_; }
+				bool operator>(const const_iterator &other) const { return index_ > other.index_; }
+				bool operator<=(const const_iterator &other) const { return index_ <= other.index_; }
+				bool operator>=(const const_iterator &other) const { return index_ >= other.index_; }
+				friend const_iterator operator+(difference_type offset, const const_iterator &iterator) { return iterator + offset; }
+			private:
+				const mapped_points *points_ = nullptr;
+				std::size_t index_ = 0;
+			};
+
+			explicit mapped_points(const std::string &path);
+
+			std::size_t size() const;
+			std::size_t dimension() const;
+			PointType operator[](const std::size_t &index) const;
+			const_iterator begin() const;
+			const_iterator end() const;
+
+		private:
+			mapped_file file_;
+			point_file_header header_;
+			const char *data_;
+		};
+
+		template <typename PointType, typename T>
+		mapped_points<PointType, T>::mapped_points(const std::string& path) :
+			file_(path), header_(), data_(nullptr)
+		{
+			internal::read_header<PointType>(file_, header_);
+			data_ = file_.data() + sizeof(point_file_header);
+		}
+
+		template <typename PointType, typename T>
+		std::size_t mapped_points<PointType, T>::size() const
+		{
+			return static_cast<std::size_t>(header_.count);
+		}
+
+		template <typename PointType, typename T>
+		std::size_t mapped_points<PointType, T>::dimension() const
+		{
+			return header_.dimension;
+		}
+
+		template <typename PointType, typename T>
+		PointType mapped_points<PointType, T>::operator[](const std::size_t& index) const
+		{
+			PointType point;
+			auto source = data_ + index * header_.dimension * sizeof(double);
+			for (std::size_t i = 0; i < PointType::dimension(); i++)
+			{
+				double value;
+				std::memcpy(&value, source + i * sizeof(double), sizeof(double));
+				point[i] = static_cast<T>(value);
+			}
+			return point;
+		}
+
+		template <typename PointType, typename T>
+		typename mapped_points<PointType, T>::const_iterator mapped_points<PointType, T>::begin() const
+		{
+			return const_iterator(this, 0);
+		}
+
+		template <typename PointType, typename T>
+		typename mapped_points<PointType, T>::const_iterator mapped_points<PointType, T>::end() const
+		{
+			return const_iterator(this, size());
+		}
+
+		/**
+		* Write points to the binary point format.
+		*/
+		template<typename Iterator, typename PointType = typename std::iterator_traits<Iterator>::value_type>
+		void write_binary_points(const std::string &path, Iterator begin, Iterator end)
+		{
+			point_file_header header{};
+			std::memcpy(header.magic, point_file_magic, sizeof(header.magic));
+			header.version = point_file_version;
+			header.dimension = static_cast<std::uint32_t>(PointType::dimension());
+			header.count = static_cast<std::uint64_t>(std::distance(begin, end));
+
+			file_writer writer(path);
+			writer.write_value(header);
+			for (auto itr = begin; itr != end; ++itr)
+			{
+				const auto &point = *itr;
+				for (std::size_t i = 0; i < PointType::dimension(); i++)
+				{
+					writer.write_value(static_cast<double>(point[i]));
+				}
+			}
+			writer.close();
+		}
+
+		template<typename PointType>
+		void write_binary_points(const std::string &path, const std::vector<PointType> &points)
+		{
+			write_binary_points(path, points.begin(), points.end());
+		}
+
+		/**
+		* Parse whitespace (or comma) separated text with one point per line. Extra columns are ignored,
+		* blank lines are skipped.
+		*/
+		template<typename PointType, typename T = typename PointType::value_type>
+		std::vector<PointType> parse_text_points(const char *first, const char *last)
+		{
+			std::vector<PointType> points;
+			// rough guess so the vector does not have to grow too often.
+			points.reserve(static_cast<std::size_t>(last - first) / 16);
+
+			auto current = first;
+			while (current != last)
+			{
+				auto line_end = static_cast<const char*>(std::memchr(current, '\n', static_cast<std::size_t>(last - current)));
+				if (line_end == nullptr)
+				{
+					line_end = last;
+				}
+
+				PointType point;
+				std::size_t read = 0;
+				while (read < PointType::dimension())
+				{
+					while (current != line_end && internal::is_space(*current)) ++current;
+					if (current == line_end)
+					{
+						break;
+					}
+					double value;
+					if (!internal::parse_double(current, line_end, value))
+					{
+						throw std::runtime_error("Invalid number in point data.");
+					}
+					point[read++] = static_cast<T>(value);
+				}
+
+				if (read == PointType::dimension())
+				{
+					points.push_back(point);
+				}
+				else if (read != 0)
+				{
+					throw std::runtime_error("Not enough coordinates in point data.");
+				}
+				current = line_end == last ? last : line_end + 1;
+			}
+			return points;
+		}
+
+		template<typename PointType>
+		std::vector<PointType> read_text_points(const std::string &path)
+		{
+			mapped_file file(path);
+			return parse_text_points<PointType>(file.data(), file.data() + file.size());
+		}
+
+		/**
+		* Write points as tab separated text, one point per line, with full round trip precision.
+		*/
+		template<typename Iterator, typename PointType = typename std::iterator_traits<Iterator>::value_type>
+		void write_text_points(const std::string &path, Iterator begin, Iterator end)
+		{
+			file_writer writer(path);
+			char buffer[32];
+			for (auto itr = begin; itr != end; ++itr)
+			{
+				const auto &point = *itr;
+				for (std::size_t i = 0; i < PointType::dimension(); i++)
+				{
+					auto length = internal::format_double(buffer, sizeof(buffer), static_cast<double>(point[i]));
+					writer.write(buffer, static_cast<std::size_t>(length));
+					writer.write(i + 1 < PointType::dimension() ? "\t" : "\n", 1);
+				}
+			}
+			writer.close();
+		}
+
+		template<typename PointType>
+		void write_text_points(const std::string &path, const std::vector<PointType> &points)
+		{
+			write_text_points(path, points.begin(), points.end());
+		}
+	}
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+#include "mesh.h"
+
+namespace delaunaypp
+{
+	/**
+	* Constrained Delaunay triangulation of a polygon with holes. The vertices are the points of the outer ring
+	* followed by those of every hole in order, and the triangles are returned as corner triples indexing into
+	* them, counter clockwise. Rings may be given in either orientation and may touch at vertices; a point
+	* repeated by several rings is used by its first occurrence.
+	*
+	* All ring points are triangulated, the ring edges are forced in as constraints and the triangles are then
+	* classified by a flood fill from the outside over the triangle adjacency: crossing a ring edge flips between
+	* outside and inside. The fill visits every triangle once, so the classification is linear, and islands
+	* inside holes come out right as well.
+	*/
+	template<typename PointType, typename T = typename PointType::value_type>
+	std::vector<std::size_t> triangulate_polygon(const std::vector<PointType> &outer,
+		const std::vector<std::vector<PointType>> &holes = std::vector<std::vector<PointType>>())
+	{
+		if (outer.size() < 3)
+		{
+			throw std::runtime_error("The outer ring needs at least three points.");
+		}
+		std::vector<PointType> points(outer);
+		std::vector<std::size_t> starts{ 0, outer.size() };
+		for (const auto &hole : holes)
+		{
+			if (hole.size() < 3)
+			{
+				throw std::runtime_error("A hole needs at least three points.");
+			}
+			points.insert(points.end(), hole.begin(), hole.end());
+			starts.push_back(points.size());
+		}
+
+		// insert in random rounds, since ring points lie on curves, remembering which vertex stands for a
+		// repeated point.
+		mesh<PointType, T> cdt(points);
+		std::vector<std::size_t> representative(points.size(), invalid_index);
+		for (const auto &index : internal::brio_order(points))
+		{
+			representative[index] = cdt.insert(index);
+		}
+		if (cdt.finite_triangle_count() == 0)
+		{
+			throw std::runtime_error("The rings must not be collinear.");
+		}
+		for (std::size_t index = 0; index < points.size(); index++)
+		{
+			if (cdt.is_inserted(representative[index]))
+			{
+				continue;
+			}
+			// a repeated point among the first few, which waited for the first triangle.
+			const auto t = cdt.locate(points[index]);
+			for (std::size_t k = 0; k < 3; k++)
+			{
+				if (cdt.origin(3 * t + k) != infinite_vertex && cdt.vertex(cdt.origin(3 * t + k)) == points[index])
+				{
+					representative[index] = cdt.origin(3 * t + k);
+				}
+			}
+		}
+		for (std::size_t ring = 0; ring + 1 < starts.size(); ring++)
+		{
+			for (auto i = starts[ring]; i < starts[ring + 1]; i++)
+			{
+				const auto a = representative[i];
+				const auto b = representative[i + 1 < starts[ring + 1] ? i + 1 : starts[ring]];
+				if (a != b)
+				{
+					cdt.constrain(a, b);
+				}
+			}
+		}
+
+		// breadth first over the parity: neighbours across an ordinary edge have the same depth and go to the
+		// front, neighbours across a ring edge are one deeper and go to the back.
+		const auto &triangles = cdt.triangles();
+		std::vector<std::size_t> depth(cdt.triangle_count(), invalid_index);
+		std::deque<std::size_t> queue{};
+		for (std::size_t t = 0; t < cdt.triangle_count(); t++)
+		{
+			if (cdt.is_ghost(t))
+			{
+				depth[t] = 0;
+				queue.push_back(t);
+			}
+		}
+		while (!queue.empty())
+		{
+			const auto t = queue.front();
+			queue.pop_front();
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				const auto e = 3 * t + i;
+				const auto neighbour = cdt.twin(e) / 3;
+				const auto constrained = cdt.is_constrained(e);
+				const auto reached = depth[t] + (constrained ? 1 : 0);
+				if (depth[neighbour] != invalid_index && depth[neighbour] <= reached)
+				{
+					continue;
+				}
+				depth[neighbour] = reached;
+				if (constrained)
+				{
+					queue.push_back(neighbour);
+				}
+				else
+				{
+					queue.push_front(neighbour);
+				}
+			}
+		}
+
+		std::vector<std::size_t> result{};
+		result.reserve(3 * cdt.finite_triangle_count());
+		for (std::size_t t = 0; t < cdt.triangle_count(); t++)
+		{
+			if (depth[t] % 2 == 1)
+			{
+				result.insert(result.end(), triangles.begin() + 3 * t, triangles.begin() + 3 * t + 3);
+			}
+		}
+		return result;
+	}
+}
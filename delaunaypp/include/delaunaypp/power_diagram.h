@@ -0,0 +1,82 @@
+#pragma once
+#include <cmath>
+#include <vector>
+
+#include "geometry.h"
+#include "mesh.h"
+#include "point.h"
+
+namespace delaunaypp
+{
+	/**
+	* Power diagram of a weighted mesh, read off its regular triangulation. Every triangle is a vertex of the
+	* diagram: centers[t] is the power center of finite triangle t, and for a ghost triangle the outward unit
+	* normal of its hull edge, the direction of an unbounded cell edge. The cell of vertex v is the polygon
+	* centers[cells[offsets[v]]] ... centers[cells[offsets[v + 1] - 1]] in counter clockwise order. Cells of
+	* hull vertices are unbounded and start and end with a ghost triangle; redundant vertices have empty cells.
+	*/
+	struct power_diagram
+	{
+		std::vector<point<double>> centers;
+		std::vector<std::size_t> offsets;
+		std::vector<std::size_t> cells;
+	};
+
+	/**
+	* Extract the power diagram of a mesh in linear time. For an unweighted mesh this is the Voronoi diagram.
+	*/
+	template<typename PointType, typename T>
+	power_diagram extract_power_diagram(const mesh<PointType, T> &mesh)
+	{
+		power_diagram diagram{};
+		const auto &triangles = mesh.triangles();
+		diagram.centers.reserve(mesh.triangle_count());
+		for (std::size_t t = 0; t < mesh.triangle_count(); t++)
+		{
+			const auto a = triangles[3 * t], b = triangles[3 * t + 1], c = triangles[3 * t + 2];
+			if (!mesh.is_ghost(t))
+			{
+				diagram.centers.push_back(power_center(mesh.vertex(a), mesh.weight(a), mesh.vertex(b), mesh.weight(b),
+					mesh.vertex(c), mesh.weight(c)));
+				continue;
+			}
+			// the hull edge x->y runs clockwise, so the outside is on its left.
+			const auto x = a == infinite_vertex ? b : b == infinite_vertex ? c : a;
+			const auto y = a == infinite_vertex ? c : b == infinite_vertex ? a : b;
+			const auto dx = static_cast<double>(mesh.vertex(y).x()) - static_cast<double>(mesh.vertex(x).x());
+			const auto dy = static_cast<double>(mesh.vertex(y).y()) - static_cast<double>(mesh.vertex(x).y());
+			const auto length = std::sqrt(dx * dx + dy * dy);
+			diagram.centers.emplace_back(-dy / length, dx / length);
+		}
+
+		diagram.offsets.assign(mesh.vertex_count() + 1, 0);
+		diagram.cells.reserve(triangles.size());
+		for (std::size_t v = 0; v < mesh.vertex_count(); v++)
+		{
+			const auto start = mesh.vertex_edge(v);
+			if (start != invalid_index)
+			{
+				// turn counter clockwise around v. On the hull, begin at the second of the two ghosts.
+				auto first = start;
+				auto e = start;
+				do
+				{
+					if (mesh.is_ghost(e / 3) && mesh.is_ghost(mesh.next(mesh.twin(e)) / 3))
+					{
+						first = e;
+						break;
+					}
+					e = mesh.twin(mesh.prev(e));
+				} while (e != start);
+				e = first;
+				do
+				{
+					diagram.cells.push_back(e / 3);
+					e = mesh.twin(mesh.prev(e));
+				} while (e != first);
+			}
+			diagram.offsets[v + 1] = diagram.cells.size();
+		}
+		return diagram;
+	}
+}
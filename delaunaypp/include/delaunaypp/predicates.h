@@ -0,0 +1,687 @@
+#pragma once
+#include <cmath>
+#include <vector>
+
+namespace delaunaypp
+{
+	/**
+	* Robust geometric predicates. Each predicate is first evaluated in plain floating point; when the result
+	* is too close to zero to trust, it is recomputed exactly with floating point expansions
+	* (after J. R. Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates").
+	*/
+	namespace predicates
+	{
+		namespace internal
+		{
+			constexpr double epsilon = 1.1102230246251565e-16;
+			constexpr double splitter = 134217729.0;
+			constexpr double ccw_error_bound = (3.0 + 16.0 * epsilon) * epsilon;
+			constexpr double incircle_error_bound = (10.0 + 96.0 * epsilon) * epsilon;
+			constexpr double orient3d_error_bound = (7.0 + 56.0 * epsilon) * epsilon;
+			constexpr double insphere_error_bound = (16.0 + 224.0 * epsilon) * epsilon;
+			// incircle's bound plus the rounding of the weight differences, with room to spare.
+			constexpr double power_error_bound = (16.0 + 224.0 * epsilon) * epsilon;
+
+			inline void fast_two_sum(const double a, const double b, double &x, double &y)
+			{
+				x = a + b;
+				auto b_virtual = x - a;
+				y = b - b_virtual;
+			}
+
+			inline void two_sum(const double a, const double b, double &x, double &y)
+			{
+				x = a + b;
+				auto b_virtual = x - a;
+				auto a_virtual = x - b_virtual;
+				auto b_round = b - b_virtual;
+				auto a_round = a - a_virtual;
+				y = a_round + b_round;
+			}
+
+			inline void two_diff(const double a, const double b, double &x, double &y)
+			{
+				x = a - b;
+				auto b_virtual = a - x;
+				auto a_virtual = x + b_virtual;
+				auto b_round = b_virtual - b;
+				auto a_round = a - a_virtual;
+				y = a_round + b_round;
+			}
+
+			inline void split(const double a, double &high, double &low)
+			{
+				auto c = splitter * a;
+				auto a_big = c - a;
+				high = c - a_big;
+				low = a - high;
+			}
+
+			inline void two_product(const double a, const double b, double &x, double &y)
+			{
+				x = a * b;
+				double a_high, a_low, b_high, b_low;
+				split(a, a_high, a_low);
+				split(b, b_high, b_low);
+				auto error1 = x - (a_high * b_high);
+				auto error2 = error1 - (a_low * b_high);
+				auto error3 = error2 - (a_high * b_low);
+				y = (a_low * b_low) - error3;
+			}
+
+			/**
+			* h = e + f, with zero components removed. Returns the length of h (at most elen + flen).
+			*/
+			inline int expansion_sum(const int elen, const double *e, const int flen, const double *f, double *h)
+			{
+				auto e_now = e[0];
+				auto f_now = f[0];
+				auto e_index = 0;
+				auto f_index = 0;
+				double q, q_new, hh;
+				if ((f_now > e_now) == (f_now > -e_now))
+				{
+					q = e_now;
+					e_now = ++e_index < elen ? e[e_index] : 0.0;
+				}
+				else
+				{
+					q = f_now;
+					f_now = ++f_index < flen ? f[f_index] : 0.0;
+				}
+				auto h_index = 0;
+				if (e_index < elen && f_index < flen)
+				{
+					if ((f_now > e_now) == (f_now > -e_now))
+					{
+						fast_two_sum(e_now, q, q_new, hh);
+						e_now = ++e_index < elen ? e[e_index] : 0.0;
+					}
+					else
+					{
+						fast_two_sum(f_now, q, q_new, hh);
+						f_now = ++f_index < flen ? f[f_index] : 0.0;
+					}
+					q = q_new;
+					if (hh != 0.0) h[h_index++] = hh;
+					while (e_index < elen && f_index < flen)
+					{
+						if ((f_now > e_now) == (f_now > -e_now))
+						{
+							two_sum(q, e_now, q_new, hh);
+							e_now = ++e_index < elen ? e[e_index] : 0.0;
+						}
+						else
+						{
+							two_sum(q, f_now, q_new, hh);
+							f_now = ++f_index < flen ? f[f_index] : 0.0;
+						}
+						q = q_new;
+						if (hh != 0.0) h[h_index++] = hh;
+					}
+				}
+				while (e_index < elen)
+				{
+					two_sum(q, e_now, q_new, hh);
+					e_now = ++e_index < elen ? e[e_index] : 0.0;
+					q = q_new;
+					if (hh != 0.0) h[h_index++] = hh;
+				}
+				while (f_index < flen)
+				{
+					two_sum(q, f_now, q_new, hh);
+					f_now = ++f_index < flen ? f[f_index] : 0.0;
+					q = q_new;
+					if (hh != 0.0) h[h_index++] = hh;
+				}
+				if (q != 0.0 || h_index == 0) h[h_index++] = q;
+				return h_index;
+			}
+
+			/**
+			* h = e * b, with zero components removed. Returns the length of h (at most 2 * elen).
+			*/
+			inline int scale_expansion(const int elen, const double *e, const double b, double *h)
+			{
+				double q, hh, product1, product0, sum;
+				two_product(e[0], b, q, hh);
+				auto h_index = 0;
+				if (hh != 0.0) h[h_index++] = hh;
+				for (auto e_index = 1; e_index < elen; e_index++)
+				{
+					two_product(e[e_index], b, product1, product0);
+					two_sum(q, product0, sum, hh);
+					if (hh != 0.0) h[h_index++] = hh;
+					fast_two_sum(product1, sum, q, hh);
+					if (hh != 0.0) h[h_index++] = hh;
+				}
+				if (q != 0.0 || h_index == 0) h[h_index++] = q;
+				return h_index;
+			}
+
+			/**
+			* h = e * f. scale needs room for 2 * elen values and sum for 2 * elen * flen values.
+			* Returns the length of h (at most 2 * elen * flen).
+			*/
+			inline int expansion_product(const int elen, const double *e, const int flen, const double *f,
+				double *h, double *scale, double *sum)
+			{
+				auto length = scale_expansion(elen, e, f[0], h);
+				for (auto i = 1; i < flen; i++)
+				{
+					auto scale_length = scale_expansion(elen, e, f[i], scale);
+					auto sum_length = expansion_sum(length, h, scale_length, scale, sum);
+					for (auto j = 0; j < sum_length; j++) h[j] = sum[j];
+					length = sum_length;
+				}
+				return length;
+			}
+
+			inline void negate(const int elen, double *e)
+			{
+				for (auto i = 0; i < elen; i++) e[i] = -e[i];
+			}
+
+			// ab - cd for two term expansions a, b, c, d.
+			inline int cross_difference(const double *a, const double *b, const double *c, const double *d, double *h)
+			{
+				double left[8], right[8], scale[4];
+				auto left_length = scale_expansion(2, a, b[0], left);
+				auto right_length = scale_expansion(2, a, b[1], scale);
+				double buffer[8];
+				left_length = expansion_sum(left_length, left, right_length, scale, buffer);
+				for (auto i = 0; i < left_length; i++) left[i] = buffer[i];
+
+				right_length = scale_expansion(2, c, d[0], right);
+				auto tail_length = scale_expansion(2, c, d[1], scale);
+				right_length = expansion_sum(right_length, right, tail_length, scale, buffer);
+				for (auto i = 0; i < right_length; i++) right[i] = buffer[i];
+
+				negate(right_length, right);
+				return expansion_sum(left_length, left, right_length, right, h);
+			}
+
+			inline double orient2d_exact(const double ax, const double ay, const double bx, const double by,
+				const double cx, const double cy)
+			{
+				double acx[2], acy[2], bcx[2], bcy[2];
+				two_diff(ax, cx, acx[1], acx[0]);
+				two_diff(ay, cy, acy[1], acy[0]);
+				two_diff(bx, cx, bcx[1], bcx[0]);
+				two_diff(by, cy, bcy[1], bcy[0]);
+
+				double det[16];
+				auto length = cross_difference(acx, bcy, acy, bcx, det);
+				return det[length - 1];
+			}
+
+			inline double incircle_exact(const double ax, const double ay, const double bx, const double by,
+				const double cx, const double cy, const double dx, const double dy)
+			{
+				double adx[2], ady[2], bdx[2], bdy[2], cdx[2], cdy[2];
+				two_diff(ax, dx, adx[1], adx[0]);
+				two_diff(ay, dy, ady[1], ady[0]);
+				two_diff(bx, dx, bdx[1], bdx[0]);
+				two_diff(by, dy, bdy[1], bdy[0]);
+				two_diff(cx, dx, cdx[1], cdx[0]);
+				two_diff(cy, dy, cdy[1], cdy[0]);
+
+				double bc[16], ca[16], ab[16];
+				auto bc_length = cross_difference(bdx, cdy, cdx, bdy, bc);
+				auto ca_length = cross_difference(cdx, ady, adx, cdy, ca);
+				auto ab_length = cross_difference(adx, bdy, bdx, ady, ab);
+
+				// lift = x^2 + y^2 of each (translated) point.
+				double lift[3][16];
+				int lift_length[3];
+				const double *xs[3] = { adx, bdx, cdx };
+				const double *ys[3] = { ady, bdy, cdy };
+				for (auto i = 0; i < 3; i++)
+				{
+					double xx[8], yy[8], scale[4], sum[8];
+					auto xx_length = expansion_product(2, xs[i], 2, xs[i], xx, scale, sum);
+					auto yy_length = expansion_product(2, ys[i], 2, ys[i], yy, scale, sum);
+					lift_length[i] = expansion_sum(xx_length, xx, yy_length, yy, lift[i]);
+				}
+
+				double terms[3][512];
+				int term_length[3];
+				const double *minors[3] = { bc, ca, ab };
+				const int minor_length[3] = { bc_length, ca_length, ab_length };
+				for (auto i = 0; i < 3; i++)
+				{
+					double scale[32], sum[512];
+					term_length[i] = expansion_product(minor_length[i], minors[i], lift_length[i], lift[i],
+						terms[i], scale, sum);
+				}
+
+				double partial[1024], det[1536];
+				auto partial_length = expansion_sum(term_length[0], terms[0], term_length[1], terms[1], partial);
+				auto length = expansion_sum(partial_length, partial, term_length[2], terms[2], det);
+				return det[length - 1];
+			}
+
+			/**
+			* Heap allocated expansion for the exact 3D predicates, whose worst case sizes are too large for
+			* fixed stack buffers. It is only used once the floating point filter failed.
+			*/
+			class expansion
+			{
+			public:
+				expansion(const double value = 0.0)
+					:terms_(1, value)
+				{
+				}
+
+				static expansion difference(const double a, const double b)
+				{
+					expansion result;
+					result.terms_.resize(2);
+					two_diff(a, b, result.terms_[1], result.terms_[0]);
+					return result;
+				}
+
+				expansion operator+(const expansion &other) const
+				{
+					expansion result;
+					result.terms_.resize(terms_.size() + other.terms_.size());
+					result.terms_.resize(expansion_sum(static_cast<int>(terms_.size()), terms_.data(),
+						static_cast<int>(other.terms_.size()), other.terms_.data(), result.terms_.data()));
+					return result;
+				}
+
+				expansion operator-(const expansion &other) const
+				{
+					auto negated = other;
+					negate(static_cast<int>(negated.terms_.size()), negated.terms_.data());
+					return *this + negated;
+				}
+
+				expansion operator*(const expansion &other) const
+				{
+					expansion result;
+					std::vector<double> scale(2 * terms_.size());
+					std::vector<double> sum(2 * terms_.size() * other.terms_.size());
+					result.terms_.resize(sum.size());
+					result.terms_.resize(expansion_product(static_cast<int>(terms_.size()), terms_.data(),
+						static_cast<int>(other.terms_.size()), other.terms_.data(), result.terms_.data(), scale.data(), sum.data()));
+					return result;
+				}
+
+				// the largest component carries the sign.
+				double estimate() const
+				{
+					return terms_.back();
+				}
+
+			private:
+				std::vector<double> terms_;
+			};
+
+			inline double orient3d_exact(const double *a, const double *b, const double *c, const double *d)
+			{
+				expansion ad[3], bd[3], cd[3];
+				for (auto i = 0; i < 3; i++)
+				{
+					ad[i] = expansion::difference(a[i], d[i]);
+					bd[i] = expansion::difference(b[i], d[i]);
+					cd[i] = expansion::difference(c[i], d[i]);
+				}
+				auto det = ad[2] * (bd[0] * cd[1] - cd[0] * bd[1]) + bd[2] * (cd[0] * ad[1] - ad[0] * cd[1]) +
+					cd[2] * (ad[0] * bd[1] - bd[0] * ad[1]);
+				return -det.estimate();
+			}
+
+			inline double insphere_exact(const double *a, const double *b, const double *c, const double *d, const double *e)
+			{
+				expansion ae[3], be[3], ce[3], de[3];
+				for (auto i = 0; i < 3; i++)
+				{
+					ae[i] = expansion::difference(a[i], e[i]);
+					be[i] = expansion::difference(b[i], e[i]);
+					ce[i] = expansion::difference(c[i], e[i]);
+					de[i] = expansion::difference(d[i], e[i]);
+				}
+				auto ab = ae[0] * be[1] - be[0] * ae[1];
+				auto bc = be[0] * ce[1] - ce[0] * be[1];
+				auto cd = ce[0] * de[1] - de[0] * ce[1];
+				auto da = de[0] * ae[1] - ae[0] * de[1];
+				auto ac = ae[0] * ce[1] - ce[0] * ae[1];
+				auto bd = be[0] * de[1] - de[0] * be[1];
+
+				auto abc = ae[2] * bc - be[2] * ac + ce[2] * ab;
+				auto bcd = be[2] * cd - ce[2] * bd + de[2] * bc;
+				auto cda = ce[2] * da + de[2] * ac + ae[2] * cd;
+				auto dab = de[2] * ab + ae[2] * bd + be[2] * da;
+
+				auto a_lift = ae[0] * ae[0] + ae[1] * ae[1] + ae[2] * ae[2];
+				auto b_lift = be[0] * be[0] + be[1] * be[1] + be[2] * be[2];
+				auto c_lift = ce[0] * ce[0] + ce[1] * ce[1] + ce[2] * ce[2];
+				auto d_lift = de[0] * de[0] + de[1] * de[1] + de[2] * de[2];
+
+				auto det = (d_lift * abc - c_lift * dab) + (b_lift * cda - a_lift * bcd);
+				return -det.estimate();
+			}
+
+			inline double power_test_exact(const double ax, const double ay, const double aw, const double bx, const double by,
+				const double bw, const double cx, const double cy, const double cw, const double dx, const double dy, const double dw)
+			{
+				const auto adx = expansion::difference(ax, dx), ady = expansion::difference(ay, dy);
+				const auto bdx = expansion::difference(bx, dx), bdy = expansion::difference(by, dy);
+				const auto cdx = expansion::difference(cx, dx), cdy = expansion::difference(cy, dy);
+				const auto a_lift = adx * adx + ady * ady - expansion::difference(aw, dw);
+				const auto b_lift = bdx * bdx + bdy * bdy - expansion::difference(bw, dw);
+				const auto c_lift = cdx * cdx + cdy * cdy - expansion::difference(cw, dw);
+				auto det = a_lift * (bdx * cdy - cdx * bdy) + b_lift * (cdx * ady - adx * cdy) + c_lift * (adx * bdy - bdx * ady);
+				return det.estimate();
+			}
+		}
+
+		/**
+		* Positive if a, b and c are in counter clockwise order, negative if clockwise and zero if collinear.
+		*/
+		inline double orient2d(const double ax, const double ay, const double bx, const double by,
+			const double cx, const double cy)
+		{
+			auto det_left = (ax - cx) * (by - cy);
+			auto det_right = (ay - cy) * (bx - cx);
+			auto det = det_left - det_right;
+			double det_sum;
+			if (det_left > 0.0)
+			{
+				if (det_right <= 0.0) return det;
+				det_sum = det_left + det_right;
+			}
+			else if (det_left < 0.0)
+			{
+				if (det_right >= 0.0) return det;
+				det_sum = -det_left - det_right;
+			}
+			else
+			{
+				return det;
+			}
+
+			auto error_bound = internal::ccw_error_bound * det_sum;
+			if (det >= error_bound || -det >= error_bound)
+			{
+				return det;
+			}
+			return internal::orient2d_exact(ax, ay, bx, by, cx, cy);
+		}
+
+		/**
+		* Positive if d lies inside the circle through a, b and c (given in counter clockwise order),
+		* negative if outside and zero if the four points are cocircular.
+		*/
+		inline double incircle(const double ax, const double ay, const double bx, const double by,
+			const double cx, const double cy, const double dx, const double dy)
+		{
+			auto adx = ax - dx;
+			auto bdx = bx - dx;
+			auto cdx = cx - dx;
+			auto ady = ay - dy;
+			auto bdy = by - dy;
+			auto cdy = cy - dy;
+
+			auto bdx_cdy = bdx * cdy;
+			auto cdx_bdy = cdx * bdy;
+			auto a_lift = adx * adx + ady * ady;
+
+			auto cdx_ady = cdx * ady;
+			auto adx_cdy = adx * cdy;
+			auto b_lift = bdx * bdx + bdy * bdy;
+
+			auto adx_bdy = adx * bdy;
+			auto bdx_ady = bdx * ady;
+			auto c_lift = cdx * cdx + cdy * cdy;
+
+			auto det = a_lift * (bdx_cdy - cdx_bdy)
+				+ b_lift * (cdx_ady - adx_cdy)
+				+ c_lift * (adx_bdy - bdx_ady);
+
+			auto permanent = (std::fabs(bdx_cdy) + std::fabs(cdx_bdy)) * a_lift
+				+ (std::fabs(cdx_ady) + std::fabs(adx_cdy)) * b_lift
+				+ (std::fabs(adx_bdy) + std::fabs(bdx_ady)) * c_lift;
+			auto error_bound = internal::incircle_error_bound * permanent;
+			if (det > error_bound || -det > error_bound)
+			{
+				return det;
+			}
+			return internal::incircle_exact(ax, ay, bx, by, cx, cy, dx, dy);
+		}
+
+		/**
+		* Positive if d lies on the side of the plane through a, b and c from which a, b and c appear counter
+		* clockwise, negative on the other side and zero if the four points are coplanar. This is six times the
+		* signed volume of the tetrahedron abcd.
+		*/
+		inline double orient3d(const double *a, const double *b, const double *c, const double *d)
+		{
+			auto adx = a[0] - d[0];
+			auto bdx = b[0] - d[0];
+			auto cdx = c[0] - d[0];
+			auto ady = a[1] - d[1];
+			auto bdy = b[1] - d[1];
+			auto cdy = c[1] - d[1];
+			auto adz = a[2] - d[2];
+			auto bdz = b[2] - d[2];
+			auto cdz = c[2] - d[2];
+
+			auto bdx_cdy = bdx * cdy;
+			auto cdx_bdy = cdx * bdy;
+			auto cdx_ady = cdx * ady;
+			auto adx_cdy = adx * cdy;
+			auto adx_bdy = adx * bdy;
+			auto bdx_ady = bdx * ady;
+
+			auto det = adz * (bdx_cdy - cdx_bdy) + bdz * (cdx_ady - adx_cdy) + cdz * (adx_bdy - bdx_ady);
+			auto permanent = (std::fabs(bdx_cdy) + std::fabs(cdx_bdy)) * std::fabs(adz)
+				+ (std::fabs(cdx_ady) + std::fabs(adx_cdy)) * std::fabs(bdz)
+				+ (std::fabs(adx_bdy) + std::fabs(bdx_ady)) * std::fabs(cdz);
+			auto error_bound = internal::orient3d_error_bound * permanent;
+			if (det > error_bound || -det > error_bound)
+			{
+				return -det;
+			}
+			return internal::orient3d_exact(a, b, c, d);
+		}
+
+		/**
+		* Positive if e lies inside the sphere through a, b, c and d, negative if outside and zero if the five
+		* points are cospherical. The sign is reversed when orient3d(a, b, c, d) is negative.
+		*/
+		inline double insphere(const double *a, const double *b, const double *c, const double *d, const double *e)
+		{
+			auto aex = a[0] - e[0];
+			auto bex = b[0] - e[0];
+			auto cex = c[0] - e[0];
+			auto dex = d[0] - e[0];
+			auto aey = a[1] - e[1];
+			auto bey = b[1] - e[1];
+			auto cey = c[1] - e[1];
+			auto dey = d[1] - e[1];
+			auto aez = a[2] - e[2];
+			auto bez = b[2] - e[2];
+			auto cez = c[2] - e[2];
+			auto dez = d[2] - e[2];
+
+			auto aex_bey = aex * bey;
+			auto bex_aey = bex * aey;
+			auto bex_cey = bex * cey;
+			auto cex_bey = cex * bey;
+			auto cex_dey = cex * dey;
+			auto dex_cey = dex * cey;
+			auto dex_aey = dex * aey;
+			auto aex_dey = aex * dey;
+			auto aex_cey = aex * cey;
+			auto cex_aey = cex * aey;
+			auto bex_dey = bex * dey;
+			auto dex_bey = dex * bey;
+
+			auto ab = aex_bey - bex_aey;
+			auto bc = bex_cey - cex_bey;
+			auto cd = cex_dey - dex_cey;
+			auto da = dex_aey - aex_dey;
+			auto ac = aex_cey - cex_aey;
+			auto bd = bex_dey - dex_bey;
+
+			auto abc = aez * bc - bez * ac + cez * ab;
+			auto bcd = bez * cd - cez * bd + dez * bc;
+			auto cda = cez * da + dez * ac + aez * cd;
+			auto dab = dez * ab + aez * bd + bez * da;
+
+			auto a_lift = aex * aex + aey * aey + aez * aez;
+			auto b_lift = bex * bex + bey * bey + bez * bez;
+			auto c_lift = cex * cex + cey * cey + cez * cez;
+			auto d_lift = dex * dex + dey * dey + dez * dez;
+
+			auto det = (d_lift * abc - c_lift * dab) + (b_lift * cda - a_lift * bcd);
+
+			auto aez_plus = std::fabs(aez);
+			auto bez_plus = std::fabs(bez);
+			auto cez_plus = std::fabs(cez);
+			auto dez_plus = std::fabs(dez);
+			auto ab_plus = std::fabs(aex_bey) + std::fabs(bex_aey);
+			auto bc_plus = std::fabs(bex_cey) + std::fabs(cex_bey);
+			auto cd_plus = std::fabs(cex_dey) + std::fabs(dex_cey);
+			auto da_plus = std::fabs(dex_aey) + std::fabs(aex_dey);
+			auto ac_plus = std::fabs(aex_cey) + std::fabs(cex_aey);
+			auto bd_plus = std::fabs(bex_dey) + std::fabs(dex_bey);
+			auto permanent = (cd_plus * bez_plus + bd_plus * cez_plus + bc_plus * dez_plus) * a_lift
+				+ (da_plus * cez_plus + ac_plus * dez_plus + cd_plus * aez_plus) * b_lift
+				+ (ab_plus * dez_plus + bd_plus * aez_plus + da_plus * bez_plus) * c_lift
+				+ (bc_plus * aez_plus + ac_plus * bez_plus + ab_plus * cez_plus) * d_lift;
+			auto error_bound = internal::insphere_error_bound * permanent;
+			if (det > error_bound || -det > error_bound)
+			{
+				return -det;
+			}
+			return internal::insphere_exact(a, b, c, d, e);
+		}
+
+		/**
+		* Weighted incircle test for the regular triangulation: positive if the weighted point (d, dw) is closer in
+		* power distance to the orthogonal circle of (a, aw), (b, bw) and (c, cw), given counter clockwise, than
+		* those points are, so that it destroys the triangle abc; negative if it does not and zero in the
+		* degenerate case. With all weights equal this is incircle.
+		*/
+		inline double power_test(const double ax, const double ay, const double aw, const double bx, const double by,
+			const double bw, const double cx, const double cy, const double cw, const double dx, const double dy, const double dw)
+		{
+			auto adx = ax - dx;
+			auto bdx = bx - dx;
+			auto cdx = cx - dx;
+			auto ady = ay - dy;
+			auto bdy = by - dy;
+			auto cdy = cy - dy;
+			auto adw = aw - dw;
+			auto bdw = bw - dw;
+			auto cdw = cw - dw;
+
+			auto bdx_cdy = bdx * cdy;
+			auto cdx_bdy = cdx * bdy;
+			auto a_square = adx * adx + ady * ady;
+
+			auto cdx_ady = cdx * ady;
+			auto adx_cdy = adx * cdy;
+			auto b_square = bdx * bdx + bdy * bdy;
+
+			auto adx_bdy = adx * bdy;
+			auto bdx_ady = bdx * ady;
+			auto c_square = cdx * cdx + cdy * cdy;
+
+			auto det = (a_square - adw) * (bdx_cdy - cdx_bdy)
+				+ (b_square - bdw) * (cdx_ady - adx_cdy)
+				+ (c_square - cdw) * (adx_bdy - bdx_ady);
+
+			auto permanent = (std::fabs(bdx_cdy) + std::fabs(cdx_bdy)) * (a_square + std::fabs(adw))
+				+ (std::fabs(cdx_ady) + std::fabs(adx_cdy)) * (b_square + std::fabs(bdw))
+				+ (std::fabs(adx_bdy) + std::fabs(bdx_ady)) * (c_square + std::fabs(cdw));
+			auto error_bound = internal::power_error_bound * permanent;
+			if (det > error_bound || -det > error_bound)
+			{
+				return det;
+			}
+			return internal::power_test_exact(ax, ay, aw, bx, by, bw, cx, cy, cw, dx, dy, dw);
+		}
+
+		/**
+		* The power test on a line: positive if the weighted point (p, pw), which must be collinear with a and b,
+		* destroys the edge between (a, aw) and (b, bw), negative if it does not and zero in the degenerate case.
+		* Unweighted, a point destroys the edge when it lies strictly between a and b. Always exact; it is only
+		* needed for points on the hull line.
+		*/
+		inline double power_test(const double ax, const double ay, const double aw, const double bx, const double by,
+			const double bw, const double px, const double py, const double pw)
+		{
+			using internal::expansion;
+			const auto pax = expansion::difference(px, ax), pay = expansion::difference(py, ay);
+			const auto pbx = expansion::difference(px, bx), pby = expansion::difference(py, by);
+			const auto abx = expansion::difference(bx, ax), aby = expansion::difference(by, ay);
+			// with p = a + t (b - a): u = t |ab|^2, v = (1 - t) |ab|^2.
+			const auto u = pax * abx + pay * aby;
+			const auto v = expansion(0.0) - (pbx * abx + pby * aby);
+			const auto length = abx * abx + aby * aby;
+			auto det = u * v + length * expansion(pw) - v * expansion(aw) - u * expansion(bw);
+			return det.estimate();
+		}
+
+		template<typename PointType>
+		double orient2d(const PointType &a, const PointType &b, const PointType &c)
+		{
+			return orient2d(static_cast<double>(a.x()), static_cast<double>(a.y()),
+				static_cast<double>(b.x()), static_cast<double>(b.y()),
+				static_cast<double>(c.x()), static_cast<double>(c.y()));
+		}
+
+		template<typename PointType>
+		double incircle(const PointType &a, const PointType &b, const PointType &c, const PointType &d)
+		{
+			return incircle(static_cast<double>(a.x()), static_cast<double>(a.y()),
+				static_cast<double>(b.x()), static_cast<double>(b.y()),
+				static_cast<double>(c.x()), static_cast<double>(c.y()),
+				static_cast<double>(d.x()), static_cast<double>(d.y()));
+		}
+
+		template<typename PointType>
+		double orient3d(const PointType &a, const PointType &b, const PointType &c, const PointType &d)
+		{
+			const double pa[3] = { static_cast<double>(a[0]), static_cast<double>(a[1]), static_cast<double>(a[2]) };
+			const double pb[3] = { static_cast<double>(b[0]), static_cast<double>(b[1]), static_cast<double>(b[2]) };
+			const double pc[3] = { static_cast<double>(c[0]), static_cast<double>(c[1]), static_cast<double>(c[2]) };
+			const double pd[3] = { static_cast<double>(d[0]), static_cast<double>(d[1]), static_cast<double>(d[2]) };
+			return orient3d(pa, pb, pc, pd);
+		}
+
+		template<typename PointType>
+		double insphere(const PointType &a, const PointType &b, const PointType &c, const PointType &d, const PointType &e)
+		{
+			const double pa[3] = { static_cast<double>(a[0]), static_cast<double>(a[1]), static_cast<double>(a[2]) };
+			const double pb[3] = { static_cast<double>(b[0]), static_cast<double>(b[1]), static_cast<double>(b[2]) };
+			const double pc[3] = { static_cast<double>(c[0]), static_cast<double>(c[1]), static_cast<double>(c[2]) };
+			const double pd[3] = { static_cast<double>(d[0]), static_cast<double>(d[1]), static_cast<double>(d[2]) };
+			const double pe[3] = { static_cast<double>(e[0]), static_cast<double>(e[1]), static_cast<double>(e[2]) };
+			return insphere(pa, pb, pc, pd, pe);
+		}
+
+		template<typename PointType>
+		double power_test(const PointType &a, const double &aw, const PointType &b, const double &bw, const PointType &c,
+			const double &cw, const PointType &d, const double &dw)
+		{
+			return power_test(static_cast<double>(a.x()), static_cast<double>(a.y()), aw,
+				static_cast<double>(b.x()), static_cast<double>(b.y()), bw,
+				static_cast<double>(c.x()), static_cast<double>(c.y()), cw,
+				static_cast<double>(d.x()), static_cast<double>(d.y()), dw);
+		}
+
+		template<typename PointType>
+		double power_test(const PointType &a, const double &aw, const PointType &b, const double &bw, const PointType &p,
+			const double &pw)
+		{
+			return power_test(static_cast<double>(a.x()), static_cast<double>(a.y()), aw,
+				static_cast<double>(b.x()), static_cast<double>(b.y()), bw,
+				static_cast<double>(p.x()), static_cast<double>(p.y()), pw);
+		}
+	}
+}
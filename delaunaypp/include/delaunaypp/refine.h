@@ -0,0 +1,426 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "geometry.h"
+#include "mesh.h"
+
+namespace delaunaypp
+{
+	/**
+	* Quality bounds for refine().
+	*/
+	struct refinement_options
+	{
+		// smallest allowed angle in degrees, zero to disable. Termination is guaranteed up to about 20.7
+		// degrees as long as the hull has no corner sharper than 60 degrees; larger bounds usually work up to
+		// about 33 degrees.
+		double min_angle = 20.0;
+
+		// largest allowed triangle area, zero to disable.
+		double max_area = 0.0;
+
+		// stop after this many Steiner points were inserted.
+		std::size_t max_steiner_points = std::numeric_limits<std::size_t>::max();
+	};
+
+	namespace internal
+	{
+		/**
+		* Ruppert's Delaunay refinement where the only segments are the convex hull edges. Bad triangles wait
+		* in a bucketed priority queue, worst first, and are removed by inserting their circumcenter. Circumcenters
+		* that would encroach upon a hull edge split that edge at its midpoint instead. Every insertion is an
+		* ordinary Delaunay insertion except for hull edge splits, which keep the hull edges fixed.
+		*/
+		template<typename PointType, typename T>
+		class refiner
+		{
+		public:
+			using MeshType = mesh<PointType, T>;
+
+			refiner(MeshType &mesh, const refinement_options &options);
+			std::size_t refine();
+
+		private:
+			struct bad_triangle
+			{
+				double priority;
+				std::size_t triangle;
+				std::size_t vertices[3];
+			};
+
+			// a hull edge as the halfedge of its finite triangle. The end points detect stale entries.
+			struct hull_edge
+			{
+				std::size_t halfedge;
+				std::size_t start;
+				std::size_t end;
+			};
+
+			MeshType &mesh_;
+			refinement_options options_;
+			double ratio_bound_ = 0.0;
+			// bad triangles bucketed by priority. Buckets are stacks, so triangles created by the last insertion
+			// come next and the refinement stays in cache.
+			std::vector<std::vector<bad_triangle>> bad_triangles_;
+			std::size_t top_bucket_ = 0;
+			std::vector<hull_edge> encroached_;
+			std::vector<std::uint32_t> marks_;
+			std::uint32_t stamp_ = 0;
+			std::vector<std::size_t> stack_;
+			std::size_t inserted_ = 0;
+
+			void push_bad(const bad_triangle &bad);
+			bool pop_bad(bad_triangle &bad);
+			void check_triangle(const std::size_t &triangle);
+			void check_hull_edges(const std::size_t &triangle);
+			void check_recent();
+			bool is_hull_edge(const std::size_t &halfedge) const;
+			bool is_current(const bad_triangle &bad) const;
+			bool encroaches(const point<double> &center, const std::size_t &start);
+			bool split_encroached();
+			bool split_hull_edge(const hull_edge &edge);
+			void push_hull_edge(const std::size_t &halfedge);
+		};
+
+		template <typename PointType, typename T>
+		refiner<PointType, T>::refiner(MeshType& mesh, const refinement_options& options)
+			:mesh_(mesh), options_(options)
+		{
+			if (options.min_angle >= 60.0)
+			{
+				throw std::runtime_error("Minimum angle must be smaller than 60 degrees.");
+			}
+			// Steiner points go in with plain insert(), which neither weighs them nor respects constrained edges.
+			if (mesh.is_weighted())
+			{
+				throw std::runtime_error("Refining a weighted mesh is not supported.");
+			}
+			if (mesh.is_constrained())
+			{
+				throw std::runtime_error("Refining a constrained mesh is not supported.");
+			}
+			if (options.min_angle > 0.0)
+			{
+				// a triangle's smallest angle is below the bound when circumradius / shortest edge exceeds
+				// 1 / (2 sin(min_angle)). Both sides are compared squared.
+				auto sine = std::sin(options.min_angle * 3.14159265358979323846 / 180.0);
+				ratio_bound_ = 1.0 / (4.0 * sine * sine);
+			}
+		}
+
+		template <typename PointType, typename T>
+		std::size_t refiner<PointType, T>::refine()
+		{
+			for (std::size_t t = 0; t < mesh_.triangle_count(); t++)
+			{
+				if (!mesh_.is_ghost(t))
+				{
+					check_triangle(t);
+					check_hull_edges(t);
+				}
+			}
+
+			while (inserted_ < options_.max_steiner_points)
+			{
+				// encroached hull edges go first so that circumcenters always fall inside the hull.
+				split_encroached();
+				bad_triangle bad;
+				if (inserted_ >= options_.max_steiner_points || !pop_bad(bad))
+				{
+					break;
+				}
+				if (!is_current(bad))
+				{
+					continue;
+				}
+				const auto &triangles = mesh_.triangles();
+				auto center = circumcenter(mesh_.vertex(bad.vertices[0]), mesh_.vertex(bad.vertices[1]), mesh_.vertex(bad.vertices[2]));
+				const PointType steiner(static_cast<T>(center.x()), static_cast<T>(center.y()));
+				auto located = mesh_.locate(steiner, bad.triangle);
+				if (mesh_.is_ghost(located))
+				{
+					// only rounding puts a circumcenter outside the hull; split the hull edge it lies beyond.
+					for (std::size_t i = 0; i < 3; i++)
+					{
+						auto e = 3 * located + i;
+						if (triangles[e] != infinite_vertex && triangles[MeshType::next(e)] != infinite_vertex)
+						{
+							push_hull_edge(mesh_.twin(e));
+						}
+					}
+					if (split_encroached())
+					{
+						push_bad(bad);
+					}
+					continue;
+				}
+				if (mesh_.vertex(triangles[3 * located]) == steiner || mesh_.vertex(triangles[3 * located + 1]) == steiner ||
+					mesh_.vertex(triangles[3 * located + 2]) == steiner)
+				{
+					continue;
+				}
+				if (encroaches(center, located))
+				{
+					// the triangle is tried again once the hull edges are split, unless none could be.
+					if (split_encroached())
+					{
+						push_bad(bad);
+					}
+					continue;
+				}
+
+				auto vertex = mesh_.add_vertex(steiner);
+				mesh_.insert(vertex, located);
+				inserted_++;
+				check_recent();
+			}
+			return inserted_;
+		}
+
+		template <typename PointType, typename T>
+		void refiner<PointType, T>::push_bad(const bad_triangle& bad)
+		{
+			// eight buckets per doubling of the priority.
+			auto bucket = std::min(std::log2(bad.priority) * 8.0, 255.0);
+			auto index = static_cast<std::size_t>(std::max(bucket, 0.0));
+			if (bad_triangles_.size() <= index)
+			{
+				bad_triangles_.resize(index + 1);
+			}
+			bad_triangles_[index].push_back(bad);
+			top_bucket_ = std::max(top_bucket_, index);
+		}
+
+		template <typename PointType, typename T>
+		bool refiner<PointType, T>::pop_bad(bad_triangle& bad)
+		{
+			while (top_bucket_ < bad_triangles_.size())
+			{
+				auto &bucket = bad_triangles_[top_bucket_];
+				if (!bucket.empty())
+				{
+					bad = bucket.back();
+					bucket.pop_back();
+					return true;
+				}
+				if (top_bucket_ == 0)
+				{
+					break;
+				}
+				top_bucket_--;
+			}
+			return false;
+		}
+
+		template <typename PointType, typename T>
+		void refiner<PointType, T>::check_triangle(const std::size_t& triangle)
+		{
+			const auto &triangles = mesh_.triangles();
+			bad_triangle bad;
+			bad.triangle = triangle;
+			bad.vertices[0] = triangles[3 * triangle];
+			bad.vertices[1] = triangles[3 * triangle + 1];
+			bad.vertices[2] = triangles[3 * triangle + 2];
+			const auto &a = mesh_.vertex(bad.vertices[0]);
+			const auto &b = mesh_.vertex(bad.vertices[1]);
+			const auto &c = mesh_.vertex(bad.vertices[2]);
+
+			// a triangle is bad when the priority exceeds one.
+			bad.priority = 0.0;
+			if (ratio_bound_ > 0.0)
+			{
+				auto shortest = std::min(squared_distance(a, b), std::min(squared_distance(b, c), squared_distance(c, a)));
+				auto radius = squared_distance(circumcenter(a, b, c), a);
+				bad.priority = radius / (shortest * ratio_bound_);
+			}
+			if (options_.max_area > 0.0)
+			{
+				bad.priority = std::max(bad.priority, signed_area(a, b, c) / options_.max_area);
+			}
+			if (bad.priority > 1.0)
+			{
+				push_bad(bad);
+			}
+		}
+
+		template <typename PointType, typename T>
+		void refiner<PointType, T>::check_hull_edges(const std::size_t& triangle)
+		{
+			// a Delaunay hull edge is encroached exactly when the opposite angle of its triangle is obtuse.
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				auto e = 3 * triangle + i;
+				if (!is_hull_edge(e))
+				{
+					continue;
+				}
+				const auto &a = mesh_.vertex(mesh_.origin(e));
+				const auto &b = mesh_.vertex(mesh_.origin(MeshType::next(e)));
+				const auto &c = mesh_.vertex(mesh_.origin(MeshType::prev(e)));
+				auto dot = (static_cast<double>(a.x()) - c.x()) * (static_cast<double>(b.x()) - c.x()) +
+					(static_cast<double>(a.y()) - c.y()) * (static_cast<double>(b.y()) - c.y());
+				if (dot < 0.0)
+				{
+					push_hull_edge(e);
+				}
+			}
+		}
+
+		template <typename PointType, typename T>
+		void refiner<PointType, T>::check_recent()
+		{
+			for (const auto &triangle : mesh_.recent_triangles())
+			{
+				if (!mesh_.is_ghost(triangle))
+				{
+					check_triangle(triangle);
+					check_hull_edges(triangle);
+				}
+			}
+		}
+
+		template <typename PointType, typename T>
+		bool refiner<PointType, T>::is_hull_edge(const std::size_t& halfedge) const
+		{
+			return mesh_.origin(MeshType::prev(mesh_.twin(halfedge))) == infinite_vertex;
+		}
+
+		template <typename PointType, typename T>
+		bool refiner<PointType, T>::is_current(const bad_triangle& bad) const
+		{
+			// triangle slots are reused, so the entry is stale unless the slot still holds the same vertices.
+			const auto &triangles = mesh_.triangles();
+			return triangles[3 * bad.triangle] == bad.vertices[0] &&
+				triangles[3 * bad.triangle + 1] == bad.vertices[1] &&
+				triangles[3 * bad.triangle + 2] == bad.vertices[2];
+		}
+
+		template <typename PointType, typename T>
+		bool refiner<PointType, T>::encroaches(const point<double>& center, const std::size_t& start)
+		{
+			// if no hull edge is encroached, a point inside the diametral circle of a hull edge also lies in the
+			// circumcircle of the edge's triangle. Only the edges of the cavity of the point need checking.
+			if (marks_.size() < mesh_.triangle_count())
+			{
+				marks_.resize(mesh_.triangle_count(), 0);
+			}
+			if (++stamp_ == std::numeric_limits<std::uint32_t>::max())
+			{
+				std::fill(marks_.begin(), marks_.end(), 0);
+				stamp_ = 1;
+			}
+
+			const auto &triangles = mesh_.triangles();
+			auto found = false;
+			stack_.clear();
+			stack_.push_back(start);
+			marks_[start] = stamp_;
+			while (!stack_.empty())
+			{
+				auto current = stack_.back();
+				stack_.pop_back();
+				for (std::size_t i = 0; i < 3; i++)
+				{
+					auto e = 3 * current + i;
+					if (is_hull_edge(e))
+					{
+						const auto &a = mesh_.vertex(triangles[e]);
+						const auto &b = mesh_.vertex(triangles[MeshType::next(e)]);
+						auto dot = (a.x() - center.x()) * (b.x() - center.x()) + (a.y() - center.y()) * (b.y() - center.y());
+						if (dot < 0.0)
+						{
+							push_hull_edge(e);
+							found = true;
+						}
+						continue;
+					}
+					auto neighbour = mesh_.twin(e) / 3;
+					if (marks_[neighbour] == stamp_)
+					{
+						continue;
+					}
+					marks_[neighbour] = stamp_;
+					const PointType point(static_cast<T>(center.x()), static_cast<T>(center.y()));
+					if (predicates::incircle(mesh_.vertex(triangles[3 * neighbour]), mesh_.vertex(triangles[3 * neighbour + 1]),
+						mesh_.vertex(triangles[3 * neighbour + 2]), point) > 0.0)
+					{
+						stack_.push_back(neighbour);
+					}
+				}
+			}
+			return found;
+		}
+
+		template <typename PointType, typename T>
+		bool refiner<PointType, T>::split_encroached()
+		{
+			auto split = false;
+			while (!encroached_.empty() && inserted_ < options_.max_steiner_points)
+			{
+				auto edge = encroached_.back();
+				encroached_.pop_back();
+				split = split_hull_edge(edge) || split;
+			}
+			return split;
+		}
+
+		template <typename PointType, typename T>
+		bool refiner<PointType, T>::split_hull_edge(const hull_edge& edge)
+		{
+			if (mesh_.origin(edge.halfedge) != edge.start || mesh_.origin(MeshType::next(edge.halfedge)) != edge.end ||
+				!is_hull_edge(edge.halfedge))
+			{
+				return false;
+			}
+			const auto &a = mesh_.vertex(edge.start);
+			const auto &b = mesh_.vertex(edge.end);
+			PointType midpoint(static_cast<T>(0.5 * (static_cast<double>(a.x()) + b.x())),
+				static_cast<T>(0.5 * (static_cast<double>(a.y()) + b.y())));
+
+			// a rounded midpoint outside the hull is moved back onto or just inside the edge.
+			const T inward_x = b.y() < a.y() ? std::numeric_limits<T>::max() : std::numeric_limits<T>::lowest();
+			const T inward_y = b.x() > a.x() ? std::numeric_limits<T>::max() : std::numeric_limits<T>::lowest();
+			while (predicates::orient2d(a, b, midpoint) < 0.0)
+			{
+				if (a.y() != b.y()) midpoint[0] = std::nextafter(midpoint[0], inward_x);
+				if (a.x() != b.x()) midpoint[1] = std::nextafter(midpoint[1], inward_y);
+			}
+			// the edge is too short to split, or an input point lies within rounding of the edge.
+			const auto &c = mesh_.vertex(mesh_.origin(MeshType::prev(edge.halfedge)));
+			if (midpoint == a || midpoint == b || predicates::orient2d(b, c, midpoint) <= 0.0 ||
+				predicates::orient2d(c, a, midpoint) <= 0.0)
+			{
+				return false;
+			}
+			auto vertex = mesh_.add_vertex(midpoint);
+			mesh_.split(edge.halfedge, vertex);
+			inserted_++;
+			check_recent();
+			return true;
+		}
+
+		template <typename PointType, typename T>
+		void refiner<PointType, T>::push_hull_edge(const std::size_t& halfedge)
+		{
+			encroached_.push_back({ halfedge, mesh_.origin(halfedge), mesh_.origin(MeshType::next(halfedge)) });
+		}
+	}
+
+	/**
+	* Refine a triangulated mesh by inserting Steiner points until no triangle has an angle below
+	* options.min_angle or an area above options.max_area. Returns the number of inserted points.
+	* Weighted and constrained meshes are not supported.
+	*/
+	template<typename PointType, typename T>
+	std::size_t refine(mesh<PointType, T> &mesh, const refinement_options &options = refinement_options())
+	{
+		static_assert(std::is_floating_point<T>::value, "Refinement needs floating point coordinates.");
+		internal::refiner<PointType, T> refiner(mesh, options);
+		return refiner.refine();
+	}
+}
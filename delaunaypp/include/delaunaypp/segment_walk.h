@@ -0,0 +1,347 @@
+#pragma once
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "interpolation.h"
+#include "mesh.h"
+#include "predicates.h"
+
+namespace delaunaypp
+{
+	/**
+	* A triangle passed by a segment from a to b, between the points a + entry (b - a) and a + exit (b - a).
+	*/
+	struct segment_crossing
+	{
+		std::size_t triangle;
+		double entry;
+		double exit;
+	};
+
+	/**
+	* Settings for walk_segments().
+	*/
+	struct segment_walk_options
+	{
+		// worker threads, zero for one per hardware thread. Batches smaller than parallel_threshold stay on the
+		// calling thread.
+		std::size_t threads = 1;
+		std::size_t parallel_threshold = 1 << 12;
+	};
+
+	/**
+	* Crossings of many segments in one buffer. The crossings of segment s are crossings[offsets[s]] ...
+	* crossings[offsets[s + 1] - 1].
+	*/
+	struct segment_walks
+	{
+		std::vector<std::size_t> offsets;
+		std::vector<segment_crossing> crossings;
+	};
+
+	namespace internal
+	{
+		/**
+		* Straight walk along a segment, after Devillers, Pion and Teillaud. Every step decides on which side of
+		* the line through the segment the corners of the current triangle lie, exactly, and leaves the triangle
+		* either through the inside of an edge, into the neighbour across it, or through a corner on the line,
+		* turning around that vertex to the triangle the segment goes on into. A segment running along an edge
+		* passes the triangle left of it. Only the entry and exit parameters are rounded.
+		*/
+		template<typename MeshType, typename PointType>
+		class segment_walker
+		{
+		public:
+			segment_walker(const MeshType &mesh, const PointType &from, const PointType &to);
+
+			template<typename Visitor>
+			std::size_t walk(std::size_t hint, Visitor visitor);
+
+		private:
+			const MeshType &mesh_;
+			const PointType &from_;
+			const PointType &to_;
+			double dx_;
+			double dy_;
+			double length_;
+
+			double parameter(const PointType &point) const;
+			double crossing(const PointType &u, const PointType &v) const;
+			bool contains_end(const std::size_t &triangle) const;
+			std::size_t turn(const std::size_t &vertex) const;
+		};
+
+		template <typename MeshType, typename PointType>
+		segment_walker<MeshType, PointType>::segment_walker(const MeshType& mesh, const PointType& from, const PointType& to)
+			:mesh_(mesh), from_(from), to_(to),
+			dx_(static_cast<double>(to.x()) - static_cast<double>(from.x())),
+			dy_(static_cast<double>(to.y()) - static_cast<double>(from.y())),
+			length_(dx_ * dx_ + dy_ * dy_)
+		{
+		}
+
+		/**
+		* Walk from the triangle of the start, located from hint, and hand each crossing to visitor. Returns the
+		* triangle the start lies in, or invalid_index when it is outside the convex hull.
+		*/
+		template <typename MeshType, typename PointType>
+		template <typename Visitor>
+		std::size_t segment_walker<MeshType, PointType>::walk(std::size_t hint, Visitor visitor)
+		{
+			if (mesh_.finite_triangle_count() == 0)
+			{
+				return invalid_index;
+			}
+			const auto start = mesh_.locate(from_, hint);
+			if (mesh_.is_ghost(start))
+			{
+				return invalid_index;
+			}
+			if (length_ == 0.0)
+			{
+				visitor(segment_crossing{ start, 0.0, 1.0 });
+				return start;
+			}
+
+			const auto &triangles = mesh_.triangles();
+			auto current = start;
+			auto entry = 0.0;
+			auto corner = invalid_index;
+			// the halfedge of the current triangle the segment came in through, if it crossed an edge.
+			auto entered = invalid_index;
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				corner = mesh_.vertex(triangles[3 * start + i]) == from_ ? triangles[3 * start + i] : corner;
+			}
+			while (true)
+			{
+				if (corner != invalid_index)
+				{
+					// leaving through a vertex: go on in the triangle around it that the segment enters.
+					current = turn(corner);
+					corner = invalid_index;
+					entered = invalid_index;
+					if (current == invalid_index)
+					{
+						break;
+					}
+				}
+
+				auto edge = invalid_index;
+				auto finished = false;
+				if (entered != invalid_index)
+				{
+					// the entry edge runs from left of the line to right of it, so the opposite corner alone
+					// decides the exit, and the end lies in the triangle unless it is beyond the exit edge.
+					const auto opposite = triangles[MeshType::prev(entered)];
+					const auto side = predicates::orient2d(from_, to_, mesh_.vertex(opposite));
+					if (side != 0.0)
+					{
+						edge = side > 0.0 ? MeshType::next(entered) : MeshType::prev(entered);
+						finished = predicates::orient2d(mesh_.vertex(triangles[edge]), mesh_.vertex(triangles[MeshType::next(edge)]), to_) >= 0.0;
+					}
+					else
+					{
+						corner = opposite;
+						finished = contains_end(current);
+					}
+				}
+				else if (!(finished = contains_end(current)))
+				{
+					// sides of the corners: left of the line is positive.
+					double sides[3];
+					for (std::size_t i = 0; i < 3; i++)
+					{
+						sides[i] = predicates::orient2d(from_, to_, mesh_.vertex(triangles[3 * current + i]));
+					}
+					for (std::size_t i = 0; i < 3 && edge == invalid_index && corner == invalid_index; i++)
+					{
+						const auto j = (i + 1) % 3;
+						const auto k = (i + 2) % 3;
+						if (sides[i] < 0.0 && sides[j] > 0.0)
+						{
+							// out through the inside of the edge from the corner right of the line to the one left of it.
+							edge = 3 * current + i;
+						}
+						else if (sides[i] == 0.0 && sides[j] > 0.0 && sides[k] < 0.0)
+						{
+							// in through the opposite edge, out through this corner.
+							corner = triangles[3 * current + i];
+						}
+						else if (sides[i] == 0.0 && sides[j] == 0.0)
+						{
+							// along an edge, out through its corner further ahead.
+							const auto a = triangles[3 * current + i];
+							const auto b = triangles[3 * current + j];
+							corner = parameter(mesh_.vertex(a)) > parameter(mesh_.vertex(b)) ? a : b;
+						}
+					}
+					if (edge == invalid_index && corner == invalid_index)
+					{
+						// the segment only touches the triangle at a corner, which is where it starts.
+						for (std::size_t i = 0; i < 3; i++)
+						{
+							corner = sides[i] == 0.0 ? triangles[3 * current + i] : corner;
+						}
+						if (corner == invalid_index)
+						{
+							break;
+						}
+						continue;
+					}
+				}
+				if (finished)
+				{
+					visitor(segment_crossing{ current, entry, 1.0 });
+					break;
+				}
+
+				auto exit = edge != invalid_index ? crossing(mesh_.vertex(triangles[edge]), mesh_.vertex(triangles[MeshType::next(edge)])) :
+					parameter(mesh_.vertex(corner));
+				exit = std::min(1.0, std::max(entry, exit));
+				if (exit > entry)
+				{
+					visitor(segment_crossing{ current, entry, exit });
+				}
+				entry = exit;
+				if (edge != invalid_index)
+				{
+					entered = mesh_.twin(edge);
+					current = entered / 3;
+					if (mesh_.is_ghost(current))
+					{
+						break;
+					}
+				}
+			}
+			return start;
+		}
+
+		template <typename MeshType, typename PointType>
+		double segment_walker<MeshType, PointType>::parameter(const PointType& point) const
+		{
+			return ((static_cast<double>(point.x()) - static_cast<double>(from_.x())) * dx_ +
+				(static_cast<double>(point.y()) - static_cast<double>(from_.y())) * dy_) / length_;
+		}
+
+		/**
+		* Parameter of the intersection with the line through u and v.
+		*/
+		template <typename MeshType, typename PointType>
+		double segment_walker<MeshType, PointType>::crossing(const PointType& u, const PointType& v) const
+		{
+			const auto ex = static_cast<double>(v.x()) - static_cast<double>(u.x());
+			const auto ey = static_cast<double>(v.y()) - static_cast<double>(u.y());
+			const auto ux = static_cast<double>(u.x()) - static_cast<double>(from_.x());
+			const auto uy = static_cast<double>(u.y()) - static_cast<double>(from_.y());
+			return (ux * ey - uy * ex) / (dx_ * ey - dy_ * ex);
+		}
+
+		template <typename MeshType, typename PointType>
+		bool segment_walker<MeshType, PointType>::contains_end(const std::size_t& triangle) const
+		{
+			const auto &triangles = mesh_.triangles();
+			const auto &a = mesh_.vertex(triangles[3 * triangle]);
+			const auto &b = mesh_.vertex(triangles[3 * triangle + 1]);
+			const auto &c = mesh_.vertex(triangles[3 * triangle + 2]);
+			return predicates::orient2d(a, b, to_) >= 0.0 && predicates::orient2d(b, c, to_) >= 0.0 &&
+				predicates::orient2d(c, a, to_) >= 0.0;
+		}
+
+		/**
+		* The finite triangle around the vertex whose angle holds the direction of the segment, with the edge
+		* on its right included; invalid_index when the segment leaves the hull there.
+		*/
+		template <typename MeshType, typename PointType>
+		std::size_t segment_walker<MeshType, PointType>::turn(const std::size_t& vertex) const
+		{
+			const auto &triangles = mesh_.triangles();
+			const auto &center = mesh_.vertex(vertex);
+			const auto first = mesh_.vertex_edge(vertex);
+			auto e = first;
+			do
+			{
+				const auto a = triangles[MeshType::next(e)];
+				const auto b = triangles[MeshType::prev(e)];
+				if (a != infinite_vertex && b != infinite_vertex &&
+					predicates::orient2d(center, mesh_.vertex(a), to_) >= 0.0 && predicates::orient2d(center, mesh_.vertex(b), to_) < 0.0)
+				{
+					return e / 3;
+				}
+				e = mesh_.twin(MeshType::prev(e));
+			} while (e != first);
+			return invalid_index;
+		}
+	}
+
+	/**
+	* Every triangle the segment from a to b passes, in order, handed to visitor(const segment_crossing &). The
+	* walk starts at the triangle of a, located from hint, and goes from neighbour to neighbour, so it costs
+	* the number of triangles crossed and allocates nothing. It stops where the segment leaves the convex
+	* hull; a segment starting outside the hull crosses nothing. Returns the triangle of a, or invalid_index,
+	* which makes a good hint for the next segment from nearby.
+	*/
+	template<typename PointType, typename T, typename Visitor>
+	std::size_t walk_segment(const mesh<PointType, T> &mesh, const PointType &a, const PointType &b, Visitor visitor,
+		const std::size_t &hint = invalid_index)
+	{
+		internal::segment_walker<delaunaypp::mesh<PointType, T>, PointType> walker(mesh, a, b);
+		return walker.walk(hint, visitor);
+	}
+
+	/**
+	* The crossings of the segments from[s] to to[s] for all s, on several threads. Every thread walks a
+	* contiguous run of segments into its own buffer, each located from the start of the one before, so
+	* segments from a common observer or in spatial order are found at little cost.
+	*/
+	template<typename PointType, typename T>
+	segment_walks walk_segments(const mesh<PointType, T> &mesh, const std::vector<PointType> &from,
+		const std::vector<PointType> &to, const segment_walk_options &options = segment_walk_options())
+	{
+		if (from.size() != to.size())
+		{
+			throw std::runtime_error("Expected as many segment ends as starts.");
+		}
+		const auto count = from.size();
+		auto threads = options.threads > 0 ? options.threads : static_cast<std::size_t>(std::thread::hardware_concurrency());
+		threads = count < options.parallel_threshold ? 1 : std::max<std::size_t>(1, std::min(threads, count));
+		interpolation_options parallel{};
+		parallel.threads = threads;
+		parallel.parallel_threshold = 1;
+
+		segment_walks result{};
+		result.offsets.assign(count + 1, 0);
+		std::vector<std::vector<segment_crossing>> buffers(threads);
+		internal::parallel_ranges(threads, parallel, [&](std::size_t begin, std::size_t end)
+		{
+			for (auto block = begin; block < end; block++)
+			{
+				auto &buffer = buffers[block];
+				auto hint = invalid_index;
+				for (auto s = count * block / threads; s < count * (block + 1) / threads; s++)
+				{
+					const auto before = buffer.size();
+					const auto found = walk_segment(mesh, from[s], to[s], [&buffer](const segment_crossing &crossing)
+					{
+						buffer.push_back(crossing);
+					}, hint);
+					hint = found != invalid_index ? found : hint;
+					result.offsets[s + 1] = buffer.size() - before;
+				}
+			}
+		});
+
+		for (std::size_t s = 0; s < count; s++)
+		{
+			result.offsets[s + 1] += result.offsets[s];
+		}
+		result.crossings.reserve(result.offsets.back());
+		for (const auto &buffer : buffers)
+		{
+			result.crossings.insert(result.crossings.end(), buffer.begin(), buffer.end());
+		}
+		return result;
+	}
+}
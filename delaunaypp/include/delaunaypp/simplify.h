@@ -0,0 +1,387 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <vector>
+
+#include "hull.h"
+#include "mesh.h"
+#include "predicates.h"
+
+namespace delaunaypp
+{
+	/**
+	* Stopping rules for simplify(). Whichever is met first ends the simplification.
+	*/
+	struct simplification_options
+	{
+		// largest vertical distance allowed between a point and the simplified surface.
+		double max_error = 0.0;
+
+		// largest number of vertices in the simplified mesh, the convex hull included.
+		std::size_t max_vertices = std::numeric_limits<std::size_t>::max();
+	};
+
+	namespace internal
+	{
+		/**
+		* Greedy insertion after Garland and Heckbert. Every triangle owns the points that lie in it, along with
+		* the plane through its corners and the point furthest from that plane, its candidate. A heap holds the
+		* candidates, worst first; entries whose triangle changed since are recognized by a per triangle stamp and
+		* skipped. Inserting a candidate hands the points of the destroyed triangles to the new ones, which fill
+		* the same region, measuring each against its new plane on the way, so a point costs one location and one
+		* error per insertion that moves it.
+		*
+		* The points of a triangle are a range of one shared pool. Moved points go to fresh ranges at the end of
+		* the pool, which is compacted once it holds more stale entries than live ones; so nothing is allocated
+		* per triangle and the points of a triangle stay in the order they had, which keeps the walks short.
+		*/
+		template<typename PointType, typename T, typename ValueType>
+		class simplifier
+		{
+		public:
+			using MeshType = mesh<PointType, T>;
+
+			simplifier(MeshType &mesh, const std::vector<ValueType> &heights, const simplification_options &options);
+			std::size_t simplify();
+
+		private:
+			// the plane through a triangle's corners as z = z0 + gx (x - x0) + gy (y - y0).
+			struct plane
+			{
+				double x0;
+				double y0;
+				double z0;
+				double gx;
+				double gy;
+			};
+
+			struct candidate
+			{
+				double error;
+				std::size_t triangle;
+				std::uint32_t stamp;
+
+				bool operator<(const candidate &other) const
+				{
+					return error < other.error;
+				}
+			};
+
+			MeshType &mesh_;
+			const std::vector<ValueType> &heights_;
+			simplification_options options_;
+			std::vector<std::size_t> pool_;
+			std::vector<std::size_t> spare_;
+			std::size_t live_ = 0;
+			std::vector<std::size_t> begins_;
+			std::vector<std::size_t> counts_;
+			std::vector<plane> planes_;
+			std::vector<double> errors_;
+			std::vector<std::size_t> candidates_;
+			std::vector<std::uint32_t> stamps_;
+			std::vector<std::uint32_t> marks_;
+			std::uint32_t mark_ = 0;
+			std::priority_queue<candidate> queue_;
+			std::vector<std::size_t> moved_;
+			std::vector<std::size_t> targets_;
+
+			void grow();
+			void reset(const std::size_t &triangle);
+			bool contains(const std::size_t &triangle, const PointType &point) const;
+			double error(const std::size_t &triangle, const std::size_t &vertex) const;
+			std::size_t target(const std::size_t &vertex, const std::size_t &hint, const std::vector<std::size_t> &triangles) const;
+			void redistribute(const std::vector<std::size_t> &triangles);
+			void rescan(const std::size_t &triangle);
+			void compact();
+		};
+
+		template <typename PointType, typename T, typename ValueType>
+		simplifier<PointType, T, ValueType>::simplifier(MeshType& mesh, const std::vector<ValueType>& heights,
+			const simplification_options& options)
+			:mesh_(mesh), heights_(heights), options_(options)
+		{
+			if (heights.size() < mesh.vertex_count())
+			{
+				throw std::runtime_error("Expected one height per vertex.");
+			}
+		}
+
+		template <typename PointType, typename T, typename ValueType>
+		std::size_t simplifier<PointType, T, ValueType>::simplify()
+		{
+			// start from the convex hull, then hand every other point to the triangle it lies in.
+			mesh_.clear();
+			const auto hull = convex_hull(mesh_.vertices());
+			std::size_t inserted = 0;
+			for (const auto &vertex : hull)
+			{
+				mesh_.insert(vertex);
+				inserted++;
+			}
+			if (mesh_.finite_triangle_count() == 0)
+			{
+				return inserted;
+			}
+			for (std::size_t vertex = 0; vertex < mesh_.vertex_count(); vertex++)
+			{
+				if (!mesh_.is_inserted(vertex))
+				{
+					moved_.push_back(vertex);
+				}
+			}
+			std::vector<std::size_t> all(mesh_.triangle_count());
+			for (std::size_t t = 0; t < all.size(); t++)
+			{
+				all[t] = t;
+			}
+			live_ = moved_.size();
+			redistribute(all);
+
+			while (!queue_.empty() && inserted < options_.max_vertices)
+			{
+				const auto top = queue_.top();
+				if (top.stamp != stamps_[top.triangle])
+				{
+					queue_.pop();
+					continue;
+				}
+				if (top.error <= options_.max_error)
+				{
+					break;
+				}
+				queue_.pop();
+
+				// take the candidate out of its triangle; a point at the position of a vertex is dropped, which only
+				// changes the candidate of its triangle.
+				const auto vertex = candidates_[top.triangle];
+				const auto begin = pool_.begin() + begins_[top.triangle];
+				std::iter_swap(std::find(begin, begin + counts_[top.triangle], vertex), begin + counts_[top.triangle] - 1);
+				counts_[top.triangle]--;
+				live_--;
+				moved_.clear();
+				if (mesh_.insert(vertex, top.triangle) != vertex)
+				{
+					rescan(top.triangle);
+					continue;
+				}
+				inserted++;
+				redistribute(mesh_.recent_triangles());
+			}
+			return inserted;
+		}
+
+		template <typename PointType, typename T, typename ValueType>
+		void simplifier<PointType, T, ValueType>::grow()
+		{
+			const auto count = mesh_.triangle_count();
+			if (begins_.size() < count)
+			{
+				begins_.resize(count, 0);
+				counts_.resize(count, 0);
+				planes_.resize(count);
+				errors_.resize(count, -1.0);
+				candidates_.resize(count, invalid_index);
+				stamps_.resize(count, 0);
+				marks_.resize(count, 0);
+			}
+			if (++mark_ == std::numeric_limits<std::uint32_t>::max())
+			{
+				std::fill(marks_.begin(), marks_.end(), 0);
+				mark_ = 1;
+			}
+		}
+
+		template <typename PointType, typename T, typename ValueType>
+		void simplifier<PointType, T, ValueType>::reset(const std::size_t& triangle)
+		{
+			marks_[triangle] = mark_;
+			counts_[triangle] = 0;
+			errors_[triangle] = -1.0;
+			candidates_[triangle] = invalid_index;
+			if (mesh_.is_ghost(triangle))
+			{
+				return;
+			}
+			const auto &triangles = mesh_.triangles();
+			const auto &a = mesh_.vertex(triangles[3 * triangle]);
+			const auto &b = mesh_.vertex(triangles[3 * triangle + 1]);
+			const auto &c = mesh_.vertex(triangles[3 * triangle + 2]);
+			const auto ax = static_cast<double>(a.x());
+			const auto ay = static_cast<double>(a.y());
+			const auto az = static_cast<double>(heights_[triangles[3 * triangle]]);
+			const auto bx = static_cast<double>(b.x()) - ax;
+			const auto by = static_cast<double>(b.y()) - ay;
+			const auto bz = static_cast<double>(heights_[triangles[3 * triangle + 1]]) - az;
+			const auto cx = static_cast<double>(c.x()) - ax;
+			const auto cy = static_cast<double>(c.y()) - ay;
+			const auto cz = static_cast<double>(heights_[triangles[3 * triangle + 2]]) - az;
+			const auto scale = 1.0 / (bx * cy - by * cx);
+			planes_[triangle] = { ax, ay, az, (bz * cy - by * cz) * scale, (bx * cz - bz * cx) * scale };
+		}
+
+		template <typename PointType, typename T, typename ValueType>
+		bool simplifier<PointType, T, ValueType>::contains(const std::size_t& triangle, const PointType& point) const
+		{
+			if (mesh_.is_ghost(triangle))
+			{
+				return false;
+			}
+			const auto &triangles = mesh_.triangles();
+			const auto &a = mesh_.vertex(triangles[3 * triangle]);
+			const auto &b = mesh_.vertex(triangles[3 * triangle + 1]);
+			const auto &c = mesh_.vertex(triangles[3 * triangle + 2]);
+			return predicates::orient2d(a, b, point) >= 0.0 && predicates::orient2d(b, c, point) >= 0.0 &&
+				predicates::orient2d(c, a, point) >= 0.0;
+		}
+
+		template <typename PointType, typename T, typename ValueType>
+		double simplifier<PointType, T, ValueType>::error(const std::size_t& triangle, const std::size_t& vertex) const
+		{
+			const auto &point = mesh_.vertex(vertex);
+			const auto &surface = planes_[triangle];
+			return std::abs(static_cast<double>(heights_[vertex]) - surface.z0 -
+				surface.gx * (static_cast<double>(point.x()) - surface.x0) - surface.gy * (static_cast<double>(point.y()) - surface.y0));
+		}
+
+		template <typename PointType, typename T, typename ValueType>
+		std::size_t simplifier<PointType, T, ValueType>::target(const std::size_t& vertex, const std::size_t& hint,
+			const std::vector<std::size_t>& triangles) const
+		{
+			// most points lie in the triangle of the point before them.
+			const auto &point = mesh_.vertex(vertex);
+			if (hint != invalid_index && contains(hint, point))
+			{
+				return hint;
+			}
+			const auto triangle = mesh_.locate(point, hint);
+			if (marks_[triangle] == mark_ && !mesh_.is_ghost(triangle))
+			{
+				return triangle;
+			}
+			// the walk stopped outside the new triangles, so the point lies on an edge or a vertex shared with one
+			// of them. Only the new triangles get fresh ranges, so the point must go to one of them.
+			for (const auto &candidate : triangles)
+			{
+				if (contains(candidate, point))
+				{
+					return candidate;
+				}
+			}
+			throw std::runtime_error("Could not find the triangle of a point.");
+		}
+
+		template <typename PointType, typename T, typename ValueType>
+		void simplifier<PointType, T, ValueType>::redistribute(const std::vector<std::size_t>& triangles)
+		{
+			// gather the points of the old triangles, which the given ones replace, and find their new triangles.
+			grow();
+			for (const auto &triangle : triangles)
+			{
+				moved_.insert(moved_.end(), pool_.begin() + begins_[triangle], pool_.begin() + begins_[triangle] + counts_[triangle]);
+			}
+			for (const auto &triangle : triangles)
+			{
+				reset(triangle);
+			}
+			targets_.resize(moved_.size());
+			auto hint = invalid_index;
+			for (std::size_t i = 0; i < moved_.size(); i++)
+			{
+				hint = target(moved_[i], hint, triangles);
+				targets_[i] = hint;
+				counts_[hint]++;
+			}
+
+			// new ranges at the end of the pool, filled in the order the points came.
+			if (pool_.size() + moved_.size() > 2 * live_ + mesh_.triangle_count())
+			{
+				compact();
+			}
+			auto end = pool_.size();
+			for (const auto &triangle : triangles)
+			{
+				begins_[triangle] = end;
+				end += counts_[triangle];
+				counts_[triangle] = 0;
+			}
+			pool_.resize(end);
+			for (std::size_t i = 0; i < moved_.size(); i++)
+			{
+				const auto triangle = targets_[i];
+				const auto vertex = moved_[i];
+				pool_[begins_[triangle] + counts_[triangle]++] = vertex;
+				const auto distance = error(triangle, vertex);
+				if (distance > errors_[triangle])
+				{
+					errors_[triangle] = distance;
+					candidates_[triangle] = vertex;
+				}
+			}
+			for (const auto &triangle : triangles)
+			{
+				stamps_[triangle]++;
+				if (candidates_[triangle] != invalid_index)
+				{
+					queue_.push({ errors_[triangle], triangle, stamps_[triangle] });
+				}
+			}
+		}
+
+		template <typename PointType, typename T, typename ValueType>
+		void simplifier<PointType, T, ValueType>::rescan(const std::size_t& triangle)
+		{
+			// the triangle keeps its points and plane, only its candidate is looked for again.
+			errors_[triangle] = -1.0;
+			candidates_[triangle] = invalid_index;
+			for (auto i = begins_[triangle]; i < begins_[triangle] + counts_[triangle]; i++)
+			{
+				const auto distance = error(triangle, pool_[i]);
+				if (distance > errors_[triangle])
+				{
+					errors_[triangle] = distance;
+					candidates_[triangle] = pool_[i];
+				}
+			}
+			stamps_[triangle]++;
+			if (candidates_[triangle] != invalid_index)
+			{
+				queue_.push({ errors_[triangle], triangle, stamps_[triangle] });
+			}
+		}
+
+		template <typename PointType, typename T, typename ValueType>
+		void simplifier<PointType, T, ValueType>::compact()
+		{
+			// copy the live ranges of the triangles not being refilled, which are unmarked.
+			spare_.clear();
+			for (std::size_t t = 0; t < mesh_.triangle_count(); t++)
+			{
+				if (marks_[t] != mark_ && counts_[t] > 0)
+				{
+					const auto begin = spare_.size();
+					spare_.insert(spare_.end(), pool_.begin() + begins_[t], pool_.begin() + begins_[t] + counts_[t]);
+					begins_[t] = begin;
+				}
+			}
+			pool_.swap(spare_);
+		}
+	}
+
+	/**
+	* Simplify a terrain given by the vertices of the mesh and one height per vertex. The mesh is triangulated
+	* again from the convex hull of its vertices, and the point furthest from the surface, vertically, is
+	* inserted as long as it is further than options.max_error and the mesh has fewer than options.max_vertices
+	* vertices. The other vertices stay out of the mesh. Returns the number of vertices in the mesh.
+	*/
+	template<typename PointType, typename T, typename ValueType>
+	std::size_t simplify(mesh<PointType, T> &mesh, const std::vector<ValueType> &heights,
+		const simplification_options &options = simplification_options())
+	{
+		internal::simplifier<PointType, T, ValueType> simplifier(mesh, heights, options);
+		return simplifier.simplify();
+	}
+}
@@ -0,0 +1,250 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "mesh.h"
+
+namespace delaunaypp
+{
+	/**
+	* Per tick limits for sliding_window.
+	*/
+	struct window_options
+	{
+		// most expired points erased and most pushed points inserted by one advance(). The rest wait for the
+		// next ticks, oldest first.
+		std::size_t max_evictions = std::numeric_limits<std::size_t>::max();
+		std::size_t max_insertions = std::numeric_limits<std::size_t>::max();
+	};
+
+	/**
+	* What one sliding_window::advance() did.
+	*/
+	struct window_metrics
+	{
+		std::size_t inserted = 0;
+		std::size_t evicted = 0;
+		// wall clock time spent on each, in seconds.
+		double insert_seconds = 0.0;
+		double evict_seconds = 0.0;
+		// points in the mesh afterwards, counting repeated positions.
+		std::size_t size = 0;
+		// expired points still in the mesh and pushed points not in it yet, left for later ticks by the limits.
+		std::size_t eviction_backlog = 0;
+		std::size_t insertion_backlog = 0;
+		// whether erasing triangulated the window again from scratch, which takes time in its size.
+		bool rebuilt = false;
+	};
+
+	/**
+	* Delaunay triangulation of the points of a time stamped stream that are at most duration old.
+	*
+	* Points are pushed with non decreasing time stamps and enter the mesh on a later advance(now), which first
+	* erases the points that expired by then and then inserts the new ones. Both are local operations on the
+	* mesh, so the work of a tick depends on the points entering and leaving the window, not on its size, except
+	* when a star is too degenerate to fill and mesh::erase() triangulates the window again; the metrics report
+	* that as rebuilt. The options cap the points erased and inserted per tick. The rest carry over in order of
+	* arrival, so under a burst the mesh lags behind the window by the backlog the metrics report. Expired vertex
+	* indices are reused for new points. A point that repeats a position in the mesh shares its vertex, which
+	* stays until the last of them is erased. The optional metrics callback is called after every tick.
+	*/
+	template<typename PointType, typename T = typename PointType::value_type>
+	class sliding_window
+	{
+	public:
+		using MeshType = delaunaypp::mesh<PointType, T>;
+		using metrics_sink = std::function<void(const window_metrics&)>;
+
+		explicit sliding_window(const double &duration, metrics_sink metrics = metrics_sink(),
+			const window_options &options = window_options());
+
+		void push(const PointType &point, const double &timestamp);
+		window_metrics advance(const double &now);
+
+		const MeshType& mesh() const;
+		std::size_t size() const;
+		double timestamp(const std::size_t &vertex) const;
+
+	private:
+		struct queued_point
+		{
+			PointType point;
+			double timestamp;
+		};
+
+		struct live_point
+		{
+			std::size_t vertex;
+			double timestamp;
+		};
+
+		double duration_;
+		metrics_sink metrics_;
+		window_options options_;
+		MeshType mesh_;
+		double latest_ = -std::numeric_limits<double>::infinity();
+
+		// pushed points in order of arrival, waiting to be inserted.
+		std::deque<queued_point> queued_;
+		// points in the mesh in order of arrival, so the oldest expire first.
+		std::deque<live_point> live_;
+		// live points per vertex and the newest time stamp among them.
+		std::vector<std::uint32_t> references_;
+		std::vector<double> timestamps_;
+		std::vector<std::size_t> free_vertices_;
+		std::vector<std::size_t> expired_;
+		std::vector<PointType> batch_;
+		std::vector<std::size_t> vertices_;
+	};
+
+	template <typename PointType, typename T>
+	sliding_window<PointType, T>::sliding_window(const double& duration, metrics_sink metrics,
+		const window_options& options)
+		: duration_(duration), metrics_(std::move(metrics)), options_(options)
+	{
+		if (!(duration > 0.0))
+		{
+			throw std::runtime_error("The window duration must be positive.");
+		}
+		if (options.max_evictions == 0 || options.max_insertions == 0)
+		{
+			throw std::runtime_error("The window must erase and insert at least one point per tick.");
+		}
+	}
+
+	template <typename PointType, typename T>
+	void sliding_window<PointType, T>::push(const PointType& point, const double& timestamp)
+	{
+		if (timestamp < latest_)
+		{
+			throw std::runtime_error("Time stamps must not decrease.");
+		}
+		latest_ = timestamp;
+		queued_.push_back({ point, timestamp });
+	}
+
+	/**
+	* Move the window to end at now: erase the points stamped at or before now - duration and insert the pushed
+	* points that are still younger, up to the limits of the options. Pushed points that expire before their
+	* turn are dropped without touching the mesh.
+	*/
+	template <typename PointType, typename T>
+	window_metrics sliding_window<PointType, T>::advance(const double& now)
+	{
+		using clock = std::chrono::steady_clock;
+		window_metrics metrics{};
+		const auto cutoff = now - duration_;
+		const auto rebuilds = mesh_.rebuild_count();
+
+		auto start = clock::now();
+		expired_.clear();
+		while (!live_.empty() && live_.front().timestamp <= cutoff && metrics.evicted < options_.max_evictions)
+		{
+			const auto vertex = live_.front().vertex;
+			live_.pop_front();
+			metrics.evicted++;
+			if (--references_[vertex] == 0)
+			{
+				expired_.push_back(vertex);
+			}
+		}
+		mesh_.erase(expired_);
+		free_vertices_.insert(free_vertices_.end(), expired_.begin(), expired_.end());
+		metrics.rebuilt = mesh_.rebuild_count() != rebuilds;
+		metrics.evict_seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+		// insert along a Hilbert curve of the new points so that every walk is short, but keep the window in
+		// order of arrival.
+		start = clock::now();
+		while (!queued_.empty() && queued_.front().timestamp <= cutoff)
+		{
+			queued_.pop_front();
+		}
+		const auto count = std::min(queued_.size(), options_.max_insertions);
+		batch_.clear();
+		for (std::size_t i = 0; i < count; i++)
+		{
+			batch_.push_back(queued_[i].point);
+		}
+		vertices_.resize(count);
+		for (const auto &index : internal::hilbert_order(batch_))
+		{
+			std::size_t slot;
+			if (free_vertices_.empty())
+			{
+				slot = mesh_.add_vertex(batch_[index]);
+				references_.resize(mesh_.vertex_count(), 0);
+				timestamps_.resize(mesh_.vertex_count(), 0.0);
+			}
+			else
+			{
+				slot = free_vertices_.back();
+				free_vertices_.pop_back();
+				mesh_.set_vertex(slot, batch_[index]);
+			}
+			vertices_[index] = mesh_.insert(slot);
+			if (vertices_[index] != slot)
+			{
+				// the position is taken by a vertex in the mesh.
+				free_vertices_.push_back(slot);
+			}
+		}
+		for (std::size_t i = 0; i < count; i++)
+		{
+			const auto vertex = vertices_[i];
+			references_[vertex]++;
+			timestamps_[vertex] = queued_.front().timestamp;
+			live_.push_back({ vertex, queued_.front().timestamp });
+			queued_.pop_front();
+		}
+		metrics.inserted = count;
+		metrics.insert_seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+		// the window is in order of arrival, so the expired points still in it come first.
+		const auto younger = std::partition_point(live_.begin(), live_.end(), [cutoff](const live_point &live)
+		{
+			return live.timestamp <= cutoff;
+		});
+		metrics.eviction_backlog = static_cast<std::size_t>(younger - live_.begin());
+		metrics.insertion_backlog = queued_.size();
+		metrics.size = live_.size();
+		if (metrics_)
+		{
+			metrics_(metrics);
+		}
+		return metrics;
+	}
+
+	/**
+	* The triangulation of the window. Vertices that are not inserted are free for later points.
+	*/
+	template <typename PointType, typename T>
+	const typename sliding_window<PointType, T>::MeshType& sliding_window<PointType, T>::mesh() const
+	{
+		return mesh_;
+	}
+
+	/**
+	* Number of points in the mesh, counting repeated positions. Expired points count until they are erased.
+	*/
+	template <typename PointType, typename T>
+	std::size_t sliding_window<PointType, T>::size() const
+	{
+		return live_.size();
+	}
+
+	/**
+	* Time stamp of the newest point at a vertex of the window.
+	*/
+	template <typename PointType, typename T>
+	double sliding_window<PointType, T>::timestamp(const std::size_t& vertex) const
+	{
+		return timestamps_[vertex];
+	}
+}
@@ -0,0 +1,375 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fileio.h"
+#include "mesh.h"
+
+namespace delaunaypp
+{
+	namespace io
+	{
+		/**
+		* Header of the snapshot format, the complete state of a triangulation laid out so that it can be used
+		* straight from a memory mapping. It is followed by five 8 byte aligned arrays:
+		* vertex_count * dimension doubles, triangle_count * 3 vertex indices, triangle_count * 3 twin halfedges,
+		* vertex_count vertex edges and grid_columns * grid_rows location seeds, all indices 64 bit.
+		*/
+		struct snapshot_header
+		{
+			char magic[4];
+			std::uint32_t version;
+			std::uint32_t dimension;
+			std::uint32_t grid_columns;
+			std::uint32_t grid_rows;
+			std::uint32_t reserved;
+			std::uint64_t vertex_count;
+			std::uint64_t triangle_count;
+			std::uint64_t finite_triangle_count;
+			std::uint64_t infinite_edge;
+			double grid_min_x;
+			double grid_min_y;
+			double grid_cell_width;
+			double grid_cell_height;
+		};
+
+		static_assert(sizeof(snapshot_header) == 88, "Unexpected snapshot header size.");
+
+		constexpr char snapshot_magic[4] = { 'D', 'P', 'P', 'S' };
+		constexpr std::uint32_t snapshot_version = 1;
+
+		/**
+		* Read only view of an array of 64 bit indices inside a mapping.
+		*/
+		class index_array
+		{
+		public:
+			index_array() = default;
+			index_array(const std::uint64_t *data, const std::size_t &size) : data_(data), size_(size) {}
+
+			std::size_t operator[](const std::size_t &index) const { return static_cast<std::size_t>(data_[index]); }
+			std::size_t size() const { return size_; }
+			const std::uint64_t* begin() const { return data_; }
+			const std::uint64_t* end() const { return data_ + size_; }
+
+		private:
+			const std::uint64_t *data_ = nullptr;
+			std::size_t size_ = 0;
+		};
+
+		/**
+		* Write the complete state of a triangulation, including a grid of walk seeds for point location,
+		* as a snapshot that mapped_mesh opens without any decoding.
+		*/
+		template<typename PointType, typename T>
+		void write_snapshot(const std::string &path, const mesh<PointType, T> &mesh)
+		{
+			snapshot_header header{};
+			std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+			header.version = snapshot_version;
+			header.dimension = static_cast<std::uint32_t>(PointType::dimension());
+			header.vertex_count = mesh.vertex_count();
+			header.triangle_count = mesh.triangle_count();
+			header.finite_triangle_count = mesh.finite_triangle_count();
+			header.infinite_edge = mesh.vertex_edge(infinite_vertex);
+
+			// about eight triangles per grid cell over the bounding box of the inserted vertices.
+			auto min_x = std::numeric_limits<double>::infinity(), min_y = min_x;
+			auto max_x = -min_x, max_y = -min_x;
+			for (std::size_t v = 0; v < mesh.vertex_count(); v++)
+			{
+				if (!mesh.is_inserted(v)) continue;
+				min_x = std::min(min_x, static_cast<double>(mesh.vertex(v).x()));
+				min_y = std::min(min_y, static_cast<double>(mesh.vertex(v).y()));
+				max_x = std::max(max_x, static_cast<double>(mesh.vertex(v).x()));
+				max_y = std::max(max_y, static_cast<double>(mesh.vertex(v).y()));
+			}
+			std::vector<std::uint64_t> seeds{};
+			if (mesh.finite_triangle_count() > 0)
+			{
+				const auto side = std::max(1.0, std::floor(std::sqrt(static_cast<double>(mesh.finite_triangle_count()) / 8.0)));
+				header.grid_columns = static_cast<std::uint32_t>(std::min(side, 65536.0));
+				header.grid_rows = header.grid_columns;
+				header.grid_min_x = min_x;
+				header.grid_min_y = min_y;
+				header.grid_cell_width = (max_x - min_x) / header.grid_columns;
+				header.grid_cell_height = (max_y - min_y) / header.grid_rows;
+
+				// the seed of a cell is the triangle holding its center, found by walking from the previous cell
+				// in a serpentine order.
+				seeds.resize(static_cast<std::size_t>(header.grid_columns) * header.grid_rows);
+				auto hint = invalid_index;
+				for (std::size_t row = 0; row < header.grid_rows; row++)
+				{
+					for (std::size_t k = 0; k < header.grid_columns; k++)
+					{
+						const auto column = row % 2 == 0 ? k : header.grid_columns - 1 - k;
+						PointType center{};
+						center[0] = static_cast<T>(min_x + (static_cast<double>(column) + 0.5) * header.grid_cell_width);
+						center[1] = static_cast<T>(min_y + (static_cast<double>(row) + 0.5) * header.grid_cell_height);
+						hint = mesh.locate(center, hint);
+						seeds[row * header.grid_columns + column] = hint;
+					}
+				}
+			}
+
+			file_writer writer(path);
+			writer.write_value(header);
+			for (std::size_t v = 0; v < mesh.vertex_count(); v++)
+			{
+				for (std::size_t i = 0; i < PointType::dimension(); i++)
+				{
+					writer.write_value(static_cast<double>(mesh.vertex(v)[i]));
+				}
+			}
+			for (const auto &index : mesh.triangles())
+			{
+				writer.write_value(static_cast<std::uint64_t>(index));
+			}
+			for (const auto &index : mesh.halfedges())
+			{
+				writer.write_value(static_cast<std::uint64_t>(index));
+			}
+			for (std::size_t v = 0; v < mesh.vertex_count(); v++)
+			{
+				writer.write_value(static_cast<std::uint64_t>(mesh.vertex_edge(v)));
+			}
+			writer.write(seeds.data(), seeds.size() * sizeof(std::uint64_t));
+			writer.close();
+		}
+
+		/**
+		* A triangulation snapshot used in place from a memory mapping. Opening it checks the header and the
+		* file size and nothing else, so it takes the same time for any size of mesh; pages are loaded as
+		* queries touch them. Offers the read only part of the mesh interface, including point location
+		* seeded from the stored grid.
+		*/
+		template<typename PointType, typename T = typename PointType::value_type>
+		class mapped_mesh
+		{
+		public:
+			using vertex_type = PointType;
+			using value_type = T;
+
+			explicit mapped_mesh(const std::string &path);
+
+			std::size_t locate(const PointType &point, const std::size_t &hint = invalid_index) const;
+
+			std::size_t vertex_count() const;
+			std::size_t triangle_count() const;
+			std::size_t finite_triangle_count() const;
+			PointType vertex(const std::size_t &index) const;
+			const index_array& triangles() const;
+			const index_array& halfedges() const;
+			std::size_t origin(const std::size_t &halfedge) const;
+			std::size_t twin(const std::size_t &halfedge) const;
+			std::size_t vertex_edge(const std::size_t &vertex) const;
+			bool is_ghost(const std::size_t &triangle) const;
+			bool is_inserted(const std::size_t &vertex) const;
+			std::vector<std::size_t> hull() const;
+
+			static std::size_t next(const std::size_t &halfedge);
+			static std::size_t prev(const std::size_t &halfedge);
+
+		private:
+			mapped_file file_;
+			snapshot_header header_;
+			const double *vertices_ = nullptr;
+			index_array triangles_;
+			index_array halfedges_;
+			index_array vertex_edges_;
+			index_array seeds_;
+		};
+
+		template <typename PointType, typename T>
+		mapped_mesh<PointType, T>::mapped_mesh(const std::string& path)
+			: file_(path), header_()
+		{
+			if (file_.size() < sizeof(header_))
+			{
+				throw std::runtime_error("File is too small to be a snapshot.");
+			}
+			std::memcpy(&header_, file_.data(), sizeof(header_));
+			if (std::memcmp(header_.magic, snapshot_magic, sizeof(header_.magic)) != 0 || header_.version != snapshot_version)
+			{
+				throw std::runtime_error("Not a supported delaunaypp snapshot.");
+			}
+			if (header_.dimension != PointType::dimension())
+			{
+				throw std::runtime_error("Snapshot does not match the point type.");
+			}
+			// each section by division before adding up, since the sizes the header claims may not fit in a
+			// std::size_t: points, then corners and twins, then an edge per vertex and the seed grid.
+			auto rest = file_.size() - sizeof(header_);
+			auto take = [&rest](const std::uint64_t &count, const std::size_t &bytes)
+			{
+				if (count > rest / bytes)
+				{
+					throw std::runtime_error("Snapshot is truncated.");
+				}
+				rest -= static_cast<std::size_t>(count) * bytes;
+			};
+			take(header_.vertex_count, sizeof(double) * header_.dimension);
+			take(header_.triangle_count, 6 * sizeof(std::uint64_t));
+			take(header_.vertex_count, sizeof(std::uint64_t));
+			take(static_cast<std::uint64_t>(header_.grid_columns) * header_.grid_rows, sizeof(std::uint64_t));
+			if (rest != 0)
+			{
+				throw std::runtime_error("Snapshot is truncated.");
+			}
+			const auto vertex_count = static_cast<std::size_t>(header_.vertex_count);
+			const auto index_count = static_cast<std::size_t>(header_.triangle_count) * 3;
+			const auto seed_count = static_cast<std::size_t>(header_.grid_columns) * header_.grid_rows;
+
+			// the mapping is page aligned and every section is a multiple of 8 bytes long.
+			auto cursor = file_.data() + sizeof(header_);
+			vertices_ = reinterpret_cast<const double*>(cursor);
+			cursor += sizeof(double) * vertex_count * header_.dimension;
+			triangles_ = index_array(reinterpret_cast<const std::uint64_t*>(cursor), index_count);
+			cursor += sizeof(std::uint64_t) * index_count;
+			halfedges_ = index_array(reinterpret_cast<const std::uint64_t*>(cursor), index_count);
+			cursor += sizeof(std::uint64_t) * index_count;
+			vertex_edges_ = index_array(reinterpret_cast<const std::uint64_t*>(cursor), vertex_count);
+			cursor += sizeof(std::uint64_t) * vertex_count;
+			seeds_ = index_array(reinterpret_cast<const std::uint64_t*>(cursor), seed_count);
+		}
+
+		/**
+		* Triangle containing point, or the ghost of the hull edge it lies beyond. Without a hint the walk starts
+		* from the seed of the grid cell the point falls in.
+		*/
+		template <typename PointType, typename T>
+		std::size_t mapped_mesh<PointType, T>::locate(const PointType& point, const std::size_t& hint) const
+		{
+			auto start = hint;
+			if (start >= triangle_count() && seeds_.size() > 0)
+			{
+				auto cell = [](const double &offset, const double &size, const std::uint32_t &count)
+				{
+					const auto index = size > 0.0 ? std::floor(offset / size) : 0.0;
+					return static_cast<std::size_t>(std::min(std::max(index, 0.0), static_cast<double>(count - 1)));
+				};
+				const auto column = cell(static_cast<double>(point.x()) - header_.grid_min_x, header_.grid_cell_width, header_.grid_columns);
+				const auto row = cell(static_cast<double>(point.y()) - header_.grid_min_y, header_.grid_cell_height, header_.grid_rows);
+				start = seeds_[row * header_.grid_columns + column];
+			}
+			return delaunaypp::internal::walk(*this, point, start);
+		}
+
+		template <typename PointType, typename T>
+		std::size_t mapped_mesh<PointType, T>::vertex_count() const
+		{
+			return static_cast<std::size_t>(header_.vertex_count);
+		}
+
+		template <typename PointType, typename T>
+		std::size_t mapped_mesh<PointType, T>::triangle_count() const
+		{
+			return static_cast<std::size_t>(header_.triangle_count);
+		}
+
+		template <typename PointType, typename T>
+		std::size_t mapped_mesh<PointType, T>::finite_triangle_count() const
+		{
+			return static_cast<std::size_t>(header_.finite_triangle_count);
+		}
+
+		template <typename PointType, typename T>
+		PointType mapped_mesh<PointType, T>::vertex(const std::size_t& index) const
+		{
+			PointType point{};
+			for (std::size_t i = 0; i < PointType::dimension(); i++)
+			{
+				point[i] = static_cast<T>(vertices_[index * header_.dimension + i]);
+			}
+			return point;
+		}
+
+		template <typename PointType, typename T>
+		const index_array& mapped_mesh<PointType, T>::triangles() const
+		{
+			return triangles_;
+		}
+
+		template <typename PointType, typename T>
+		const index_array& mapped_mesh<PointType, T>::halfedges() const
+		{
+			return halfedges_;
+		}
+
+		template <typename PointType, typename T>
+		std::size_t mapped_mesh<PointType, T>::origin(const std::size_t& halfedge) const
+		{
+			return triangles_[halfedge];
+		}
+
+		template <typename PointType, typename T>
+		std::size_t mapped_mesh<PointType, T>::twin(const std::size_t& halfedge) const
+		{
+			return halfedges_[halfedge];
+		}
+
+		template <typename PointType, typename T>
+		std::size_t mapped_mesh<PointType, T>::vertex_edge(const std::size_t& vertex) const
+		{
+			if (vertex == infinite_vertex)
+			{
+				return static_cast<std::size_t>(header_.infinite_edge);
+			}
+			return vertex < vertex_edges_.size() ? vertex_edges_[vertex] : invalid_index;
+		}
+
+		template <typename PointType, typename T>
+		bool mapped_mesh<PointType, T>::is_ghost(const std::size_t& triangle) const
+		{
+			return triangles_[3 * triangle] == infinite_vertex ||
+				triangles_[3 * triangle + 1] == infinite_vertex ||
+				triangles_[3 * triangle + 2] == infinite_vertex;
+		}
+
+		template <typename PointType, typename T>
+		bool mapped_mesh<PointType, T>::is_inserted(const std::size_t& vertex) const
+		{
+			return vertex_edge(vertex) != invalid_index;
+		}
+
+		/**
+		* Vertex indices of the convex hull in counter clockwise order, as mesh::hull() returns them.
+		*/
+		template <typename PointType, typename T>
+		std::vector<std::size_t> mapped_mesh<PointType, T>::hull() const
+		{
+			std::vector<std::size_t> ring{};
+			const auto first = vertex_edge(infinite_vertex);
+			if (first == invalid_index)
+			{
+				return ring;
+			}
+			auto e = first;
+			do
+			{
+				ring.push_back(triangles_[next(e)]);
+				e = next(halfedges_[e]);
+			} while (e != first);
+			return ring;
+		}
+
+		template <typename PointType, typename T>
+		std::size_t mapped_mesh<PointType, T>::next(const std::size_t& halfedge)
+		{
+			return halfedge % 3 == 2 ? halfedge - 2 : halfedge + 1;
+		}
+
+		template <typename PointType, typename T>
+		std::size_t mapped_mesh<PointType, T>::prev(const std::size_t& halfedge)
+		{
+			return halfedge % 3 == 0 ? halfedge + 2 : halfedge - 1;
+		}
+	}
+}
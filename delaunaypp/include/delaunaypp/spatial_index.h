@@ -0,0 +1,271 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "mesh.h"
+#include "point.h"
+
+namespace delaunaypp
+{
+	/**
+	* Packed Hilbert R-tree over the finite triangles of a mesh, bulk loaded once. Triangles are sorted along a
+	* Hilbert curve and packed node_size to a node, level by level, into flat arrays, so queries touch a few
+	* contiguous cache lines per level and never allocate. Query results are triangle ids; the triangles are
+	* tested exactly, not just by their bounding boxes. The mesh must outlive the index and stay unchanged.
+	*/
+	template<typename PointType, typename T = typename PointType::value_type>
+	class triangle_index
+	{
+	public:
+		static constexpr std::size_t node_size = 16;
+
+		explicit triangle_index(const mesh<PointType, T> &mesh);
+
+		template<typename Visitor>
+		void visit(const double &min_x, const double &min_y, const double &max_x, const double &max_y, Visitor visitor) const;
+		template<typename Visitor>
+		void visit_radius(const double &x, const double &y, const double &radius, Visitor visitor) const;
+		void query(const double &min_x, const double &min_y, const double &max_x, const double &max_y,
+			std::vector<std::size_t> &result) const;
+		void query_radius(const double &x, const double &y, const double &radius, std::vector<std::size_t> &result) const;
+		std::size_t size() const;
+
+	private:
+		// at most node_size pending entries per level, and 17 levels hold any 64 bit count of triangles.
+		static constexpr std::size_t stack_size = 17 * node_size;
+
+		const mesh<PointType, T> &mesh_;
+		// min x, min y, max x, max y of every node, leaves first and the root last.
+		std::vector<double> boxes_;
+		// the triangle of a leaf, the first child of an inner node.
+		std::vector<std::size_t> indices_;
+		// one past the last node of every level.
+		std::vector<std::size_t> level_ends_;
+
+		template<typename Leaf, typename Visitor>
+		void search(const double &min_x, const double &min_y, const double &max_x, const double &max_y, Leaf leaf,
+			Visitor visitor) const;
+		point<double> corner(const std::size_t &triangle, const std::size_t &i) const;
+	};
+
+	template <typename PointType, typename T>
+	constexpr std::size_t triangle_index<PointType, T>::node_size;
+
+	template <typename PointType, typename T>
+	constexpr std::size_t triangle_index<PointType, T>::stack_size;
+
+	template <typename PointType, typename T>
+	triangle_index<PointType, T>::triangle_index(const mesh<PointType, T>& mesh)
+		: mesh_(mesh)
+	{
+		std::vector<std::size_t> triangles{};
+		std::vector<point<double>> centers{};
+		triangles.reserve(mesh.finite_triangle_count());
+		centers.reserve(mesh.finite_triangle_count());
+		for (std::size_t t = 0; t < mesh.triangle_count(); t++)
+		{
+			if (!mesh.is_ghost(t))
+			{
+				triangles.push_back(t);
+				const auto a = corner(t, 0), b = corner(t, 1), c = corner(t, 2);
+				centers.emplace_back((a.x() + b.x() + c.x()) / 3.0, (a.y() + b.y() + c.y()) / 3.0);
+			}
+		}
+		if (triangles.empty())
+		{
+			return;
+		}
+
+		// leaves in Hilbert order of their centroids.
+		const auto order = internal::hilbert_order(centers);
+		for (const auto &i : order)
+		{
+			const auto t = triangles[i];
+			const auto a = corner(t, 0), b = corner(t, 1), c = corner(t, 2);
+			boxes_.push_back(std::min({ a.x(), b.x(), c.x() }));
+			boxes_.push_back(std::min({ a.y(), b.y(), c.y() }));
+			boxes_.push_back(std::max({ a.x(), b.x(), c.x() }));
+			boxes_.push_back(std::max({ a.y(), b.y(), c.y() }));
+			indices_.push_back(t);
+		}
+		level_ends_.push_back(indices_.size());
+
+		// every run of node_size nodes gets a parent on the next level until one root is left.
+		std::size_t begin = 0;
+		while (level_ends_.back() - begin > 1)
+		{
+			const auto end = level_ends_.back();
+			for (auto child = begin; child < end; child += node_size)
+			{
+				auto box = &boxes_[4 * child];
+				double bounds[4] = { box[0], box[1], box[2], box[3] };
+				for (auto i = child + 1; i < std::min(end, child + node_size); i++)
+				{
+					box = &boxes_[4 * i];
+					bounds[0] = std::min(bounds[0], box[0]);
+					bounds[1] = std::min(bounds[1], box[1]);
+					bounds[2] = std::max(bounds[2], box[2]);
+					bounds[3] = std::max(bounds[3], box[3]);
+				}
+				boxes_.insert(boxes_.end(), bounds, bounds + 4);
+				indices_.push_back(child);
+			}
+			begin = end;
+			level_ends_.push_back(indices_.size());
+		}
+	}
+
+	/**
+	* Call visitor(triangle) for every triangle that intersects the rectangle.
+	*/
+	template <typename PointType, typename T>
+	template <typename Visitor>
+	void triangle_index<PointType, T>::visit(const double& min_x, const double& min_y, const double& max_x, const double& max_y,
+		Visitor visitor) const
+	{
+		search(min_x, min_y, max_x, max_y, [&](const std::size_t &triangle)
+		{
+			// separating axis test: the boxes already overlap, so only the triangle's edges can still separate.
+			// The rectangle is outside an edge when even its corner furthest to the left lies on the right.
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				const auto a = corner(triangle, i);
+				const auto b = corner(triangle, (i + 1) % 3);
+				const auto dx = b.x() - a.x(), dy = b.y() - a.y();
+				const auto x = dy < 0.0 ? max_x : min_x;
+				const auto y = dx > 0.0 ? max_y : min_y;
+				if (dx * (y - a.y()) - dy * (x - a.x()) < 0.0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}, visitor);
+	}
+
+	/**
+	* Call visitor(triangle) for every triangle within radius of (x, y).
+	*/
+	template <typename PointType, typename T>
+	template <typename Visitor>
+	void triangle_index<PointType, T>::visit_radius(const double& x, const double& y, const double& radius, Visitor visitor) const
+	{
+		const auto squared_radius = radius * radius;
+		search(x - radius, y - radius, x + radius, y + radius, [&](const std::size_t &triangle)
+		{
+			// inside the triangle, or close enough to one of its edges.
+			auto inside = true;
+			auto nearest = squared_radius + 1.0;
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				const auto a = corner(triangle, i);
+				const auto b = corner(triangle, (i + 1) % 3);
+				const auto dx = b.x() - a.x(), dy = b.y() - a.y();
+				const auto px = x - a.x(), py = y - a.y();
+				inside = inside && dx * py - dy * px >= 0.0;
+				const auto length = dx * dx + dy * dy;
+				const auto along = length > 0.0 ? std::min(1.0, std::max(0.0, (px * dx + py * dy) / length)) : 0.0;
+				const auto ex = px - along * dx, ey = py - along * dy;
+				nearest = std::min(nearest, ex * ex + ey * ey);
+			}
+			return inside || nearest <= squared_radius;
+		}, visitor);
+	}
+
+	/**
+	* Replace the contents of result with the triangles that intersect the rectangle. Reusing result across
+	* queries avoids allocation once it has grown.
+	*/
+	template <typename PointType, typename T>
+	void triangle_index<PointType, T>::query(const double& min_x, const double& min_y, const double& max_x, const double& max_y,
+		std::vector<std::size_t>& result) const
+	{
+		result.clear();
+		visit(min_x, min_y, max_x, max_y, [&result](const std::size_t &triangle) { result.push_back(triangle); });
+	}
+
+	/**
+	* Replace the contents of result with the triangles within radius of (x, y).
+	*/
+	template <typename PointType, typename T>
+	void triangle_index<PointType, T>::query_radius(const double& x, const double& y, const double& radius,
+		std::vector<std::size_t>& result) const
+	{
+		result.clear();
+		visit_radius(x, y, radius, [&result](const std::size_t &triangle) { result.push_back(triangle); });
+	}
+
+	/**
+	* Number of indexed triangles.
+	*/
+	template <typename PointType, typename T>
+	std::size_t triangle_index<PointType, T>::size() const
+	{
+		return level_ends_.empty() ? 0 : level_ends_.front();
+	}
+
+	template <typename PointType, typename T>
+	template <typename Leaf, typename Visitor>
+	void triangle_index<PointType, T>::search(const double& min_x, const double& min_y, const double& max_x, const double& max_y,
+		Leaf leaf, Visitor visitor) const
+	{
+		if (boxes_.empty())
+		{
+			return;
+		}
+
+		const auto root = indices_.size() - 1;
+		const auto root_box = &boxes_[4 * root];
+		if (root_box[0] > max_x || root_box[1] > max_y || root_box[2] < min_x || root_box[3] < min_y)
+		{
+			return;
+		}
+		if (root < size())
+		{
+			// a single triangle is its own root.
+			if (leaf(indices_[root]))
+			{
+				visitor(indices_[root]);
+			}
+			return;
+		}
+
+		// depth first from the root. The stack holds inner nodes whose box overlaps the query.
+		std::size_t stack[stack_size];
+		std::size_t top = 0;
+		stack[top++] = root;
+		while (top > 0)
+		{
+			const auto node = stack[--top];
+			const auto first = indices_[node];
+			const auto level_end = *std::upper_bound(level_ends_.begin(), level_ends_.end(), first);
+			const auto end = std::min(first + node_size, level_end);
+			for (auto child = first; child < end; child++)
+			{
+				const auto box = &boxes_[4 * child];
+				if (box[0] > max_x || box[1] > max_y || box[2] < min_x || box[3] < min_y)
+				{
+					continue;
+				}
+				if (child < size())
+				{
+					if (leaf(indices_[child]))
+					{
+						visitor(indices_[child]);
+					}
+				}
+				else
+				{
+					stack[top++] = child;
+				}
+			}
+		}
+	}
+
+	template <typename PointType, typename T>
+	point<double> triangle_index<PointType, T>::corner(const std::size_t& triangle, const std::size_t& i) const
+	{
+		const auto &vertex = mesh_.vertex(mesh_.triangles()[3 * triangle + i]);
+		return point<double>(static_cast<double>(vertex.x()), static_cast<double>(vertex.y()));
+	}
+}
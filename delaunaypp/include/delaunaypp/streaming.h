@@ -0,0 +1,681 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "geometry.h"
+#include "mesh.h"
+
+namespace delaunaypp
+{
+	/**
+	* Settings for streaming_delaunay.
+	*/
+	struct streaming_options
+	{
+		// upper bound in bytes for the live triangles and vertices kept in memory.
+		std::size_t memory_budget = std::size_t(256) << 20;
+
+		// number of points per tile, finished triangles are written out after every tile. Zero derives the
+		// tile size from the memory budget.
+		std::size_t tile_size = 0;
+
+		// optional bounds of the whole data set. With finite bounds, triangles and hull edges along the
+		// bottom, top and right side of the data can be finished before the end of the stream.
+		double min_y = -std::numeric_limits<double>::infinity();
+		double max_y = std::numeric_limits<double>::infinity();
+		double max_x = std::numeric_limits<double>::infinity();
+	};
+
+	/**
+	* Out of core Delaunay triangulation of a point stream sorted by x.
+	*
+	* Points are pushed in order of non decreasing x and consumed in tiles. After each tile every triangle whose
+	* circumcircle can no longer contain an unread point is final: it is handed to the sink as three indices
+	* into the input stream and dropped, together with the vertices no live triangle uses anymore. Only the
+	* triangles near the sweep line stay in memory. Duplicate points are skipped but keep their index.
+	* For points in general position the triangles written out are those of mesh::triangulate() on the same
+	* points. Where four or more points are cocircular the Delaunay triangulation is not unique, and the two may
+	* pick different diagonals since they insert in different orders; a repeated point may also stand for
+	* another of its copies than the one mesh::triangulate() keeps.
+	*/
+	template<typename PointType, typename T = typename PointType::value_type>
+	class streaming_delaunay
+	{
+	public:
+		using triangle_sink = std::function<void(std::size_t, std::size_t, std::size_t)>;
+
+		explicit streaming_delaunay(triangle_sink sink, const streaming_options &options = streaming_options());
+
+		void push(const PointType &point);
+		template<typename Iterator>
+		void push(Iterator begin, Iterator end);
+		void finish();
+
+		std::size_t point_count() const;
+		std::size_t emitted_count() const;
+		std::size_t live_triangle_count() const;
+		std::size_t live_vertex_count() const;
+		std::size_t working_set() const;
+		std::size_t peak_working_set() const;
+
+	private:
+		static constexpr std::size_t triangle_bytes = 6 * sizeof(std::size_t) + sizeof(std::uint32_t);
+		static constexpr std::size_t vertex_bytes = sizeof(PointType) + 2 * sizeof(std::size_t) + sizeof(std::uint32_t);
+
+		triangle_sink sink_;
+		streaming_options options_;
+		std::size_t tile_size_ = 0;
+		std::size_t tile_count_ = 0;
+		std::size_t count_ = 0;
+		std::size_t emitted_ = 0;
+		double sweep_ = -std::numeric_limits<double>::infinity();
+
+		// live vertices in reusable slots, with their index in the input stream and the number of live
+		// triangles using them.
+		std::vector<PointType> vertices_;
+		std::vector<std::size_t> ids_;
+		std::vector<std::uint32_t> references_;
+		std::vector<std::size_t> links_;
+		std::vector<std::size_t> free_vertices_;
+		std::size_t live_vertices_ = 0;
+
+		// live triangles in reusable slots, laid out as in mesh. A halfedge whose twin was finished has
+		// invalid_index as its twin.
+		std::vector<std::size_t> triangles_;
+		std::vector<std::size_t> halfedges_;
+		std::vector<std::size_t> free_triangles_;
+		std::size_t live_triangles_ = 0;
+		std::size_t peak_ = 0;
+
+		std::size_t hull_edge_ = invalid_index;
+		std::vector<std::size_t> pending_;
+
+		// scratch buffers reused between insertions.
+		std::vector<std::uint32_t> marks_;
+		std::uint32_t stamp_ = 0;
+		std::vector<std::size_t> stack_;
+		std::vector<std::size_t> cavity_;
+		std::vector<std::size_t> boundary_;
+		std::vector<std::size_t> recent_;
+		std::size_t infinite_link_ = invalid_index;
+
+		std::size_t add_vertex(const PointType &point);
+		void release_vertex(const std::size_t &vertex);
+		void insert(const std::size_t &vertex);
+		std::size_t find_visible(const std::size_t &vertex) const;
+		void carve(const std::size_t &vertex, const std::size_t &seed);
+		std::size_t allocate();
+		void release(const std::size_t &triangle, const bool &emit);
+		void finalize();
+		bool is_final(const std::size_t &triangle) const;
+		bool is_ghost(const std::size_t &triangle) const;
+		bool in_conflict(const std::size_t &triangle, const PointType &point) const;
+		bool ghost_conflict(const std::size_t &a, const std::size_t &b, const PointType &point) const;
+		std::size_t& link(const std::size_t &vertex);
+		std::uint32_t next_stamp();
+		void bootstrap();
+		void create_first_triangle(std::size_t a, std::size_t b, std::size_t c);
+		void check_budget();
+	};
+
+	template <typename PointType, typename T>
+	constexpr std::size_t streaming_delaunay<PointType, T>::triangle_bytes;
+
+	template <typename PointType, typename T>
+	constexpr std::size_t streaming_delaunay<PointType, T>::vertex_bytes;
+
+	template <typename PointType, typename T>
+	streaming_delaunay<PointType, T>::streaming_delaunay(triangle_sink sink, const streaming_options& options)
+		:sink_(std::move(sink)), options_(options)
+	{
+		// a tile adds about two triangles per point; keep it to a quarter of the budget.
+		tile_size_ = options_.tile_size > 0 ? options_.tile_size :
+			std::max<std::size_t>(1, options_.memory_budget / (4 * (2 * triangle_bytes + vertex_bytes)));
+	}
+
+	/**
+	* Add the next point of the stream. Its x coordinate must not be smaller than that of the previous point.
+	*/
+	template <typename PointType, typename T>
+	void streaming_delaunay<PointType, T>::push(const PointType& point)
+	{
+		const auto x = static_cast<double>(point.x());
+		const auto y = static_cast<double>(point.y());
+		if (x < sweep_)
+		{
+			throw std::runtime_error("Streamed points must be sorted by x.");
+		}
+		if (x > options_.max_x || y < options_.min_y || y > options_.max_y)
+		{
+			throw std::runtime_error("Streamed point lies outside the given bounds.");
+		}
+		sweep_ = x;
+		count_++;
+
+		auto vertex = add_vertex(point);
+		if (triangles_.empty())
+		{
+			pending_.push_back(vertex);
+			bootstrap();
+		}
+		else
+		{
+			insert(vertex);
+		}
+
+		if (++tile_count_ >= tile_size_)
+		{
+			tile_count_ = 0;
+			finalize();
+		}
+	}
+
+	template <typename PointType, typename T>
+	template <typename Iterator>
+	void streaming_delaunay<PointType, T>::push(Iterator begin, Iterator end)
+	{
+		for (auto it = begin; it != end; ++it)
+		{
+			push(*it);
+		}
+	}
+
+	/**
+	* End of the stream: write out all remaining triangles and start over.
+	*/
+	template <typename PointType, typename T>
+	void streaming_delaunay<PointType, T>::finish()
+	{
+		for (std::size_t t = 0; t < triangles_.size() / 3; t++)
+		{
+			if (triangles_[3 * t] != invalid_index && !is_ghost(t))
+			{
+				sink_(ids_[triangles_[3 * t]], ids_[triangles_[3 * t + 1]], ids_[triangles_[3 * t + 2]]);
+				emitted_++;
+			}
+		}
+		vertices_.clear();
+		ids_.clear();
+		references_.clear();
+		links_.clear();
+		free_vertices_.clear();
+		triangles_.clear();
+		halfedges_.clear();
+		free_triangles_.clear();
+		pending_.clear();
+		live_vertices_ = 0;
+		live_triangles_ = 0;
+		hull_edge_ = invalid_index;
+		tile_count_ = 0;
+		count_ = 0;
+		sweep_ = -std::numeric_limits<double>::infinity();
+	}
+
+	template <typename PointType, typename T>
+	std::size_t streaming_delaunay<PointType, T>::point_count() const
+	{
+		return count_;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t streaming_delaunay<PointType, T>::emitted_count() const
+	{
+		return emitted_;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t streaming_delaunay<PointType, T>::live_triangle_count() const
+	{
+		return live_triangles_;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t streaming_delaunay<PointType, T>::live_vertex_count() const
+	{
+		return live_vertices_;
+	}
+
+	/**
+	* Bytes used by the live triangles and vertices.
+	*/
+	template <typename PointType, typename T>
+	std::size_t streaming_delaunay<PointType, T>::working_set() const
+	{
+		return live_triangles_ * triangle_bytes + live_vertices_ * vertex_bytes;
+	}
+
+	/**
+	* Largest working set seen after a tile was written out.
+	*/
+	template <typename PointType, typename T>
+	std::size_t streaming_delaunay<PointType, T>::peak_working_set() const
+	{
+		return peak_;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t streaming_delaunay<PointType, T>::add_vertex(const PointType& point)
+	{
+		live_vertices_++;
+		if (!free_vertices_.empty())
+		{
+			auto vertex = free_vertices_.back();
+			free_vertices_.pop_back();
+			vertices_[vertex] = point;
+			ids_[vertex] = count_ - 1;
+			references_[vertex] = 0;
+			return vertex;
+		}
+		vertices_.push_back(point);
+		ids_.push_back(count_ - 1);
+		references_.push_back(0);
+		links_.push_back(invalid_index);
+		return vertices_.size() - 1;
+	}
+
+	template <typename PointType, typename T>
+	void streaming_delaunay<PointType, T>::release_vertex(const std::size_t& vertex)
+	{
+		live_vertices_--;
+		free_vertices_.push_back(vertex);
+	}
+
+	template <typename PointType, typename T>
+	void streaming_delaunay<PointType, T>::insert(const std::size_t& vertex)
+	{
+		auto seed = find_visible(vertex);
+		if (seed == invalid_index)
+		{
+			// a duplicate of a hull vertex.
+			release_vertex(vertex);
+			return;
+		}
+		carve(vertex, seed);
+	}
+
+	template <typename PointType, typename T>
+	std::size_t streaming_delaunay<PointType, T>::find_visible(const std::size_t& vertex) const
+	{
+		// the point is not left of any live vertex, so it lies on or outside the hull and sees a hull edge.
+		// One of those is next to the previous point; walk the ghost ring both ways from there. The ring is only
+		// cut where ghosts were finished, which no later point can see.
+		const auto &point = vertices_[vertex];
+		const auto start = hull_edge_;
+		for (std::size_t direction = 0; direction < 2; direction++)
+		{
+			auto e = start;
+			while (true)
+			{
+				auto ghost = e / 3;
+				if (vertices_[triangles_[mesh<PointType, T>::next(e)]] == point)
+				{
+					return invalid_index;
+				}
+				if (in_conflict(ghost, point))
+				{
+					return ghost;
+				}
+				// e runs from infinity to a hull vertex. Counter clockwise, the next ghost holds the twin of
+				// e; clockwise, the twin of the edge into infinity.
+				auto twin = direction == 0 ? halfedges_[e] : halfedges_[mesh<PointType, T>::prev(e)];
+				if (twin == invalid_index)
+				{
+					break;
+				}
+				e = direction == 0 ? mesh<PointType, T>::next(twin) : twin;
+				if (e == start)
+				{
+					// the ring is closed and was searched completely.
+					direction = 2;
+					break;
+				}
+			}
+		}
+		throw std::runtime_error("Streamed point is not on or outside the hull of the previous points.");
+	}
+
+	template <typename PointType, typename T>
+	void streaming_delaunay<PointType, T>::carve(const std::size_t& vertex, const std::size_t& seed)
+	{
+		// same as mesh: grow the Bowyer-Watson cavity and fill it with a fan around the new vertex. Edges
+		// towards finished triangles are always on the cavity boundary.
+		const auto &point = vertices_[vertex];
+		auto conflict = next_stamp();
+		auto checked = conflict + 1;
+		cavity_.clear();
+		boundary_.clear();
+		stack_.clear();
+		marks_[seed] = conflict;
+		cavity_.push_back(seed);
+		stack_.push_back(seed);
+		while (!stack_.empty())
+		{
+			auto current = stack_.back();
+			stack_.pop_back();
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				auto e = 3 * current + i;
+				auto twin = halfedges_[e];
+				if (twin == invalid_index)
+				{
+					boundary_.push_back(e);
+					continue;
+				}
+				auto neighbour = twin / 3;
+				if (marks_[neighbour] == conflict)
+				{
+					continue;
+				}
+				if (marks_[neighbour] != checked && in_conflict(neighbour, point))
+				{
+					marks_[neighbour] = conflict;
+					cavity_.push_back(neighbour);
+					stack_.push_back(neighbour);
+				}
+				else
+				{
+					marks_[neighbour] = checked;
+					boundary_.push_back(e);
+				}
+			}
+		}
+
+		auto &edge_info = stack_;
+		edge_info.clear();
+		for (const auto &e : boundary_)
+		{
+			edge_info.push_back(triangles_[e]);
+			edge_info.push_back(triangles_[mesh<PointType, T>::next(e)]);
+			edge_info.push_back(halfedges_[e]);
+		}
+		for (const auto &triangle : cavity_)
+		{
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				if (triangles_[3 * triangle + i] != infinite_vertex)
+				{
+					references_[triangles_[3 * triangle + i]]--;
+				}
+			}
+		}
+
+		recent_.clear();
+		for (std::size_t j = 0; j < boundary_.size(); j++)
+		{
+			auto slot = j < cavity_.size() ? cavity_[j] : allocate();
+			auto a = edge_info[3 * j];
+			auto b = edge_info[3 * j + 1];
+			auto outside = edge_info[3 * j + 2];
+			triangles_[3 * slot] = a;
+			triangles_[3 * slot + 1] = b;
+			triangles_[3 * slot + 2] = vertex;
+			halfedges_[3 * slot] = outside;
+			if (outside != invalid_index)
+			{
+				halfedges_[outside] = 3 * slot;
+			}
+			link(a) = slot;
+			if (a != infinite_vertex) references_[a]++;
+			if (b != infinite_vertex) references_[b]++;
+			references_[vertex]++;
+			recent_.push_back(slot);
+		}
+
+		// stitch the fan as in mesh and keep a ghost edge at the new vertex for the next point.
+		for (const auto &slot : recent_)
+		{
+			auto other = link(triangles_[3 * slot + 1]);
+			halfedges_[3 * slot + 1] = 3 * other + 2;
+			halfedges_[3 * other + 2] = 3 * slot + 1;
+			if (triangles_[3 * slot] == infinite_vertex)
+			{
+				hull_edge_ = 3 * slot;
+			}
+		}
+	}
+
+	template <typename PointType, typename T>
+	std::size_t streaming_delaunay<PointType, T>::allocate()
+	{
+		live_triangles_++;
+		if (!free_triangles_.empty())
+		{
+			auto slot = free_triangles_.back();
+			free_triangles_.pop_back();
+			return slot;
+		}
+		triangles_.resize(triangles_.size() + 3);
+		halfedges_.resize(halfedges_.size() + 3);
+		marks_.resize(triangles_.size() / 3, 0);
+		return triangles_.size() / 3 - 1;
+	}
+
+	template <typename PointType, typename T>
+	void streaming_delaunay<PointType, T>::release(const std::size_t& triangle, const bool& emit)
+	{
+		if (emit)
+		{
+			sink_(ids_[triangles_[3 * triangle]], ids_[triangles_[3 * triangle + 1]], ids_[triangles_[3 * triangle + 2]]);
+			emitted_++;
+		}
+		for (std::size_t i = 0; i < 3; i++)
+		{
+			auto twin = halfedges_[3 * triangle + i];
+			if (twin != invalid_index)
+			{
+				halfedges_[twin] = invalid_index;
+			}
+			auto vertex = triangles_[3 * triangle + i];
+			if (vertex != infinite_vertex && --references_[vertex] == 0)
+			{
+				release_vertex(vertex);
+			}
+		}
+		triangles_[3 * triangle] = invalid_index;
+		free_triangles_.push_back(triangle);
+		live_triangles_--;
+	}
+
+	template <typename PointType, typename T>
+	void streaming_delaunay<PointType, T>::finalize()
+	{
+		for (std::size_t t = 0; t < triangles_.size() / 3; t++)
+		{
+			if (triangles_[3 * t] != invalid_index && is_final(t))
+			{
+				release(t, !is_ghost(t));
+			}
+		}
+		peak_ = std::max(peak_, working_set());
+		check_budget();
+	}
+
+	template <typename PointType, typename T>
+	bool streaming_delaunay<PointType, T>::is_final(const std::size_t& triangle) const
+	{
+		// unread points lie in the box [sweep, max_x] x [min_y, max_y].
+		auto a = triangles_[3 * triangle];
+		auto b = triangles_[3 * triangle + 1];
+		auto c = triangles_[3 * triangle + 2];
+		if (a == infinite_vertex || b == infinite_vertex || c == infinite_vertex)
+		{
+			// a hull edge is final when the whole box is strictly on its inner side.
+			if (!std::isfinite(options_.min_y) || !std::isfinite(options_.max_y) || !std::isfinite(options_.max_x))
+			{
+				return false;
+			}
+			const auto first = a == infinite_vertex ? b : (b == infinite_vertex ? c : a);
+			const auto second = a == infinite_vertex ? c : (b == infinite_vertex ? a : b);
+			const point<double> corners[4] = { { sweep_, options_.min_y }, { sweep_, options_.max_y },
+				{ options_.max_x, options_.min_y }, { options_.max_x, options_.max_y } };
+			const point<double> start(static_cast<double>(vertices_[first].x()), static_cast<double>(vertices_[first].y()));
+			const point<double> end(static_cast<double>(vertices_[second].x()), static_cast<double>(vertices_[second].y()));
+			for (const auto &corner : corners)
+			{
+				if (predicates::orient2d(start, end, corner) >= 0.0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// a finite triangle is final when its circumcircle misses the box. The margin covers the rounding
+		// of the circumcenter.
+		const auto &first = vertices_[a];
+		const auto center = circumcenter(first, vertices_[b], vertices_[c]);
+		const auto radius = std::sqrt(squared_distance(center, first));
+		if (!std::isfinite(radius))
+		{
+			return false;
+		}
+		const auto cx = center.x();
+		const auto cy = center.y();
+		const auto dx = cx < sweep_ ? sweep_ - cx : (cx > options_.max_x ? cx - options_.max_x : 0.0);
+		const auto dy = cy < options_.min_y ? options_.min_y - cy : (cy > options_.max_y ? cy - options_.max_y : 0.0);
+		const auto margin = 1e-9 * (radius + std::abs(cx) + std::abs(cy) + std::abs(sweep_));
+		const auto reach = radius + margin;
+		return dx * dx + dy * dy > reach * reach;
+	}
+
+	template <typename PointType, typename T>
+	bool streaming_delaunay<PointType, T>::is_ghost(const std::size_t& triangle) const
+	{
+		return triangles_[3 * triangle] == infinite_vertex ||
+			triangles_[3 * triangle + 1] == infinite_vertex ||
+			triangles_[3 * triangle + 2] == infinite_vertex;
+	}
+
+	template <typename PointType, typename T>
+	bool streaming_delaunay<PointType, T>::in_conflict(const std::size_t& triangle, const PointType& point) const
+	{
+		auto a = triangles_[3 * triangle];
+		auto b = triangles_[3 * triangle + 1];
+		auto c = triangles_[3 * triangle + 2];
+		if (a == infinite_vertex) return ghost_conflict(b, c, point);
+		if (b == infinite_vertex) return ghost_conflict(c, a, point);
+		if (c == infinite_vertex) return ghost_conflict(a, b, point);
+		return predicates::incircle(vertices_[a], vertices_[b], vertices_[c], point) > 0.0;
+	}
+
+	template <typename PointType, typename T>
+	bool streaming_delaunay<PointType, T>::ghost_conflict(const std::size_t& a, const std::size_t& b, const PointType& point) const
+	{
+		const auto &first = vertices_[a];
+		const auto &second = vertices_[b];
+		auto orientation = predicates::orient2d(first, second, point);
+		if (orientation != 0.0)
+		{
+			return orientation > 0.0;
+		}
+		if (first.x() != second.x())
+		{
+			return point.x() > std::min(first.x(), second.x()) && point.x() < std::max(first.x(), second.x());
+		}
+		return point.y() > std::min(first.y(), second.y()) && point.y() < std::max(first.y(), second.y());
+	}
+
+	template <typename PointType, typename T>
+	std::size_t& streaming_delaunay<PointType, T>::link(const std::size_t& vertex)
+	{
+		if (vertex == infinite_vertex)
+		{
+			return infinite_link_;
+		}
+		return links_[vertex];
+	}
+
+	template <typename PointType, typename T>
+	std::uint32_t streaming_delaunay<PointType, T>::next_stamp()
+	{
+		if (stamp_ >= std::numeric_limits<std::uint32_t>::max() - 2)
+		{
+			std::fill(marks_.begin(), marks_.end(), 0);
+			stamp_ = 0;
+		}
+		stamp_ += 2;
+		return stamp_;
+	}
+
+	template <typename PointType, typename T>
+	void streaming_delaunay<PointType, T>::bootstrap()
+	{
+		// as in mesh, wait for three distinct, non collinear points.
+		const auto &first = vertices_[pending_.front()];
+		auto second = invalid_index;
+		for (const auto &candidate : pending_)
+		{
+			if (!(vertices_[candidate] == first))
+			{
+				second = candidate;
+				break;
+			}
+		}
+		if (second == invalid_index)
+		{
+			return;
+		}
+		for (const auto &candidate : pending_)
+		{
+			if (predicates::orient2d(first, vertices_[second], vertices_[candidate]) != 0.0)
+			{
+				auto waiting = std::move(pending_);
+				pending_.clear();
+				auto a = waiting.front();
+				auto c = candidate;
+				create_first_triangle(a, second, c);
+				for (const auto &index : waiting)
+				{
+					if (index != a && index != second && index != c)
+					{
+						insert(index);
+					}
+				}
+
+				// the next point is searched for from a ghost at c, the rightmost point so far.
+				for (std::size_t e = 0; e < triangles_.size(); e++)
+				{
+					if (triangles_[e] == infinite_vertex && (triangles_[mesh<PointType, T>::next(e)] == c ||
+						triangles_[mesh<PointType, T>::prev(e)] == c))
+					{
+						hull_edge_ = e;
+						break;
+					}
+				}
+				return;
+			}
+		}
+	}
+
+	template <typename PointType, typename T>
+	void streaming_delaunay<PointType, T>::create_first_triangle(std::size_t a, std::size_t b, std::size_t c)
+	{
+		if (predicates::orient2d(vertices_[a], vertices_[b], vertices_[c]) < 0.0)
+		{
+			std::swap(b, c);
+		}
+		const auto inf = infinite_vertex;
+		triangles_ = { a, b, c, b, a, inf, c, b, inf, a, c, inf };
+		halfedges_ = { 3, 6, 9, 0, 11, 7, 1, 5, 10, 2, 8, 4 };
+		marks_.assign(4, 0);
+		live_triangles_ = 4;
+		references_[a] = 3;
+		references_[b] = 3;
+		references_[c] = 3;
+		hull_edge_ = 5;
+	}
+
+	template <typename PointType, typename T>
+	void streaming_delaunay<PointType, T>::check_budget()
+	{
+		if (working_set() > options_.memory_budget)
+		{
+			throw std::runtime_error("Streaming triangulation exceeds its memory budget.");
+		}
+	}
+}
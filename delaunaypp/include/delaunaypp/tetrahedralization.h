@@ -0,0 +1,729 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "mesh.h"
+#include "predicates.h"
+
+namespace delaunaypp
+{
+	namespace internal
+	{
+		/**
+		* Position of (x, y, z) on a 3D Hilbert curve with 21 bits per axis (J. Skilling, "Programming the
+		* Hilbert curve").
+		*/
+		inline std::uint64_t hilbert_index_3d(std::uint32_t x, std::uint32_t y, std::uint32_t z)
+		{
+			const int bits = 21;
+			std::uint32_t axes[3] = { x, y, z };
+			for (std::uint32_t q = 1u << (bits - 1); q > 1; q >>= 1)
+			{
+				auto p = q - 1;
+				for (auto i = 0; i < 3; i++)
+				{
+					if (axes[i] & q)
+					{
+						axes[0] ^= p;
+					}
+					else
+					{
+						auto t = (axes[0] ^ axes[i]) & p;
+						axes[0] ^= t;
+						axes[i] ^= t;
+					}
+				}
+			}
+			for (auto i = 1; i < 3; i++)
+			{
+				axes[i] ^= axes[i - 1];
+			}
+			std::uint32_t t = 0;
+			for (std::uint32_t q = 1u << (bits - 1); q > 1; q >>= 1)
+			{
+				if (axes[2] & q) t ^= q - 1;
+			}
+			for (auto i = 0; i < 3; i++)
+			{
+				axes[i] ^= t;
+			}
+
+			// interleave the transposed bits, most significant first.
+			std::uint64_t index = 0;
+			for (auto bit = bits - 1; bit >= 0; bit--)
+			{
+				for (auto i = 0; i < 3; i++)
+				{
+					index = (index << 1) | ((axes[i] >> bit) & 1u);
+				}
+			}
+			return index;
+		}
+
+		template<typename PointType>
+		std::vector<std::size_t> hilbert_order_3d(const std::vector<PointType> &points)
+		{
+			std::vector<std::size_t> order(points.size());
+			if (points.empty())
+			{
+				return order;
+			}
+
+			double low[3], high[3];
+			for (auto i = 0; i < 3; i++)
+			{
+				low[i] = high[i] = static_cast<double>(points[0][i]);
+			}
+			for (const auto &point : points)
+			{
+				for (auto i = 0; i < 3; i++)
+				{
+					low[i] = std::min(low[i], static_cast<double>(point[i]));
+					high[i] = std::max(high[i], static_cast<double>(point[i]));
+				}
+			}
+			double scale[3];
+			for (auto i = 0; i < 3; i++)
+			{
+				scale[i] = high[i] > low[i] ? 2097151.0 / (high[i] - low[i]) : 0.0;
+			}
+
+			std::vector<std::pair<std::uint64_t, std::size_t>> keys(points.size());
+			for (std::size_t i = 0; i < points.size(); i++)
+			{
+				std::uint32_t cell[3];
+				for (auto j = 0; j < 3; j++)
+				{
+					cell[j] = static_cast<std::uint32_t>((static_cast<double>(points[i][j]) - low[j]) * scale[j]);
+				}
+				keys[i] = std::make_pair(hilbert_index_3d(cell[0], cell[1], cell[2]), i);
+			}
+			std::sort(keys.begin(), keys.end());
+			for (std::size_t i = 0; i < keys.size(); i++)
+			{
+				order[i] = keys[i].second;
+			}
+			return order;
+		}
+	}
+
+	/**
+	* Incrementally built 3D Delaunay tetrahedralization (Bowyer-Watson) over point<T, 3>.
+	*
+	* Tetrahedron t owns the four vertex indices tetrahedra()[4t .. 4t + 3] and is positively oriented
+	* (predicates::orient3d > 0). Face i of a tetrahedron is the face opposite its vertex i. neighbors()[4t + i]
+	* is the face handle 4n + j of the same face seen from the neighbouring tetrahedron n. Every convex hull
+	* facet is closed off by a ghost tetrahedron using infinite. Indices are 32 bit to keep the arrays compact.
+	*/
+	template<typename PointType, typename T = typename PointType::value_type>
+	class tetrahedralization
+	{
+	public:
+		using vertex_type = PointType;
+		using value_type = T;
+		using index_type = std::uint32_t;
+
+		static constexpr index_type infinite = std::numeric_limits<index_type>::max() - 1;
+		static constexpr index_type invalid = std::numeric_limits<index_type>::max();
+
+		tetrahedralization() = default;
+		explicit tetrahedralization(std::vector<PointType> vertices);
+
+		void tetrahedralize();
+		void clear();
+		std::size_t add_vertex(const PointType &point);
+		std::size_t insert(const std::size_t &vertex, const std::size_t &hint = invalid_index);
+
+		std::size_t locate(const PointType &point, const std::size_t &hint = invalid_index) const;
+
+		std::size_t vertex_count() const;
+		std::size_t tetrahedron_count() const;
+		std::size_t finite_tetrahedron_count() const;
+		const PointType& vertex(const std::size_t &index) const;
+		const std::vector<PointType>& vertices() const;
+		const std::vector<index_type>& tetrahedra() const;
+		const std::vector<index_type>& neighbors() const;
+		std::size_t neighbor(const std::size_t &tetrahedron, const std::size_t &face) const;
+		bool is_ghost(const std::size_t &tetrahedron) const;
+		bool is_inserted(const std::size_t &vertex) const;
+
+		static std::size_t face_vertex(const std::size_t &face, const std::size_t &index);
+
+	private:
+		std::vector<PointType> vertices_;
+		std::vector<index_type> tetrahedra_;
+		std::vector<index_type> neighbors_;
+		std::vector<index_type> vertex_tetrahedra_;
+		std::size_t finite_count_ = 0;
+		std::size_t last_ = invalid_index;
+
+		// vertices waiting for four non coplanar points to start the tetrahedralization.
+		std::vector<std::size_t> pending_;
+
+		// scratch buffers reused between insertions.
+		std::vector<std::uint32_t> marks_;
+		std::uint32_t stamp_ = 0;
+		std::vector<std::size_t> stack_;
+		std::vector<std::size_t> cavity_;
+		std::vector<index_type> boundary_;
+		std::vector<index_type> faces_;
+		std::vector<std::size_t> created_;
+		std::vector<std::uint64_t> edge_keys_;
+		std::vector<index_type> edge_faces_;
+		std::vector<std::uint32_t> edge_stamps_;
+		std::uint32_t edge_stamp_ = 0;
+
+		bool in_conflict(const std::size_t &tetrahedron, const PointType &point) const;
+		std::size_t infinite_position(const std::size_t &tetrahedron) const;
+		std::size_t allocate();
+		void release(std::vector<std::size_t> &slots);
+		void stitch();
+		std::uint32_t next_stamp();
+		void bootstrap();
+		void create_first_tetrahedron(std::size_t a, std::size_t b, std::size_t c, std::size_t d);
+	};
+
+	template <typename PointType, typename T>
+	constexpr typename tetrahedralization<PointType, T>::index_type tetrahedralization<PointType, T>::infinite;
+
+	template <typename PointType, typename T>
+	constexpr typename tetrahedralization<PointType, T>::index_type tetrahedralization<PointType, T>::invalid;
+
+	template <typename PointType, typename T>
+	tetrahedralization<PointType, T>::tetrahedralization(std::vector<PointType> vertices)
+		:vertices_(std::move(vertices))
+	{
+	}
+
+	template <typename PointType, typename T>
+	void tetrahedralization<PointType, T>::tetrahedralize()
+	{
+		if (vertices_.size() >= infinite)
+		{
+			throw std::runtime_error("Too many vertices for 32 bit indices.");
+		}
+		clear();
+		vertex_tetrahedra_.assign(vertices_.size(), invalid);
+		tetrahedra_.reserve(vertices_.size() * 28 + 20);
+		neighbors_.reserve(vertices_.size() * 28 + 20);
+
+		// insert along a space filling curve so every walk starts right next to its target.
+		auto order = internal::hilbert_order_3d(vertices_);
+		for (const auto &index : order)
+		{
+			insert(index, last_);
+		}
+	}
+
+	template <typename PointType, typename T>
+	void tetrahedralization<PointType, T>::clear()
+	{
+		tetrahedra_.clear();
+		neighbors_.clear();
+		std::fill(vertex_tetrahedra_.begin(), vertex_tetrahedra_.end(), invalid);
+		finite_count_ = 0;
+		last_ = invalid_index;
+		pending_.clear();
+	}
+
+	template <typename PointType, typename T>
+	std::size_t tetrahedralization<PointType, T>::add_vertex(const PointType& point)
+	{
+		if (vertices_.size() + 1 >= infinite)
+		{
+			throw std::runtime_error("Too many vertices for 32 bit indices.");
+		}
+		vertices_.push_back(point);
+		vertex_tetrahedra_.resize(vertices_.size(), invalid);
+		return vertices_.size() - 1;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t tetrahedralization<PointType, T>::insert(const std::size_t& vertex, const std::size_t& hint)
+	{
+		if (vertex_tetrahedra_.size() < vertices_.size())
+		{
+			vertex_tetrahedra_.resize(vertices_.size(), invalid);
+		}
+		if (tetrahedra_.empty())
+		{
+			pending_.push_back(vertex);
+			bootstrap();
+			return vertex;
+		}
+
+		const auto &point = vertices_[vertex];
+		auto start = locate(point, hint);
+		if (!is_ghost(start))
+		{
+			for (std::size_t i = 0; i < 4; i++)
+			{
+				auto existing = tetrahedra_[4 * start + i];
+				if (vertices_[existing] == point)
+				{
+					return existing;
+				}
+			}
+		}
+
+		// collect the tetrahedra whose circumsphere contains the point (the Bowyer-Watson cavity)
+		// and the faces on its boundary.
+		auto conflict = next_stamp();
+		auto checked = conflict + 1;
+		cavity_.clear();
+		boundary_.clear();
+		stack_.clear();
+		marks_[start] = conflict;
+		cavity_.push_back(start);
+		stack_.push_back(start);
+		while (!stack_.empty())
+		{
+			auto current = stack_.back();
+			stack_.pop_back();
+			for (std::size_t i = 0; i < 4; i++)
+			{
+				auto face = static_cast<index_type>(4 * current + i);
+				auto neighbour = neighbors_[face] / 4;
+				if (marks_[neighbour] == conflict)
+				{
+					continue;
+				}
+				if (marks_[neighbour] != checked && in_conflict(neighbour, point))
+				{
+					marks_[neighbour] = conflict;
+					cavity_.push_back(neighbour);
+					stack_.push_back(neighbour);
+				}
+				else
+				{
+					marks_[neighbour] = checked;
+					boundary_.push_back(face);
+				}
+			}
+		}
+
+		// replace the cavity by a cone of tetrahedra from the new vertex over the boundary faces. Boundary
+		// face i of a cavity tetrahedron sees the cavity on its positive side, so (face, vertex) is positive.
+		for (const auto &tetrahedron : cavity_)
+		{
+			if (!is_ghost(tetrahedron)) finite_count_--;
+		}
+		faces_.clear();
+		for (const auto &face : boundary_)
+		{
+			auto tetrahedron = face / 4;
+			auto opposite = face % 4;
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				faces_.push_back(tetrahedra_[4 * tetrahedron + face_vertex(opposite, i)]);
+			}
+			faces_.push_back(neighbors_[face]);
+		}
+
+		created_.clear();
+		for (std::size_t j = 0; j < boundary_.size(); j++)
+		{
+			auto slot = j < cavity_.size() ? cavity_[j] : allocate();
+			auto outside = faces_[4 * j + 3];
+			auto finite = true;
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				auto corner = faces_[4 * j + i];
+				tetrahedra_[4 * slot + i] = corner;
+				if (corner == infinite)
+				{
+					finite = false;
+				}
+				else
+				{
+					vertex_tetrahedra_[corner] = static_cast<index_type>(slot);
+				}
+			}
+			tetrahedra_[4 * slot + 3] = static_cast<index_type>(vertex);
+			neighbors_[4 * slot + 3] = outside;
+			neighbors_[outside] = static_cast<index_type>(4 * slot + 3);
+			if (finite) finite_count_++;
+			created_.push_back(slot);
+		}
+		vertex_tetrahedra_[vertex] = static_cast<index_type>(created_.front());
+		stitch();
+		last_ = created_.front();
+
+		// a cavity can have more tetrahedra than boundary faces; the spare slots are removed.
+		if (cavity_.size() > boundary_.size())
+		{
+			cavity_.erase(cavity_.begin(), cavity_.begin() + boundary_.size());
+			release(cavity_);
+		}
+		return vertex;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t tetrahedralization<PointType, T>::locate(const PointType& point, const std::size_t& hint) const
+	{
+		if (finite_count_ == 0)
+		{
+			return invalid_index;
+		}
+		auto current = hint < tetrahedron_count() ? hint : last_;
+		if (is_ghost(current))
+		{
+			current = neighbors_[4 * current + infinite_position(current)] / 4;
+		}
+
+		// visibility walk; a cheap random rotation of the first tested face keeps it from cycling.
+		auto state = static_cast<std::uint32_t>(current * 2654435761u + 1u);
+		auto entry = static_cast<std::size_t>(invalid);
+		while (true)
+		{
+			state = state * 1664525u + 1013904223u;
+			auto rotation = static_cast<std::size_t>((state >> 16) % 4);
+			auto crossed = false;
+			for (std::size_t k = 0; k < 4; k++)
+			{
+				auto face = 4 * current + (k + rotation) % 4;
+				if (face == entry)
+				{
+					continue;
+				}
+				auto opposite = face % 4;
+				const auto &a = vertices_[tetrahedra_[4 * current + face_vertex(opposite, 0)]];
+				const auto &b = vertices_[tetrahedra_[4 * current + face_vertex(opposite, 1)]];
+				const auto &c = vertices_[tetrahedra_[4 * current + face_vertex(opposite, 2)]];
+				if (predicates::orient3d(a, b, c, point) < 0.0)
+				{
+					entry = neighbors_[face];
+					current = entry / 4;
+					if (is_ghost(current))
+					{
+						return current;
+					}
+					crossed = true;
+					break;
+				}
+			}
+			if (!crossed)
+			{
+				return current;
+			}
+		}
+	}
+
+	template <typename PointType, typename T>
+	std::size_t tetrahedralization<PointType, T>::vertex_count() const
+	{
+		return vertices_.size();
+	}
+
+	template <typename PointType, typename T>
+	std::size_t tetrahedralization<PointType, T>::tetrahedron_count() const
+	{
+		return tetrahedra_.size() / 4;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t tetrahedralization<PointType, T>::finite_tetrahedron_count() const
+	{
+		return finite_count_;
+	}
+
+	template <typename PointType, typename T>
+	const PointType& tetrahedralization<PointType, T>::vertex(const std::size_t& index) const
+	{
+		return vertices_[index];
+	}
+
+	template <typename PointType, typename T>
+	const std::vector<PointType>& tetrahedralization<PointType, T>::vertices() const
+	{
+		return vertices_;
+	}
+
+	template <typename PointType, typename T>
+	const std::vector<typename tetrahedralization<PointType, T>::index_type>& tetrahedralization<PointType, T>::tetrahedra() const
+	{
+		return tetrahedra_;
+	}
+
+	template <typename PointType, typename T>
+	const std::vector<typename tetrahedralization<PointType, T>::index_type>& tetrahedralization<PointType, T>::neighbors() const
+	{
+		return neighbors_;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t tetrahedralization<PointType, T>::neighbor(const std::size_t& tetrahedron, const std::size_t& face) const
+	{
+		return neighbors_[4 * tetrahedron + face] / 4;
+	}
+
+	template <typename PointType, typename T>
+	bool tetrahedralization<PointType, T>::is_ghost(const std::size_t& tetrahedron) const
+	{
+		return tetrahedra_[4 * tetrahedron] == infinite || tetrahedra_[4 * tetrahedron + 1] == infinite ||
+			tetrahedra_[4 * tetrahedron + 2] == infinite || tetrahedra_[4 * tetrahedron + 3] == infinite;
+	}
+
+	template <typename PointType, typename T>
+	bool tetrahedralization<PointType, T>::is_inserted(const std::size_t& vertex) const
+	{
+		return vertex < vertex_tetrahedra_.size() && vertex_tetrahedra_[vertex] != invalid;
+	}
+
+	/**
+	* Local index of vertex index (0 to 2) of face. The order puts the opposite vertex on the positive side.
+	*/
+	template <typename PointType, typename T>
+	std::size_t tetrahedralization<PointType, T>::face_vertex(const std::size_t& face, const std::size_t& index)
+	{
+		static const std::size_t table[4][3] = { { 1, 3, 2 }, { 0, 2, 3 }, { 0, 3, 1 }, { 0, 1, 2 } };
+		return table[face][index];
+	}
+
+	template <typename PointType, typename T>
+	bool tetrahedralization<PointType, T>::in_conflict(const std::size_t& tetrahedron, const PointType& point) const
+	{
+		const auto *corners = &tetrahedra_[4 * tetrahedron];
+		auto position = infinite_position(tetrahedron);
+		if (position == 4)
+		{
+			return predicates::insphere(vertices_[corners[0]], vertices_[corners[1]], vertices_[corners[2]],
+				vertices_[corners[3]], point) > 0.0;
+		}
+
+		// a ghost conflicts with points strictly outside its hull facet, or in the facet's plane and inside its
+		// circumcircle. The apex of the finite tetrahedron behind the facet lifts that circle to a sphere.
+		const auto &a = vertices_[corners[face_vertex(position, 0)]];
+		const auto &b = vertices_[corners[face_vertex(position, 1)]];
+		const auto &c = vertices_[corners[face_vertex(position, 2)]];
+		auto orientation = predicates::orient3d(a, b, c, point);
+		if (orientation != 0.0)
+		{
+			return orientation > 0.0;
+		}
+		auto mirror = neighbors_[4 * tetrahedron + position];
+		const auto &apex = vertices_[tetrahedra_[mirror]];
+		return predicates::insphere(a, b, c, apex, point) < 0.0;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t tetrahedralization<PointType, T>::infinite_position(const std::size_t& tetrahedron) const
+	{
+		for (std::size_t i = 0; i < 4; i++)
+		{
+			if (tetrahedra_[4 * tetrahedron + i] == infinite)
+			{
+				return i;
+			}
+		}
+		return 4;
+	}
+
+	template <typename PointType, typename T>
+	std::size_t tetrahedralization<PointType, T>::allocate()
+	{
+		// face handles 4t + i have to fit the index type.
+		auto slot = tetrahedron_count();
+		if (slot >= (static_cast<std::size_t>(1) << 30) - 1)
+		{
+			throw std::runtime_error("Too many tetrahedra for 32 bit indices.");
+		}
+		tetrahedra_.resize(tetrahedra_.size() + 4);
+		neighbors_.resize(neighbors_.size() + 4);
+		if (marks_.size() < tetrahedron_count())
+		{
+			marks_.resize(tetrahedron_count(), 0);
+		}
+		return slot;
+	}
+
+	template <typename PointType, typename T>
+	void tetrahedralization<PointType, T>::release(std::vector<std::size_t>& slots)
+	{
+		// fill every released slot with the last tetrahedron. Going from the highest slot down, the last
+		// tetrahedron is never one that is released as well.
+		std::sort(slots.begin(), slots.end(), [](const std::size_t &first, const std::size_t &second)
+		{
+			return first > second;
+		});
+		for (const auto &slot : slots)
+		{
+			auto last = tetrahedron_count() - 1;
+			if (slot != last)
+			{
+				for (std::size_t i = 0; i < 4; i++)
+				{
+					auto corner = tetrahedra_[4 * last + i];
+					auto face = neighbors_[4 * last + i];
+					tetrahedra_[4 * slot + i] = corner;
+					neighbors_[4 * slot + i] = face;
+					neighbors_[face] = static_cast<index_type>(4 * slot + i);
+					if (corner != infinite)
+					{
+						vertex_tetrahedra_[corner] = static_cast<index_type>(slot);
+					}
+				}
+				if (last_ == last)
+				{
+					last_ = slot;
+				}
+			}
+			tetrahedra_.resize(tetrahedra_.size() - 4);
+			neighbors_.resize(neighbors_.size() - 4);
+		}
+	}
+
+	template <typename PointType, typename T>
+	void tetrahedralization<PointType, T>::stitch()
+	{
+		// the new tetrahedra share their apex. Face i < 3 of one of them holds the apex and the base edge
+		// without base vertex i, and is glued to the other new tetrahedron with that base edge. The faces are
+		// paired up through a small open addressing table keyed by the edge.
+		std::size_t capacity = 16;
+		while (capacity < 6 * created_.size())
+		{
+			capacity *= 2;
+		}
+		if (edge_keys_.size() < capacity || ++edge_stamp_ == 0)
+		{
+			edge_keys_.resize(std::max(capacity, edge_keys_.size()));
+			edge_faces_.resize(edge_keys_.size());
+			edge_stamps_.assign(edge_keys_.size(), 0);
+			edge_stamp_ = 1;
+		}
+		const auto mask = capacity - 1;
+		for (const auto &slot : created_)
+		{
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				std::uint64_t first = tetrahedra_[4 * slot + (i + 1) % 3];
+				std::uint64_t second = tetrahedra_[4 * slot + (i + 2) % 3];
+				auto key = first < second ? (first << 32) | second : (second << 32) | first;
+				auto face = static_cast<index_type>(4 * slot + i);
+				auto bucket = static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 40) & mask;
+				while (edge_stamps_[bucket] == edge_stamp_ && edge_keys_[bucket] != key)
+				{
+					bucket = (bucket + 1) & mask;
+				}
+				if (edge_stamps_[bucket] == edge_stamp_)
+				{
+					neighbors_[face] = edge_faces_[bucket];
+					neighbors_[edge_faces_[bucket]] = face;
+				}
+				else
+				{
+					edge_stamps_[bucket] = edge_stamp_;
+					edge_keys_[bucket] = key;
+					edge_faces_[bucket] = face;
+				}
+			}
+		}
+	}
+
+	template <typename PointType, typename T>
+	std::uint32_t tetrahedralization<PointType, T>::next_stamp()
+	{
+		if (marks_.size() < tetrahedron_count())
+		{
+			marks_.resize(tetrahedron_count(), 0);
+		}
+		if (stamp_ >= std::numeric_limits<std::uint32_t>::max() - 2)
+		{
+			std::fill(marks_.begin(), marks_.end(), 0);
+			stamp_ = 0;
+		}
+		stamp_ += 2;
+		return stamp_;
+	}
+
+	template <typename PointType, typename T>
+	void tetrahedralization<PointType, T>::bootstrap()
+	{
+		// the first tetrahedron needs four distinct, non coplanar points.
+		const auto &first = vertices_[pending_.front()];
+		auto second = invalid_index;
+		auto third = invalid_index;
+		for (const auto &candidate : pending_)
+		{
+			const auto &point = vertices_[candidate];
+			if (second == invalid_index)
+			{
+				if (!(point == first)) second = candidate;
+				continue;
+			}
+			const auto &other = vertices_[second];
+			auto xy = predicates::orient2d(first[0], first[1], other[0], other[1], point[0], point[1]);
+			auto yz = predicates::orient2d(first[1], first[2], other[1], other[2], point[1], point[2]);
+			auto zx = predicates::orient2d(first[2], first[0], other[2], other[0], point[2], point[0]);
+			if (xy != 0.0 || yz != 0.0 || zx != 0.0)
+			{
+				third = candidate;
+				break;
+			}
+		}
+		if (third == invalid_index)
+		{
+			return;
+		}
+		for (const auto &candidate : pending_)
+		{
+			if (predicates::orient3d(first, vertices_[second], vertices_[third], vertices_[candidate]) != 0.0)
+			{
+				auto waiting = std::move(pending_);
+				pending_.clear();
+				auto a = waiting.front();
+				auto d = candidate;
+				create_first_tetrahedron(a, second, third, d);
+				for (const auto &index : waiting)
+				{
+					if (index != a && index != second && index != third && index != d)
+					{
+						insert(index, last_);
+					}
+				}
+				return;
+			}
+		}
+	}
+
+	template <typename PointType, typename T>
+	void tetrahedralization<PointType, T>::create_first_tetrahedron(std::size_t a, std::size_t b, std::size_t c, std::size_t d)
+	{
+		if (predicates::orient3d(vertices_[a], vertices_[b], vertices_[c], vertices_[d]) < 0.0)
+		{
+			std::swap(c, d);
+		}
+		tetrahedra_.assign(20, infinite);
+		neighbors_.assign(20, invalid);
+		tetrahedra_[0] = static_cast<index_type>(a);
+		tetrahedra_[1] = static_cast<index_type>(b);
+		tetrahedra_[2] = static_cast<index_type>(c);
+		tetrahedra_[3] = static_cast<index_type>(d);
+
+		// the ghost behind face i holds that face reversed, so the outside is its positive side.
+		created_.clear();
+		for (std::size_t i = 0; i < 4; i++)
+		{
+			auto ghost = i + 1;
+			tetrahedra_[4 * ghost] = tetrahedra_[face_vertex(i, 0)];
+			tetrahedra_[4 * ghost + 1] = tetrahedra_[face_vertex(i, 2)];
+			tetrahedra_[4 * ghost + 2] = tetrahedra_[face_vertex(i, 1)];
+			neighbors_[i] = static_cast<index_type>(4 * ghost + 3);
+			neighbors_[4 * ghost + 3] = static_cast<index_type>(i);
+			created_.push_back(ghost);
+		}
+		stitch();
+
+		vertex_tetrahedra_[a] = 0;
+		vertex_tetrahedra_[b] = 0;
+		vertex_tetrahedra_[c] = 0;
+		vertex_tetrahedra_[d] = 0;
+		finite_count_ = 1;
+		last_ = 0;
+		marks_.assign(5, 0);
+	}
+}
@@ -2,9 +2,37 @@
 
 #include <delaunaypp/point.h>
 #include <delaunaypp/pointaccessor.h>
+#include "delaunaypp/alpha_shape.h"
+#include "delaunaypp/batch.h"
+#include "delaunaypp/contour.h"
 #include "delaunaypp/edge.h"
 #include "delaunaypp/triangle.h"
 #include "delaunaypp/delaunay.h"
+#include "delaunaypp/graph.h"
+#include "delaunaypp/hierarchy.h"
+#include "delaunaypp/hull.h"
+#include "delaunaypp/interpolation.h"
+#include "delaunaypp/meshcodec.h"
+#include "delaunaypp/meshio.h"
+#include "delaunaypp/periodic.h"
+#include "delaunaypp/pointio.h"
+#include "delaunaypp/polygon.h"
+#include "delaunaypp/power_diagram.h"
+#include "delaunaypp/refine.h"
+#include "delaunaypp/segment_walk.h"
+#include "delaunaypp/simplify.h"
+#include "delaunaypp/sliding_window.h"
+#include "delaunaypp/snapshot.h"
+#include "delaunaypp/spatial_index.h"
+#include "delaunaypp/streaming.h"
+#include "delaunaypp/tetrahedralization.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <set>
 
 using namespace delaunaypp;
 TEST(PointAccessorTests, testIndexAccessor)
@@ -68,6 +96,25 @@ TEST(EdgeTests, equalityTest)
 	EXPECT_TRUE(edge4 == edge3);
 }
 
+TEST(EdgeTests, orderingTest)
+{
+	using point = point<double>;
+	using edge = internal::edge<point>;
+
+	edge forward(point(0.0, 0.0), point(1.0, 1.0));
+	edge backward(point(1.0, 1.0), point(0.0, 0.0));
+	edge other(point(0.0, 0.0), point(2.0, -1.0));
+
+	// the ordering agrees with the undirected operator==, so std::set drops reversed copies.
+	EXPECT_FALSE(forward < backward);
+	EXPECT_FALSE(backward < forward);
+	EXPECT_TRUE(forward < other || other < forward);
+	EXPECT_NE(forward < other, other < forward);
+	EXPECT_EQ(backward < other, forward < other);
+	std::set<edge> unique{ forward, backward, other, edge(point(2.0, -1.0), point(0.0, 0.0)) };
+	EXPECT_EQ(unique.size(), 2);
+}
+
 TEST(EdgeTests, midpointTest1)
 {
 	using point = point<double>;
@@ -295,4 +342,2356 @@ TEST(DelaunayTests, simpleSquareTests)
 		std::cout << std::endl;
 	}
 	ASSERT_EQ(triangles.size(), 2);
-}
\ No newline at end of file
+}
+
+template<typename MeshType>
+void expect_valid_delaunay(const MeshType &mesh)
+{
+	const auto &triangles = mesh.triangles();
+	const auto &halfedges = mesh.halfedges();
+	for (std::size_t e = 0; e < halfedges.size(); e++)
+	{
+		ASSERT_EQ(halfedges[halfedges[e]], e);
+		ASSERT_EQ(triangles[halfedges[e]], triangles[MeshType::next(e)]);
+	}
+	for (std::size_t t = 0; t < mesh.triangle_count(); t++)
+	{
+		if (mesh.is_ghost(t))
+		{
+			continue;
+		}
+		const auto &a = mesh.vertex(triangles[3 * t]);
+		const auto &b = mesh.vertex(triangles[3 * t + 1]);
+		const auto &c = mesh.vertex(triangles[3 * t + 2]);
+		ASSERT_GT(predicates::orient2d(a, b, c), 0.0);
+		for (std::size_t v = 0; v < mesh.vertex_count(); v++)
+		{
+			if (mesh.is_inserted(v))
+			{
+				ASSERT_LE(predicates::incircle(a, b, c, mesh.vertex(v)), 0.0);
+			}
+		}
+	}
+}
+
+TEST(PredicateTests, orientationTest)
+{
+	EXPECT_GT(predicates::orient2d(0.0, 0.0, 1.0, 0.0, 0.0, 1.0), 0.0);
+	EXPECT_LT(predicates::orient2d(0.0, 0.0, 0.0, 1.0, 1.0, 0.0), 0.0);
+	EXPECT_EQ(predicates::orient2d(0.0, 0.0, 1.0, 1.0, 3.0, 3.0), 0.0);
+
+	// nearly collinear points where naive floating point evaluation gives the wrong sign.
+	EXPECT_EQ(predicates::orient2d(0.5, 0.5, 12.0, 12.0, 24.0, 24.0), 0.0);
+	EXPECT_GT(predicates::orient2d(0.5, 0.5 + 1e-16 * 4, 12.0, 12.0, 24.0, 24.0), 0.0);
+}
+
+TEST(PredicateTests, incircleTest)
+{
+	EXPECT_GT(predicates::incircle(0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 0.25, 0.25), 0.0);
+	EXPECT_LT(predicates::incircle(0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 2.0, 2.0), 0.0);
+	EXPECT_EQ(predicates::incircle(0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 1.0, 1.0), 0.0);
+	EXPECT_EQ(predicates::incircle(1e8, 1e8, 1e8 + 1, 1e8, 1e8, 1e8 + 1, 1e8 + 1, 1e8 + 1), 0.0);
+}
+
+TEST(DelaunayTests, randomCloudTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<double> distribution(-100.0, 100.0);
+	std::vector<point> data;
+	for (auto i = 0; i < 500; i++)
+	{
+		data.emplace_back(distribution(generator), distribution(generator));
+	}
+
+	delaunay<point> del(data);
+	auto triangles = del.triangulate();
+	expect_valid_delaunay(del.mesh());
+	EXPECT_EQ(triangles.size(), del.mesh().finite_triangle_count());
+}
+
+TEST(DelaunayTests, visitorTest)
+{
+	using point = point<double>;
+
+	// the visitor sees the triangles triangulate() returns, in the same order.
+	std::mt19937 generator(47);
+	std::uniform_real_distribution<double> distribution(-100.0, 100.0);
+	std::vector<point> data;
+	for (auto i = 0; i < 500; i++)
+	{
+		data.emplace_back(distribution(generator), distribution(generator));
+	}
+
+	delaunay<point> del(data);
+	auto triangles = del.triangulate();
+	std::size_t visited = 0;
+	del.triangulate([&](const delaunay<point>::TriangleType &triangle)
+	{
+		ASSERT_LT(visited, triangles.size());
+		EXPECT_TRUE(triangles[visited] == triangle);
+		visited++;
+	});
+	EXPECT_EQ(visited, triangles.size());
+}
+
+TEST(DelaunayTests, degenerateInputTest)
+{
+	using point = point<double>;
+
+	// cocircular grid points.
+	std::vector<point> grid;
+	for (auto i = 0; i < 20; i++)
+	{
+		for (auto j = 0; j < 20; j++)
+		{
+			grid.emplace_back(i, j);
+		}
+	}
+	delaunay<point> grid_delaunay(grid);
+	EXPECT_EQ(grid_delaunay.triangulate().size(), 2 * 19 * 19);
+	expect_valid_delaunay(grid_delaunay.mesh());
+
+	// collinear points give no triangles.
+	delaunay<point> line({ { 0.0, 0.0 }, { 1.0, 1.0 }, { 2.0, 2.0 }, { 3.0, 3.0 } });
+	EXPECT_TRUE(line.triangulate().empty());
+
+	// duplicates are ignored.
+	delaunay<point> duplicates({ { 0.0, 0.0 }, { 1.0, 0.0 }, { 0.0, 0.0 }, { 0.0, 1.0 }, { 1.0, 0.0 } });
+	EXPECT_EQ(duplicates.triangulate().size(), 1);
+}
+
+TEST(PredicateTests, powerTest)
+{
+	// equal weights reduce to incircle, a heavier query point destroys more.
+	EXPECT_GT(predicates::power_test(0.0, 0.0, 1.0, 1.0, 0.0, 1.0, 0.0, 1.0, 1.0, 0.25, 0.25, 1.0), 0.0);
+	EXPECT_EQ(predicates::power_test(0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 0.0), 0.0);
+	EXPECT_LT(predicates::power_test(0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 2.0, 2.0, 0.0), 0.0);
+	EXPECT_GT(predicates::power_test(0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 2.0, 2.0, 10.0), 0.0);
+
+	// on a line: the midpoint of a unit segment destroys it unless it is lighter by more than 1/4.
+	EXPECT_GT(predicates::power_test(0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.5, 0.0, -0.2), 0.0);
+	EXPECT_EQ(predicates::power_test(0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.5, 0.0, -0.25), 0.0);
+	EXPECT_LT(predicates::power_test(0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.5, 0.0, -0.3), 0.0);
+}
+
+TEST(WeightedTests, regularTriangulationTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(17);
+	std::uniform_real_distribution<double> coordinate(-10.0, 10.0);
+	std::uniform_real_distribution<double> weight(0.0, 4.0);
+	std::vector<point> data;
+	std::vector<double> weights;
+	for (auto i = 0; i < 400; i++)
+	{
+		data.emplace_back(coordinate(generator), coordinate(generator));
+		weights.push_back(weight(generator));
+	}
+	mesh<point> regular(data, weights);
+	regular.triangulate();
+	EXPECT_TRUE(regular.is_weighted());
+
+	// no weighted vertex in use destroys a triangle, and every redundant one lies in a triangle it cannot destroy.
+	const auto &triangles = regular.triangles();
+	std::size_t redundant = 0;
+	for (std::size_t v = 0; v < data.size(); v++)
+	{
+		if (regular.is_inserted(v))
+		{
+			continue;
+		}
+		redundant++;
+		const auto t = regular.locate(data[v]);
+		ASSERT_FALSE(regular.is_ghost(t));
+		EXPECT_LE(predicates::power_test(data[triangles[3 * t]], weights[triangles[3 * t]], data[triangles[3 * t + 1]],
+			weights[triangles[3 * t + 1]], data[triangles[3 * t + 2]], weights[triangles[3 * t + 2]], data[v], weights[v]), 0.0);
+	}
+	EXPECT_GT(redundant, 0);
+	for (std::size_t t = 0; t < regular.triangle_count(); t++)
+	{
+		if (regular.is_ghost(t))
+		{
+			continue;
+		}
+		const auto a = triangles[3 * t], b = triangles[3 * t + 1], c = triangles[3 * t + 2];
+		ASSERT_GT(predicates::orient2d(data[a], data[b], data[c]), 0.0);
+		for (std::size_t v = 0; v < data.size(); v++)
+		{
+			if (regular.is_inserted(v) && v != a && v != b && v != c)
+			{
+				ASSERT_LE(predicates::power_test(data[a], weights[a], data[b], weights[b], data[c], weights[c], data[v], weights[v]), 0.0);
+			}
+		}
+	}
+
+	// a heavier duplicate replaces a vertex, a lighter one is redundant.
+	mesh<point> square({ { 0.0, 0.0 }, { 1.0, 0.0 }, { 1.0, 1.0 }, { 0.0, 1.0 } }, { 0.0, 0.0, 0.0, 0.0 });
+	square.triangulate();
+	const auto heavy = square.add_vertex({ 1.0, 1.0 }, 0.5);
+	EXPECT_EQ(square.insert(heavy), heavy);
+	EXPECT_FALSE(square.is_inserted(2));
+	EXPECT_EQ(square.insert(square.add_vertex({ 0.0, 0.0 }, -0.5)), invalid_index);
+	EXPECT_EQ(square.finite_triangle_count(), 2);
+
+	// a light center is redundant, the hull vertices around it are not.
+	mesh<point> grid{};
+	for (auto i = 0; i < 3; i++)
+	{
+		for (auto j = 0; j < 3; j++)
+		{
+			grid.add_vertex(point(i, j), i == 1 && j == 1 ? -3.0 : 0.0);
+		}
+	}
+	grid.triangulate();
+	EXPECT_EQ(grid.finite_triangle_count(), 6);
+	EXPECT_TRUE(grid.is_inserted(1));
+	EXPECT_FALSE(grid.is_inserted(4));
+	EXPECT_THROW(grid.update_positions({ 1 }, { point(0.1, 1.0) }), std::runtime_error);
+}
+
+TEST(WeightedTests, powerDiagramTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(3);
+	std::uniform_real_distribution<double> coordinate(0.0, 10.0);
+	std::uniform_real_distribution<double> weight(0.0, 1.0);
+	std::vector<point> data;
+	std::vector<double> weights;
+	for (auto i = 0; i < 200; i++)
+	{
+		data.emplace_back(coordinate(generator), coordinate(generator));
+		weights.push_back(weight(generator));
+	}
+	mesh<point> regular(data, weights);
+	regular.triangulate();
+	const auto diagram = extract_power_diagram(regular);
+	ASSERT_EQ(diagram.centers.size(), regular.triangle_count());
+	ASSERT_EQ(diagram.offsets.size(), data.size() + 1);
+
+	auto power = [&](const point &x, const std::size_t &v)
+	{
+		return squared_distance(x, data[v]) - weights[v];
+	};
+	for (std::size_t v = 0; v < data.size(); v++)
+	{
+		const auto size = diagram.offsets[v + 1] - diagram.offsets[v];
+		if (!regular.is_inserted(v))
+		{
+			EXPECT_EQ(size, 0);
+			continue;
+		}
+		ASSERT_GE(size, 3);
+		const auto first = diagram.cells[diagram.offsets[v]];
+		const auto last = diagram.cells[diagram.offsets[v + 1] - 1];
+		EXPECT_EQ(regular.is_ghost(first), regular.is_ghost(last));
+		for (auto i = diagram.offsets[v]; i < diagram.offsets[v + 1]; i++)
+		{
+			const auto t = diagram.cells[i];
+			if (regular.is_ghost(t))
+			{
+				EXPECT_TRUE(i == diagram.offsets[v] || i + 1 == diagram.offsets[v + 1]);
+				continue;
+			}
+			// every corner of a cell is equally close to v and the other vertices of its triangle, and no
+			// vertex in use is closer.
+			const auto &center = diagram.centers[t];
+			for (std::size_t u = 0; u < data.size(); u++)
+			{
+				if (regular.is_inserted(u))
+				{
+					EXPECT_GE(power(center, u), power(center, v) - 1e-9);
+				}
+			}
+		}
+	}
+}
+
+TEST(PeriodicTests, torusTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(8);
+	std::uniform_real_distribution<double> coordinate(-2.0, 12.0);
+	std::vector<point> data;
+	for (auto i = 0; i < 300; i++)
+	{
+		data.emplace_back(coordinate(generator), 0.5 * coordinate(generator));
+	}
+	// a point outside the domain that wraps onto another one is used once.
+	data.emplace_back(data[0].x() + 10.0, data[0].y() - 7.0);
+
+	auto check = [](const std::vector<point> &points, const periodic_triangulation &torus, const double &width,
+		const double &height)
+	{
+		auto corner = [&](const std::size_t &t, const std::size_t &i)
+		{
+			const auto &p = points[torus.triangles[3 * t + i]];
+			auto x = std::fmod(p.x(), width), y = std::fmod(p.y(), height);
+			x = x < 0.0 ? x + width : x;
+			y = y < 0.0 ? y + height : y;
+			return point(x + torus.offsets[6 * t + 2 * i] * width, y + torus.offsets[6 * t + 2 * i + 1] * height);
+		};
+		// the triangles tile the torus and no copy of a point lies inside a circumcircle.
+		auto area = 0.0;
+		for (std::size_t t = 0; t < torus.triangles.size() / 3; t++)
+		{
+			const auto a = corner(t, 0), b = corner(t, 1), c = corner(t, 2);
+			EXPECT_EQ(torus.offsets[6 * t], 0);
+			EXPECT_EQ(torus.offsets[6 * t + 1], 0);
+			ASSERT_GT(predicates::orient2d(a, b, c), 0.0);
+			area += signed_area(a, b, c);
+			for (const auto &p : points)
+			{
+				auto x = std::fmod(p.x(), width), y = std::fmod(p.y(), height);
+				x = x < 0.0 ? x + width : x;
+				y = y < 0.0 ? y + height : y;
+				for (auto i = -2; i <= 2; i++)
+				{
+					for (auto j = -2; j <= 2; j++)
+					{
+						ASSERT_LE(predicates::incircle(a, b, c, point(x + i * width, y + j * height)), 1e-9);
+					}
+				}
+			}
+		}
+		EXPECT_NEAR(area, width * height, 1e-9);
+	};
+
+	const auto torus = periodic_delaunay(data, 0.0, 0.0, 10.0, 7.0);
+	EXPECT_EQ(torus.triangles.size(), 3 * 2 * 300);
+	check(data, torus, 10.0, 7.0);
+	auto wrapping = std::count_if(torus.offsets.begin(), torus.offsets.end(), [](const std::int32_t &offset) { return offset != 0; });
+	EXPECT_GT(wrapping, 0);
+
+	// cocircular grid points, and a single point.
+	std::vector<point> grid;
+	for (auto i = 0; i < 8; i++)
+	{
+		for (auto j = 0; j < 5; j++)
+		{
+			grid.emplace_back(i + 0.5, j);
+		}
+	}
+	const auto grid_torus = periodic_delaunay(grid, 0.0, 0.0, 8.0, 5.0);
+	EXPECT_EQ(grid_torus.triangles.size(), 3 * 2 * 40);
+	check(grid, grid_torus, 8.0, 5.0);
+	const std::vector<point> single{ point(0.3, 0.6) };
+	EXPECT_EQ(periodic_delaunay(single, 0.0, 0.0, 1.0, 1.0).triangles.size(), 3 * 2);
+	EXPECT_THROW(periodic_delaunay(single, 0.0, 0.0, 0.0, 1.0), std::runtime_error);
+}
+
+TEST(GraphTests, uniqueEdgesTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(29);
+	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+	std::vector<point> cloud;
+	for (auto i = 0; i < 300; i++)
+	{
+		cloud.emplace_back(distribution(generator), distribution(generator));
+	}
+	cloud.push_back(cloud[7]);
+	mesh<point> triangulation(cloud);
+	triangulation.triangulate();
+
+	// each undirected edge once: E = V + F - 1 for the finite faces of a triangulated disk.
+	const auto edges = unique_edges(triangulation);
+	const auto inserted = cloud.size() - 1;
+	EXPECT_EQ(edges.size(), inserted + triangulation.finite_triangle_count() - 1);
+	std::set<std::pair<std::size_t, std::size_t>> seen;
+	for (const auto &e : edges)
+	{
+		EXPECT_TRUE(seen.emplace(std::min(e.first, e.second), std::max(e.first, e.second)).second);
+	}
+
+	// the adjacency lists every edge from both ends and leaves the duplicate isolated.
+	const auto graph = adjacency(triangulation);
+	ASSERT_EQ(graph.offsets.size(), cloud.size() + 1);
+	EXPECT_EQ(graph.targets.size(), 2 * edges.size());
+	EXPECT_EQ(graph.offsets[cloud.size()] - graph.offsets[cloud.size() - 1], 0);
+	for (std::size_t v = 0; v < cloud.size(); v++)
+	{
+		for (auto i = graph.offsets[v]; i < graph.offsets[v + 1]; i++)
+		{
+			const auto w = graph.targets[i];
+			EXPECT_EQ(seen.count(std::make_pair(std::min(v, w), std::max(v, w))), 1);
+		}
+	}
+}
+
+TEST(GraphTests, proximityGraphTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(23);
+	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+	std::vector<point> cloud;
+	for (auto i = 0; i < 200; i++)
+	{
+		cloud.emplace_back(distribution(generator), distribution(generator));
+	}
+	mesh<point> triangulation(cloud);
+	triangulation.triangulate();
+
+	using edge_set = std::set<std::pair<std::size_t, std::size_t>>;
+	auto edges = [](const adjacency_graph &graph)
+	{
+		edge_set result;
+		for (std::size_t v = 0; v + 1 < graph.offsets.size(); v++)
+		{
+			for (auto i = graph.offsets[v]; i < graph.offsets[v + 1]; i++)
+			{
+				if (v < graph.targets[i])
+				{
+					result.emplace(v, graph.targets[i]);
+				}
+			}
+		}
+		return result;
+	};
+	const auto tree = edges(minimum_spanning_tree(triangulation));
+	const auto gabriel = edges(gabriel_graph(triangulation));
+	const auto relative = edges(relative_neighborhood_graph(triangulation));
+
+	// brute force definitions, which the tree the long lune searches fall back to agrees with on every pair.
+	auto distance = [&cloud](const std::size_t &a, const std::size_t &b) { return squared_distance(cloud[a], cloud[b]); };
+	const internal::lune_tree<mesh<point>> lunes(triangulation);
+	edge_set expected_gabriel, expected_relative;
+	for (std::size_t a = 0; a < cloud.size(); a++)
+	{
+		for (auto b = a + 1; b < cloud.size(); b++)
+		{
+			auto in_disk = false, in_lune = false;
+			for (std::size_t c = 0; c < cloud.size(); c++)
+			{
+				if (c == a || c == b)
+				{
+					continue;
+				}
+				in_disk = in_disk || distance(a, c) + distance(b, c) <= distance(a, b);
+				in_lune = in_lune || (distance(a, c) < distance(a, b) && distance(b, c) < distance(a, b));
+			}
+			if (!in_disk) expected_gabriel.emplace(a, b);
+			if (!in_lune) expected_relative.emplace(a, b);
+			EXPECT_EQ(lunes.is_empty(a, b), !in_lune);
+		}
+	}
+	EXPECT_EQ(gabriel, expected_gabriel);
+	EXPECT_EQ(relative, expected_relative);
+
+	// the tree spans the points, lies in the relative neighborhood graph and is as short as Prim's.
+	ASSERT_EQ(tree.size(), cloud.size() - 1);
+	EXPECT_TRUE(std::includes(relative.begin(), relative.end(), tree.begin(), tree.end()));
+	auto length = 0.0;
+	for (const auto &e : tree)
+	{
+		length += std::sqrt(distance(e.first, e.second));
+	}
+	std::vector<double> nearest(cloud.size(), std::numeric_limits<double>::infinity());
+	std::vector<bool> reached(cloud.size(), false);
+	nearest[0] = 0.0;
+	auto prim = 0.0;
+	for (std::size_t k = 0; k < cloud.size(); k++)
+	{
+		std::size_t next = 0;
+		while (reached[next]) next++;
+		for (std::size_t v = next; v < cloud.size(); v++)
+		{
+			if (!reached[v] && nearest[v] < nearest[next]) next = v;
+		}
+		reached[next] = true;
+		prim += std::sqrt(nearest[next]);
+		for (std::size_t v = 0; v < cloud.size(); v++)
+		{
+			nearest[v] = std::min(nearest[v], distance(next, v));
+		}
+	}
+	EXPECT_NEAR(length, prim, 1e-9);
+
+	// two rows facing each other: the disks of the edges between them hold a row each, so their lunes are
+	// searched in the tree. A point halfway between the rows blocks some of them.
+	std::vector<point> rows;
+	for (auto i = 0; i < 150; i++)
+	{
+		rows.emplace_back(i, 0.0);
+		rows.emplace_back(i + 0.5, 75.0);
+	}
+	rows.emplace_back(75.0, 37.5);
+	mesh<point> facing(rows);
+	facing.triangulate();
+	edge_set expected_facing;
+	for (std::size_t a = 0; a < rows.size(); a++)
+	{
+		for (auto b = a + 1; b < rows.size(); b++)
+		{
+			const auto length = squared_distance(rows[a], rows[b]);
+			auto in_lune = false;
+			for (std::size_t c = 0; c < rows.size() && !in_lune; c++)
+			{
+				in_lune = c != a && c != b && squared_distance(rows[a], rows[c]) < length && squared_distance(rows[b], rows[c]) < length;
+			}
+			if (!in_lune) expected_facing.emplace(a, b);
+		}
+	}
+	EXPECT_EQ(edges(relative_neighborhood_graph(facing)), expected_facing);
+}
+
+TEST(HullTests, meshHullTest)
+{
+	using point = point<double>;
+
+	// square with an interior point and a point on the bottom edge.
+	delaunay<point> del({ { 0.0, 0.0 }, { 4.0, 0.0 }, { 4.0, 4.0 }, { 0.0, 4.0 }, { 2.0, 2.0 }, { 2.0, 0.0 } });
+	EXPECT_TRUE(del.hull().empty());
+	del.triangulate();
+	auto ring = del.hull();
+	ASSERT_EQ(ring.size(), 5);
+
+	// counter clockwise starting anywhere.
+	auto start = std::find(ring.begin(), ring.end(), std::size_t(0));
+	ASSERT_NE(start, ring.end());
+	std::rotate(ring.begin(), start, ring.end());
+	EXPECT_EQ(ring, std::vector<std::size_t>({ 0, 5, 1, 2, 3 }));
+}
+
+TEST(HullTests, monotoneChainTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(7);
+	std::uniform_real_distribution<double> distribution(-10.0, 10.0);
+	std::vector<point> data;
+	for (auto i = 0; i < 1000; i++)
+	{
+		data.emplace_back(distribution(generator), distribution(generator));
+	}
+
+	// without collinear hull points both hulls agree.
+	auto chain = convex_hull(data);
+	delaunay<point> del(data);
+	del.triangulate();
+	auto ring = del.hull();
+	ASSERT_EQ(chain.size(), ring.size());
+	std::rotate(ring.begin(), std::find(ring.begin(), ring.end(), chain.front()), ring.end());
+	EXPECT_EQ(chain, ring);
+
+	std::vector<point> line({ { 2.0, 2.0 }, { 0.0, 0.0 }, { 1.0, 1.0 }, { 0.0, 0.0 } });
+	EXPECT_EQ(convex_hull(line), std::vector<std::size_t>({ 1, 0 }));
+
+	// a grid whose extreme points repeat, with a duplicated corner: only the corners remain.
+	std::vector<point> grid{};
+	for (auto i = 0; i < 10; i++)
+	{
+		for (auto j = 0; j < 10; j++)
+		{
+			grid.emplace_back(i, j);
+		}
+	}
+	grid.emplace_back(9.0, 9.0);
+	EXPECT_EQ(convex_hull(grid), std::vector<std::size_t>({ 0, 90, 99, 9 }));
+}
+
+TEST(HierarchyTests, locateTest)
+{
+	using point = point<double>;
+
+	// random queries against a triangulation built from random points through the hierarchy.
+	std::mt19937 generator(48);
+	std::uniform_real_distribution<double> distribution(0.0, 100.0);
+	std::vector<point> data{ { 0.0, 0.0 }, { 100.0, 0.0 }, { 100.0, 100.0 }, { 0.0, 100.0 } };
+	for (auto i = 0; i < 2000; i++)
+	{
+		data.emplace_back(distribution(generator), distribution(generator));
+	}
+	mesh<point> built(data);
+	hierarchy_options options{};
+	options.ratio = 8;
+	delaunay_hierarchy<point> hierarchy(built, options);
+	for (std::size_t v = 0; v < data.size(); v++)
+	{
+		EXPECT_EQ(hierarchy.insert(v), v);
+	}
+	expect_valid_delaunay(built);
+	EXPECT_EQ(built.finite_triangle_count(), 2 * data.size() - 2 - 4);
+
+	for (auto i = 0; i < 1000; i++)
+	{
+		const point query(distribution(generator), distribution(generator));
+		const auto t = hierarchy.locate(query);
+		ASSERT_FALSE(built.is_ghost(t));
+		const auto &triangles = built.triangles();
+		EXPECT_GE(predicates::orient2d(data[triangles[3 * t]], data[triangles[3 * t + 1]], query), 0.0);
+		EXPECT_GE(predicates::orient2d(data[triangles[3 * t + 1]], data[triangles[3 * t + 2]], query), 0.0);
+		EXPECT_GE(predicates::orient2d(data[triangles[3 * t + 2]], data[triangles[3 * t]], query), 0.0);
+	}
+
+	// every level holds about an eighth of the one below; a rebuild draws the same levels again.
+	const auto stats = hierarchy.stats();
+	ASSERT_EQ(stats.vertices_per_level.size(), options.max_levels + 1);
+	EXPECT_EQ(stats.vertices_per_level[0], data.size());
+	EXPECT_GT(stats.vertices_per_level[1], data.size() / 16);
+	EXPECT_LT(stats.vertices_per_level[1], data.size() / 4);
+	for (std::size_t k = 1; k < stats.vertices_per_level.size(); k++)
+	{
+		EXPECT_LE(stats.vertices_per_level[k], stats.vertices_per_level[k - 1]);
+	}
+	EXPECT_GT(stats.overhead_bytes, stats.vertices_per_level[1] * sizeof(point));
+	hierarchy.rebuild();
+	EXPECT_GT(hierarchy.stats().vertices_per_level[1], data.size() / 16);
+	EXPECT_THROW(delaunay_hierarchy<point>(built, hierarchy_options{ 1 }), std::runtime_error);
+}
+
+TEST(AlphaShapeTests, holeTest)
+{
+	using point = point<double>;
+
+	// a 20 x 20 grid with a 6 x 6 block of points taken out of the middle.
+	std::vector<point> grid;
+	for (auto i = 0; i < 20; i++)
+	{
+		for (auto j = 0; j < 20; j++)
+		{
+			if (i < 7 || i > 12 || j < 7 || j > 12)
+			{
+				grid.emplace_back(i + 1e-3 * j, j + 1e-3 * i);
+			}
+		}
+	}
+	mesh<point> cloud(grid);
+	cloud.triangulate();
+
+	auto area = [&grid](const std::vector<std::size_t> &loop)
+	{
+		auto sum = 0.0;
+		for (std::size_t i = 0; i < loop.size(); i++)
+		{
+			const auto &a = grid[loop[i]];
+			const auto &b = grid[loop[(i + 1) % loop.size()]];
+			sum += a.x() * b.y() - a.y() * b.x();
+		}
+		return 0.5 * sum;
+	};
+
+	// grid cells have a circumradius of about 0.71, so an alpha of 0.75 keeps the cells and opens the hole. The
+	// hole's corner cells are cut along a diagonal.
+	auto loops = alpha_shape(cloud, 0.75);
+	ASSERT_EQ(loops.size(), 2);
+	std::sort(loops.begin(), loops.end(), [](const std::vector<std::size_t> &a, const std::vector<std::size_t> &b) { return a.size() > b.size(); });
+	EXPECT_EQ(loops[0].size(), 76);
+	EXPECT_EQ(loops[1].size(), 24);
+	EXPECT_NEAR(area(loops[0]), 361.0, 1.0);
+	EXPECT_NEAR(area(loops[1]), -47.0, 1.0);
+
+	// an infinite alpha gives the convex hull, a tiny one nothing.
+	auto hull = alpha_shape(cloud, std::numeric_limits<double>::infinity());
+	auto ring = cloud.hull();
+	ASSERT_EQ(hull.size(), 1);
+	EXPECT_EQ(std::set<std::size_t>(hull[0].begin(), hull[0].end()), std::set<std::size_t>(ring.begin(), ring.end()));
+	EXPECT_TRUE(alpha_shape(cloud, 0.1).empty());
+
+	// the spectrum answers the same queries.
+	alpha_spectrum<point> spectrum(cloud);
+	EXPECT_EQ(spectrum.critical_values().size(), cloud.finite_triangle_count());
+	EXPECT_EQ(spectrum.triangle_count(std::numeric_limits<double>::infinity()), cloud.finite_triangle_count());
+	for (const auto &alpha : { 0.1, 0.75, 2.0, 5.0, 100.0 })
+	{
+		auto expected = alpha_shape(cloud, alpha);
+		auto actual = spectrum.boundary(alpha);
+		std::sort(expected.begin(), expected.end());
+		std::sort(actual.begin(), actual.end());
+		EXPECT_EQ(actual, expected);
+	}
+}
+
+TEST(SpatialIndexTests, rangeQueryTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(31);
+	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+	std::vector<point> cloud;
+	for (auto i = 0; i < 2000; i++)
+	{
+		cloud.emplace_back(distribution(generator), distribution(generator));
+	}
+	mesh<point> triangulation(cloud);
+	triangulation.triangulate();
+	triangle_index<point> index(triangulation);
+	ASSERT_EQ(index.size(), triangulation.finite_triangle_count());
+
+	std::vector<std::size_t> result;
+	index.query(-1.0, -1.0, 2.0, 2.0, result);
+	EXPECT_EQ(result.size(), triangulation.finite_triangle_count());
+	index.query(3.0, 3.0, 4.0, 4.0, result);
+	EXPECT_TRUE(result.empty());
+
+	// a zero radius at a vertex finds exactly the triangles around it, and a tiny box inside a triangle only it.
+	for (const auto &vertex : { std::size_t(5), std::size_t(500), std::size_t(1999) })
+	{
+		std::set<std::size_t> star;
+		for (std::size_t t = 0; t < triangulation.triangle_count(); t++)
+		{
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				if (!triangulation.is_ghost(t) && triangulation.triangles()[3 * t + i] == vertex) star.insert(t);
+			}
+		}
+		index.query_radius(cloud[vertex].x(), cloud[vertex].y(), 0.0, result);
+		EXPECT_EQ(std::set<std::size_t>(result.begin(), result.end()), star);
+
+		const auto t = *star.begin();
+		const auto &a = cloud[triangulation.triangles()[3 * t]];
+		const auto &b = cloud[triangulation.triangles()[3 * t + 1]];
+		const auto &c = cloud[triangulation.triangles()[3 * t + 2]];
+		const auto x = (a.x() + b.x() + c.x()) / 3.0, y = (a.y() + b.y() + c.y()) / 3.0;
+		index.query(x - 1e-9, y - 1e-9, x + 1e-9, y + 1e-9, result);
+		EXPECT_EQ(result, std::vector<std::size_t>{ t });
+	}
+
+	// every triangle whose box overlaps a window is either reported or separated from it by one of its edges.
+	index.query(0.3, 0.4, 0.45, 0.5, result);
+	const std::set<std::size_t> found(result.begin(), result.end());
+	for (std::size_t t = 0; t < triangulation.triangle_count(); t++)
+	{
+		if (triangulation.is_ghost(t)) continue;
+		auto overlaps = true;
+		for (std::size_t i = 0; i < 3; i++)
+		{
+			const auto &a = cloud[triangulation.triangles()[3 * t + i]];
+			const auto &b = cloud[triangulation.triangles()[3 * t + (i + 1) % 3]];
+			auto any_left = false;
+			for (const auto &corner : { point(0.3, 0.4), point(0.45, 0.4), point(0.3, 0.5), point(0.45, 0.5) })
+			{
+				any_left = any_left || predicates::orient2d(a, b, corner) >= 0.0;
+			}
+			overlaps = overlaps && any_left;
+		}
+		const auto &a = cloud[triangulation.triangles()[3 * t]];
+		const auto &b = cloud[triangulation.triangles()[3 * t + 1]];
+		const auto &c = cloud[triangulation.triangles()[3 * t + 2]];
+		overlaps = overlaps && std::max({ a.x(), b.x(), c.x() }) >= 0.3 && std::min({ a.x(), b.x(), c.x() }) <= 0.45 &&
+			std::max({ a.y(), b.y(), c.y() }) >= 0.4 && std::min({ a.y(), b.y(), c.y() }) <= 0.5;
+		EXPECT_EQ(found.count(t), overlaps ? 1 : 0);
+	}
+}
+
+TEST(RefineTests, minimumAngleTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(3);
+	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+	std::vector<point> data;
+	for (auto i = 0; i < 300; i++)
+	{
+		data.emplace_back(distribution(generator), distribution(generator));
+	}
+	delaunay<point> del(data);
+	del.triangulate();
+	auto hull = del.hull();
+
+	refinement_options options;
+	options.min_angle = 25.0;
+	EXPECT_GT(refine(del.mesh(), options), 0);
+	const auto &mesh = del.mesh();
+	expect_valid_delaunay(mesh);
+
+	// the hull is only subdivided.
+	EXPECT_EQ(convex_hull(mesh.vertices()).size(), hull.size());
+
+	const auto &triangles = mesh.triangles();
+	for (std::size_t t = 0; t < mesh.triangle_count(); t++)
+	{
+		if (mesh.is_ghost(t))
+		{
+			continue;
+		}
+		for (std::size_t i = 0; i < 3; i++)
+		{
+			const auto &a = mesh.vertex(triangles[3 * t + i]);
+			const auto &b = mesh.vertex(triangles[3 * t + (i + 1) % 3]);
+			const auto &c = mesh.vertex(triangles[3 * t + (i + 2) % 3]);
+			auto ux = b.x() - a.x(), uy = b.y() - a.y(), vx = c.x() - a.x(), vy = c.y() - a.y();
+			auto angle = std::atan2(ux * vy - uy * vx, ux * vx + uy * vy) * 180.0 / 3.14159265358979323846;
+			EXPECT_GE(angle, 25.0 - 1e-9);
+		}
+	}
+}
+
+TEST(RefineTests, maximumAreaTest)
+{
+	using point = point<double>;
+
+	delaunay<point> del({ { 0.0, 0.0 }, { 10.0, 0.0 }, { 10.0, 10.0 }, { 0.0, 10.0 } });
+	del.triangulate();
+
+	refinement_options options;
+	options.min_angle = 0.0;
+	options.max_area = 1.0;
+	refine(del.mesh(), options);
+	const auto &mesh = del.mesh();
+	expect_valid_delaunay(mesh);
+
+	auto total = 0.0;
+	const auto &triangles = mesh.triangles();
+	for (std::size_t t = 0; t < mesh.triangle_count(); t++)
+	{
+		if (!mesh.is_ghost(t))
+		{
+			auto area = signed_area(mesh.vertex(triangles[3 * t]), mesh.vertex(triangles[3 * t + 1]), mesh.vertex(triangles[3 * t + 2]));
+			EXPECT_LE(area, 1.0);
+			total += area;
+		}
+	}
+	EXPECT_NEAR(total, 100.0, 1e-9);
+
+	// the budget stops the refinement.
+	delaunay<point> limited({ { 0.0, 0.0 }, { 10.0, 0.0 }, { 10.0, 10.0 }, { 0.0, 10.0 } });
+	limited.triangulate();
+	options.max_steiner_points = 5;
+	EXPECT_EQ(refine(limited.mesh(), options), 5);
+	EXPECT_EQ(limited.mesh().vertex_count(), 9);
+
+	// Steiner points would neither carry a weight nor respect a constrained edge.
+	delaunaypp::mesh<point> weighted({ { 0.0, 0.0 }, { 10.0, 0.0 }, { 10.0, 10.0 }, { 0.0, 10.0 } }, { 0.0, 0.0, 0.0, 0.0 });
+	weighted.triangulate();
+	EXPECT_THROW(refine(weighted, options), std::runtime_error);
+	delaunaypp::mesh<point> constrained({ { 0.0, 0.0 }, { 10.0, 0.0 }, { 10.0, 10.0 }, { 0.0, 10.0 } });
+	constrained.triangulate();
+	EXPECT_FALSE(constrained.is_constrained());
+	constrained.constrain(0, 2);
+	EXPECT_TRUE(constrained.is_constrained());
+	EXPECT_THROW(refine(constrained, options), std::runtime_error);
+	EXPECT_EQ(constrained.vertex_count(), 4);
+}
+
+TEST(KineticTests, updatePositionsTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(17);
+	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+	std::vector<point> data;
+	for (auto i = 0; i < 400; i++)
+	{
+		data.emplace_back(distribution(generator), distribution(generator));
+	}
+	mesh<point> kinetic(data);
+	kinetic.triangulate();
+
+	// small steps are handled by flips, large ones make vertices leave their stars and the hull change.
+	for (auto step : { 1e-4, 1e-2, 0.2 })
+	{
+		std::normal_distribution<double> noise(0.0, step);
+		for (auto frame = 0; frame < 5; frame++)
+		{
+			for (auto &p : data)
+			{
+				p = point(p.x() + noise(generator), p.y() + noise(generator));
+			}
+			kinetic.update_positions(data);
+			expect_valid_delaunay(kinetic);
+
+			mesh<point> reference(data);
+			reference.triangulate();
+			EXPECT_EQ(kinetic.finite_triangle_count(), reference.finite_triangle_count());
+			EXPECT_EQ(kinetic.hull().size(), reference.hull().size());
+			for (std::size_t v = 0; v < kinetic.vertex_count(); v++)
+			{
+				EXPECT_TRUE(kinetic.is_inserted(v));
+			}
+		}
+	}
+}
+
+TEST(KineticTests, sparseUpdateTest)
+{
+	using point = point<double>;
+
+	std::vector<point> grid;
+	for (auto i = 0; i < 10; i++)
+	{
+		for (auto j = 0; j < 10; j++)
+		{
+			grid.emplace_back(i + 0.01 * j, j + 0.01 * i * i);
+		}
+	}
+	mesh<point> kinetic(grid);
+	kinetic.triangulate();
+
+	// nothing moves, then one vertex moves a little and one jumps across the mesh.
+	EXPECT_EQ(kinetic.update_positions(grid), 0);
+	EXPECT_GT(kinetic.update_positions({ 55 }, { point(5.3, 5.4) }), 0);
+	expect_valid_delaunay(kinetic);
+	EXPECT_GT(kinetic.update_positions({ 11 }, { point(7.5, 2.5) }), 0);
+	expect_valid_delaunay(kinetic);
+	EXPECT_EQ(kinetic.finite_triangle_count(), 2 * 100 - kinetic.hull().size() - 2);
+
+	EXPECT_THROW(kinetic.update_positions({ point(0.0, 0.0) }), std::runtime_error);
+
+	// an erased vertex stays out when the mesh has to start over.
+	mesh<point> erased({ { 0.0, 0.0 }, { 1.0, 0.0 }, { 2.0, 0.0 }, { 0.0, 1.0 } });
+	erased.triangulate();
+	erased.erase({ 3 });
+	erased.update_positions({ 0 }, { point(0.5, 1.0) });
+	EXPECT_FALSE(erased.is_inserted(3));
+	EXPECT_EQ(erased.finite_triangle_count(), 1);
+}
+
+TEST(KineticTests, slidingWindowTest)
+{
+	using point = point<double>;
+
+	std::size_t inserted = 0;
+	std::size_t evicted = 0;
+	sliding_window<point> window(1.0, [&](const window_metrics &metrics)
+	{
+		inserted += metrics.inserted;
+		evicted += metrics.evicted;
+		EXPECT_GE(metrics.insert_seconds, 0.0);
+		EXPECT_EQ(metrics.eviction_backlog, 0);
+		EXPECT_EQ(metrics.insertion_backlog, 0);
+	});
+
+	// points on a coarse grid repeat positions and are cocircular.
+	std::mt19937 generator(21);
+	std::uniform_int_distribution<int> coordinate(0, 40);
+	std::size_t pushed = 0;
+	for (auto tick = 1; tick <= 100; tick++)
+	{
+		for (auto i = 0; i < 15; i++)
+		{
+			window.push(point(coordinate(generator) * 0.25, coordinate(generator) * 0.25), tick * 0.05 + i * 0.001);
+			pushed++;
+		}
+		const auto now = tick * 0.05 + 0.02;
+		const auto metrics = window.advance(now);
+		EXPECT_EQ(metrics.size, window.size());
+		EXPECT_EQ(window.size(), std::min<std::size_t>(pushed, 20 * 15));
+		if (tick % 25 != 0)
+		{
+			continue;
+		}
+
+		// the mesh is the Delaunay triangulation of the distinct live positions.
+		const auto &mesh = window.mesh();
+		expect_valid_delaunay(mesh);
+		std::set<std::pair<double, double>> positions{};
+		std::vector<point> live{};
+		for (std::size_t v = 0; v < mesh.vertex_count(); v++)
+		{
+			if (mesh.is_inserted(v))
+			{
+				EXPECT_GT(window.timestamp(v), now - 1.0);
+				EXPECT_TRUE(positions.emplace(mesh.vertex(v).x(), mesh.vertex(v).y()).second);
+				live.push_back(mesh.vertex(v));
+			}
+		}
+		delaunay<point> fresh(live);
+		EXPECT_EQ(fresh.triangulate().size(), mesh.finite_triangle_count());
+	}
+	EXPECT_EQ(inserted, pushed);
+	EXPECT_EQ(evicted, pushed - window.size());
+	EXPECT_LE(window.mesh().vertex_count(), 20 * 15 + 15);
+	EXPECT_THROW(window.push(point(0.0, 0.0), 0.0), std::runtime_error);
+
+	// a position repeated before the first triangle exists shares its vertex too, and outlives the first copy.
+	sliding_window<point> early(10.0);
+	for (const auto &p : { point(0.0, 0.0), point(1.0, 0.0), point(0.0, 1.0) })
+	{
+		early.push(p, 0.0);
+	}
+	for (const auto &p : { point(0.0, 0.0), point(1.0, 1.0), point(2.0, 0.0) })
+	{
+		early.push(p, 1.0);
+	}
+	early.advance(1.0);
+	early.advance(10.5);
+	EXPECT_EQ(early.size(), 3);
+	ASSERT_EQ(early.mesh().finite_triangle_count(), 1);
+	std::set<point> corners{};
+	for (std::size_t v = 0; v < early.mesh().vertex_count(); v++)
+	{
+		if (early.mesh().is_inserted(v))
+		{
+			corners.insert(early.mesh().vertex(v));
+		}
+	}
+	EXPECT_EQ(corners, (std::set<point>{ point(0.0, 0.0), point(1.0, 1.0), point(2.0, 0.0) }));
+
+	// a burst is spread over the next ticks by the limits, oldest first.
+	window_options options;
+	options.max_evictions = 7;
+	options.max_insertions = 10;
+	sliding_window<point> limited(1.0, sliding_window<point>::metrics_sink(), options);
+	std::uniform_real_distribution<double> spread(0.0, 10.0);
+	for (auto i = 0; i < 30; i++)
+	{
+		limited.push(point(spread(generator), spread(generator)), 0.0);
+	}
+	for (std::size_t tick = 0; tick < 3; tick++)
+	{
+		const auto metrics = limited.advance(tick * 0.1);
+		EXPECT_EQ(metrics.inserted, 10);
+		EXPECT_EQ(metrics.insertion_backlog, 20 - 10 * tick);
+		EXPECT_EQ(metrics.eviction_backlog, 0);
+		EXPECT_EQ(metrics.size, 10 * (tick + 1));
+	}
+	expect_valid_delaunay(limited.mesh());
+	EXPECT_EQ(limited.mesh().finite_triangle_count(), delaunay<point>(limited.mesh().vertices()).triangulate().size());
+	for (const std::size_t backlog : { 23, 16, 9, 2, 0 })
+	{
+		const auto before = limited.size();
+		const auto metrics = limited.advance(1.5);
+		EXPECT_EQ(metrics.evicted, before - backlog);
+		EXPECT_EQ(metrics.eviction_backlog, backlog);
+		EXPECT_EQ(metrics.size, backlog);
+	}
+	EXPECT_EQ(limited.mesh().finite_triangle_count(), 0);
+
+	// pushed points that expire while waiting never reach the mesh.
+	for (auto i = 0; i < 20; i++)
+	{
+		limited.push(point(spread(generator), spread(generator)), 2.0);
+	}
+	EXPECT_EQ(limited.advance(2.0).insertion_backlog, 10);
+	const auto late = limited.advance(3.5);
+	EXPECT_EQ(late.inserted, 0);
+	EXPECT_EQ(late.insertion_backlog, 0);
+	EXPECT_EQ(late.evicted, 7);
+	EXPECT_EQ(late.eviction_backlog, 3);
+	EXPECT_THROW(sliding_window<point>(1.0, sliding_window<point>::metrics_sink(), window_options{ 0, 1 }), std::runtime_error);
+
+	// erasing the center of a square leaves a star that covers the whole mesh, which is triangulated again.
+	sliding_window<point> square(10.0);
+	square.push(point(1.0, 1.0), 0.0);
+	for (const auto &p : { point(0.0, 0.0), point(2.0, 0.0), point(2.0, 2.0), point(0.0, 2.0) })
+	{
+		square.push(p, 1.0);
+	}
+	EXPECT_FALSE(square.advance(1.0).rebuilt);
+	EXPECT_EQ(square.mesh().finite_triangle_count(), 4);
+	const auto center = square.advance(10.5);
+	EXPECT_EQ(center.evicted, 1);
+	EXPECT_TRUE(center.rebuilt);
+	EXPECT_EQ(square.mesh().finite_triangle_count(), 2);
+	expect_valid_delaunay(square.mesh());
+}
+
+TEST(BatchTests, matchesSingleTriangulationTest)
+{
+	using point = point<double>;
+
+	// sets of a few to a few hundred points, including empty and degenerate ones.
+	std::mt19937 generator(43);
+	std::uniform_int_distribution<int> size(0, 300);
+	std::uniform_real_distribution<double> coordinate(-10.0, 10.0);
+	std::vector<point> points{};
+	std::vector<std::size_t> offsets{ 0 };
+	for (auto s = 0; s < 400; s++)
+	{
+		const auto count = s % 50 == 0 ? s % 3 : size(generator);
+		for (auto i = 0; i < count; i++)
+		{
+			points.emplace_back(coordinate(generator), coordinate(generator));
+		}
+		offsets.push_back(points.size());
+	}
+
+	batch_options options{};
+	options.threads = 4;
+	options.chunk_points = 1000;
+	const auto batch = triangulate_batch(points, offsets, options);
+	ASSERT_EQ(batch.offsets.size(), offsets.size());
+	EXPECT_EQ(batch.triangles.size(), 3 * batch.offsets.back());
+	for (std::size_t s = 0; s + 1 < offsets.size(); s++)
+	{
+		mesh<point> single(std::vector<point>(points.begin() + offsets[s], points.begin() + offsets[s + 1]));
+		single.triangulate();
+		ASSERT_EQ(batch.offsets[s + 1] - batch.offsets[s], single.finite_triangle_count());
+		std::size_t t = 3 * batch.offsets[s];
+		for (std::size_t k = 0; k < single.triangle_count(); k++)
+		{
+			if (single.is_ghost(k))
+			{
+				continue;
+			}
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				EXPECT_EQ(batch.triangles[t++], offsets[s] + single.triangles()[3 * k + i]);
+			}
+		}
+	}
+
+	EXPECT_THROW(triangulate_batch(points, std::vector<std::size_t>{ 0, 5, 3 }), std::runtime_error);
+	EXPECT_THROW(triangulate_batch(points, std::vector<std::size_t>{ 0, points.size() + 1 }), std::runtime_error);
+}
+
+template<typename MeshType>
+void expect_constrained_delaunay(const MeshType &mesh)
+{
+	const auto &triangles = mesh.triangles();
+	const auto &halfedges = mesh.halfedges();
+	for (std::size_t e = 0; e < halfedges.size(); e++)
+	{
+		ASSERT_EQ(halfedges[halfedges[e]], e);
+		ASSERT_EQ(triangles[halfedges[e]], triangles[MeshType::next(e)]);
+		if (mesh.is_ghost(e / 3) || mesh.is_ghost(halfedges[e] / 3))
+		{
+			continue;
+		}
+		const auto &a = mesh.vertex(triangles[e]);
+		const auto &b = mesh.vertex(triangles[MeshType::next(e)]);
+		const auto &c = mesh.vertex(triangles[MeshType::prev(e)]);
+		ASSERT_GT(predicates::orient2d(a, b, c), 0.0);
+		if (!mesh.is_constrained(e))
+		{
+			ASSERT_LE(predicates::incircle(a, b, c, mesh.vertex(triangles[MeshType::prev(halfedges[e])])), 0.0);
+		}
+	}
+}
+
+TEST(PolygonTests, constrainTest)
+{
+	using point = point<double>;
+
+	// long horizontal segments through a random cloud; the one at y = 5 passes through a vertex.
+	std::vector<point> points{};
+	for (auto i = 0; i < 5; i++)
+	{
+		points.emplace_back(0.5, 1.0 + 2.0 * i);
+		points.emplace_back(9.5, 1.0 + 2.0 * i);
+	}
+	points.emplace_back(5.0, 5.0);
+	points.emplace_back(6.0, 0.2);
+	points.emplace_back(6.0, 1.8);
+	std::mt19937 generator(44);
+	std::uniform_real_distribution<double> coordinate(0.0, 10.0);
+	for (auto i = 0; i < 400; i++)
+	{
+		points.emplace_back(coordinate(generator), coordinate(generator));
+	}
+	mesh<point> mesh(points);
+	mesh.triangulate();
+	for (std::size_t i = 0; i < 5; i++)
+	{
+		mesh.constrain(2 * i, 2 * i + 1);
+	}
+	expect_constrained_delaunay(mesh);
+
+	// every segment is a chain of constrained edges from its start to its end.
+	auto chain_length = [&](const std::size_t &start, const std::size_t &end)
+	{
+		std::size_t length = 0;
+		auto current = start;
+		auto previous = invalid_index;
+		while (current != end && current != invalid_index)
+		{
+			auto e = mesh.vertex_edge(current);
+			auto found = invalid_index;
+			do
+			{
+				const auto other = mesh.origin(decltype(mesh)::next(e));
+				if (other != previous && other != infinite_vertex && mesh.is_constrained(e))
+				{
+					found = other;
+				}
+				e = mesh.twin(decltype(mesh)::prev(e));
+			} while (e != mesh.vertex_edge(current));
+			previous = current;
+			current = found;
+			length++;
+		}
+		return current == end ? length : 0;
+	};
+	EXPECT_EQ(chain_length(0, 1), 1);
+	EXPECT_EQ(chain_length(4, 5), 2);
+
+	// a vertex inserted on a segment splits it; one erased from it leaves a gap.
+	const auto on_segment = mesh.add_vertex(point(2.0, 1.0));
+	mesh.insert(on_segment);
+	expect_constrained_delaunay(mesh);
+	EXPECT_EQ(chain_length(0, 1), 2);
+	const auto off_segment = mesh.add_vertex(point(3.0, 1.5));
+	mesh.insert(off_segment);
+	expect_constrained_delaunay(mesh);
+	EXPECT_EQ(chain_length(0, 1), 2);
+	mesh.erase({ 10 });
+	expect_constrained_delaunay(mesh);
+	EXPECT_EQ(chain_length(4, 5), 0);
+
+	// a segment across a constrained one is rejected.
+	EXPECT_THROW(mesh.constrain(11, 12), std::runtime_error);
+}
+
+TEST(PolygonTests, holesTest)
+{
+	using point = point<double>;
+
+	// a square with subdivided sides, a square hole given clockwise and an island inside the hole.
+	std::vector<point> outer{};
+	for (auto i = 0; i < 10; i++) outer.emplace_back(i, 0.0);
+	for (auto i = 0; i < 10; i++) outer.emplace_back(10.0, i);
+	for (auto i = 0; i < 10; i++) outer.emplace_back(10.0 - i, 10.0);
+	for (auto i = 0; i < 10; i++) outer.emplace_back(0.0, 10.0 - i);
+	std::vector<std::vector<point>> holes{
+		{ { 3.0, 3.0 }, { 3.0, 7.0 }, { 7.0, 7.0 }, { 7.0, 3.0 } },
+		{ { 4.5, 4.5 }, { 5.5, 4.5 }, { 5.5, 5.5 }, { 4.5, 5.5 } } };
+	auto triangles = triangulate_polygon(outer, holes);
+
+	std::vector<point> points(outer);
+	points.insert(points.end(), holes[0].begin(), holes[0].end());
+	points.insert(points.end(), holes[1].begin(), holes[1].end());
+	auto area = 0.0;
+	for (std::size_t t = 0; t < triangles.size() / 3; t++)
+	{
+		const auto &a = points[triangles[3 * t]];
+		const auto &b = points[triangles[3 * t + 1]];
+		const auto &c = points[triangles[3 * t + 2]];
+		ASSERT_GT(predicates::orient2d(a, b, c), 0.0);
+		area += 0.5 * predicates::orient2d(a, b, c);
+		const auto x = (a.x() + b.x() + c.x()) / 3.0;
+		const auto y = (a.y() + b.y() + c.y()) / 3.0;
+		const auto in_hole = x > 3.0 && x < 7.0 && y > 3.0 && y < 7.0;
+		const auto in_island = x > 4.5 && x < 5.5 && y > 4.5 && y < 5.5;
+		EXPECT_TRUE(!in_hole || in_island);
+	}
+	EXPECT_DOUBLE_EQ(area, 100.0 - 16.0 + 1.0);
+	// n + 2h - 2 triangles for the square with its hole, two for the island.
+	EXPECT_EQ(triangles.size() / 3, 44 + 2 - 2 + 2);
+
+	EXPECT_THROW(triangulate_polygon(std::vector<point>{ { 0.0, 0.0 }, { 1.0, 1.0 } }), std::runtime_error);
+}
+
+TEST(PolygonTests, largeRingTest)
+{
+	using point = point<double>;
+
+	// a wavy ring of 100k vertices around a round hole.
+	const std::size_t count = 100000;
+	std::vector<point> outer{};
+	for (std::size_t i = 0; i < count; i++)
+	{
+		const auto angle = 2.0 * 3.14159265358979323846 * i / count;
+		const auto radius = 1.0 + 0.3 * std::sin(40.0 * angle);
+		outer.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+	}
+	std::vector<point> hole{};
+	for (std::size_t i = 0; i < 1000; i++)
+	{
+		const auto angle = 2.0 * 3.14159265358979323846 * i / 1000;
+		hole.emplace_back(0.3 * std::cos(angle), 0.3 * std::sin(angle));
+	}
+	auto triangles = triangulate_polygon(outer, { hole });
+	EXPECT_EQ(triangles.size() / 3, count + 1000);
+
+	auto ring_area = [](const std::vector<point> &ring)
+	{
+		auto area = 0.0;
+		for (std::size_t i = 0; i < ring.size(); i++)
+		{
+			const auto &a = ring[i];
+			const auto &b = ring[(i + 1) % ring.size()];
+			area += 0.5 * (a.x() * b.y() - b.x() * a.y());
+		}
+		return area;
+	};
+	std::vector<point> points(outer);
+	points.insert(points.end(), hole.begin(), hole.end());
+	auto area = 0.0;
+	for (std::size_t t = 0; t < triangles.size() / 3; t++)
+	{
+		area += 0.5 * predicates::orient2d(points[triangles[3 * t]], points[triangles[3 * t + 1]], points[triangles[3 * t + 2]]);
+	}
+	EXPECT_NEAR(area, ring_area(outer) - ring_area(hole), 1e-9);
+}
+
+TEST(InterpolationTests, linearFieldTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(11);
+	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+	std::vector<point> cloud{ { 0.0, 0.0 }, { 1.0, 0.0 }, { 1.0, 1.0 }, { 0.0, 1.0 } };
+	for (auto i = 0; i < 500; i++)
+	{
+		cloud.emplace_back(distribution(generator), distribution(generator));
+	}
+	std::vector<double> values;
+	for (const auto &p : cloud)
+	{
+		values.push_back(2.0 * p.x() - 3.0 * p.y() + 1.0);
+	}
+	mesh<point> field(cloud);
+	field.triangulate();
+
+	// a linear field is reproduced exactly, and queries off the hull get the outside value.
+	std::vector<point> queries;
+	for (auto i = 0; i < 1000; i++)
+	{
+		queries.emplace_back(distribution(generator), distribution(generator));
+	}
+	queries.emplace_back(1.5, 0.5);
+	std::vector<double> interpolated(queries.size());
+	interpolate_linear(field, values, queries, interpolated.data());
+	for (std::size_t i = 0; i + 1 < queries.size(); i++)
+	{
+		EXPECT_NEAR(interpolated[i], 2.0 * queries[i].x() - 3.0 * queries[i].y() + 1.0, 1e-12);
+	}
+	EXPECT_TRUE(std::isnan(interpolated.back()));
+
+	// a grid from -0.25 to 1.25 covers the hull with a border of outside nodes.
+	const std::size_t columns = 61, rows = 61;
+	const auto spacing = 1.5 / (columns - 1);
+	std::vector<double> raster(columns * rows);
+	rasterize_linear(field, values, -0.25, -0.25, spacing, columns, rows, raster.data());
+	for (std::size_t row = 0; row < rows; row++)
+	{
+		for (std::size_t column = 0; column < columns; column++)
+		{
+			const auto x = -0.25 + column * spacing, y = -0.25 + row * spacing;
+			const auto value = raster[row * columns + column];
+			if (x < -1e-12 || x > 1.0 + 1e-12 || y < -1e-12 || y > 1.0 + 1e-12)
+			{
+				EXPECT_TRUE(std::isnan(value));
+			}
+			else
+			{
+				EXPECT_NEAR(value, 2.0 * x - 3.0 * y + 1.0, 1e-12);
+			}
+		}
+	}
+
+	EXPECT_THROW(interpolate_linear(field, std::vector<double>(3), queries, interpolated.data()), std::runtime_error);
+
+	// integer values, such as a 16 bit DEM, need a finite value outside the hull.
+	std::vector<std::int16_t> heights(values.size());
+	std::transform(values.begin(), values.end(), heights.begin(), [](const double &value) { return static_cast<std::int16_t>(100.0 * value); });
+	std::vector<std::int16_t> dem(columns * rows);
+	EXPECT_THROW(rasterize_linear(field, heights, -0.25, -0.25, spacing, columns, rows, dem.data()), std::runtime_error);
+	interpolation_options no_data{};
+	no_data.outside = -32768.0;
+	rasterize_linear(field, heights, -0.25, -0.25, spacing, columns, rows, dem.data(), no_data);
+	EXPECT_EQ(dem.front(), -32768);
+}
+
+TEST(InterpolationTests, threadedTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(5);
+	std::uniform_real_distribution<double> distribution(0.0, 10.0);
+	std::vector<point> cloud;
+	std::vector<float> values;
+	for (auto i = 0; i < 300; i++)
+	{
+		cloud.emplace_back(distribution(generator), distribution(generator));
+		values.push_back(static_cast<float>(std::sin(cloud.back().x()) * cloud.back().y()));
+	}
+	mesh<point> field(cloud);
+	field.triangulate();
+
+	// splitting the work over threads must not change a single value.
+	interpolation_options serial, threaded;
+	threaded.threads = 3;
+	threaded.parallel_threshold = 16;
+	std::vector<float> serial_raster(40 * 30), threaded_raster(40 * 30);
+	rasterize_linear(field, values, 0.0, 0.0, 0.25, 40, 30, serial_raster.data(), serial);
+	rasterize_linear(field, values, 0.0, 0.0, 0.25, 40, 30, threaded_raster.data(), threaded);
+	for (std::size_t i = 0; i < serial_raster.size(); i++)
+	{
+		EXPECT_TRUE(serial_raster[i] == threaded_raster[i] || (std::isnan(serial_raster[i]) && std::isnan(threaded_raster[i])));
+	}
+
+	std::vector<float> serial_values(cloud.size()), threaded_values(cloud.size());
+	interpolate_linear(field, values, cloud, serial_values.data(), serial);
+	interpolate_linear(field, values, cloud, threaded_values.data(), threaded);
+	for (std::size_t i = 0; i < cloud.size(); i++)
+	{
+		EXPECT_NEAR(serial_values[i], values[i], 1e-5);
+		EXPECT_EQ(serial_values[i], threaded_values[i]);
+	}
+}
+
+TEST(InterpolationTests, naturalNeighborTest)
+{
+	using point = point<double>;
+
+	std::vector<point> grid;
+	std::vector<double> values;
+	for (auto i = 0; i < 10; i++)
+	{
+		for (auto j = 0; j < 10; j++)
+		{
+			grid.emplace_back(i, j);
+			values.push_back(i * j);
+		}
+	}
+	mesh<point> field(grid);
+	field.triangulate();
+
+	// in a square cell the four corners share the query's Voronoi cell equally, where linear interpolation would
+	// depend on the diagonal.
+	natural_neighbor_scratch scratch;
+	EXPECT_NEAR(interpolate_natural(field, values, point(0.5, 0.5), scratch), 0.25, 1e-12);
+	EXPECT_NEAR(interpolate_natural(field, values, point(3.5, 4.5), scratch), 15.75, 1e-12);
+	EXPECT_DOUBLE_EQ(interpolate_natural(field, values, point(4.0, 7.0), scratch), 28.0);
+	EXPECT_NEAR(interpolate_natural(field, values, point(9.0, 4.5), scratch), 40.5, 1e-12);
+	EXPECT_TRUE(std::isnan(interpolate_natural(field, values, point(9.5, 4.5), scratch)));
+
+	// a linear field is reproduced exactly in a batch, serial or threaded.
+	std::mt19937 generator(17);
+	std::uniform_real_distribution<double> distribution(0.0, 9.0);
+	std::vector<point> queries;
+	for (auto i = 0; i < 1000; i++)
+	{
+		queries.emplace_back(distribution(generator), distribution(generator));
+	}
+	std::vector<double> linear;
+	for (const auto &p : grid)
+	{
+		linear.push_back(2.0 * p.x() - 3.0 * p.y() + 1.0);
+	}
+	interpolation_options threaded;
+	threaded.threads = 2;
+	threaded.parallel_threshold = 16;
+	std::vector<double> serial_values(queries.size()), threaded_values(queries.size());
+	interpolate_natural(field, linear, queries, serial_values.data());
+	interpolate_natural(field, linear, queries, threaded_values.data(), threaded);
+	for (std::size_t i = 0; i < queries.size(); i++)
+	{
+		EXPECT_NEAR(serial_values[i], 2.0 * queries[i].x() - 3.0 * queries[i].y() + 1.0, 1e-11);
+		EXPECT_EQ(serial_values[i], threaded_values[i]);
+	}
+}
+
+TEST(ContourTests, linearFieldTest)
+{
+	using point = point<double>;
+
+	// the isolines of a linear field are straight, open and exact; higher values lie on their left.
+	std::mt19937 generator(45);
+	std::uniform_real_distribution<double> coordinate(0.0, 10.0);
+	std::vector<point> points{ { 0.0, 0.0 }, { 10.0, 0.0 }, { 10.0, 10.0 }, { 0.0, 10.0 } };
+	for (auto i = 0; i < 2000; i++)
+	{
+		points.emplace_back(coordinate(generator), coordinate(generator));
+	}
+	delaunay<point> del(points);
+	del.triangulate();
+	std::vector<double> values{};
+	for (const auto &p : points)
+	{
+		values.push_back(p.x() + 2.0 * p.y());
+	}
+	const std::vector<double> levels{ 25.0, 0.5, 12.25, 29.0, 40.0 };
+	const auto lines = extract_contours(del.mesh(), values, levels);
+
+	ASSERT_EQ(lines.size(), 4);
+	const std::size_t expected[] = { 1, 2, 0, 3 };
+	for (std::size_t i = 0; i < lines.size(); i++)
+	{
+		const auto &line = lines[i];
+		EXPECT_EQ(line.level, expected[i]);
+		EXPECT_FALSE(line.closed);
+		ASSERT_GE(line.points.size(), 2);
+		for (const auto &p : line.points)
+		{
+			EXPECT_NEAR(p.x() + 2.0 * p.y(), levels[line.level], 1e-9);
+		}
+		const auto dx = line.points.back().x() - line.points.front().x();
+		const auto dy = line.points.back().y() - line.points.front().y();
+		EXPECT_GT(-dy + 2.0 * dx, 0.0);
+		// both ends lie on the square's boundary.
+		for (const auto &p : { line.points.front(), line.points.back() })
+		{
+			EXPECT_NEAR(std::min(std::min(p.x(), 10.0 - p.x()), std::min(p.y(), 10.0 - p.y())), 0.0, 1e-9);
+		}
+	}
+	EXPECT_THROW(extract_contours(del.mesh(), std::vector<double>(3, 0.0), levels), std::runtime_error);
+}
+
+TEST(ContourTests, closedLinesTest)
+{
+	using point = point<double>;
+
+	// rings around a peak, with levels through grid vertices, traced alike on several threads.
+	std::vector<point> points{};
+	std::vector<double> values{};
+	for (auto i = 0; i <= 40; i++)
+	{
+		for (auto j = 0; j <= 40; j++)
+		{
+			points.emplace_back(i * 0.25, j * 0.25);
+			values.push_back(-((i - 20) * (i - 20) + (j - 20) * (j - 20)) * 0.0625);
+		}
+	}
+	delaunay<point> del(points);
+	del.triangulate();
+	std::vector<double> levels{};
+	for (auto k = 1; k <= 400; k++)
+	{
+		levels.push_back(-0.0625 * k);
+	}
+	const auto lines = extract_contours(del.mesh(), values, levels);
+	contour_options options{};
+	options.threads = 3;
+	options.parallel_threshold = 0;
+	const auto threaded = extract_contours(del.mesh(), values, levels, options);
+
+	ASSERT_EQ(lines.size(), threaded.size());
+	std::size_t closed = 0;
+	for (std::size_t i = 0; i < lines.size(); i++)
+	{
+		EXPECT_EQ(lines[i].level, threaded[i].level);
+		ASSERT_EQ(lines[i].points.size(), threaded[i].points.size());
+		if (i > 0)
+		{
+			EXPECT_LE(levels[lines[i - 1].level], levels[lines[i].level]);
+		}
+		if (!lines[i].closed)
+		{
+			continue;
+		}
+		closed++;
+		// a ring of radius r, up to the error of linear interpolation, running counter clockwise around the peak.
+		const auto radius = std::sqrt(-levels[lines[i].level]);
+		auto area = 0.0;
+		for (std::size_t j = 0; j < lines[i].points.size(); j++)
+		{
+			const auto &a = lines[i].points[j];
+			const auto &b = lines[i].points[(j + 1) % lines[i].points.size()];
+			EXPECT_NEAR(std::hypot(a.x() - 5.0, a.y() - 5.0), radius, 0.02 / radius);
+			area += 0.5 * ((a.x() - 5.0) * (b.y() - 5.0) - (b.x() - 5.0) * (a.y() - 5.0));
+		}
+		EXPECT_GT(area, 0.0);
+	}
+	// one ring per level; the largest touches the square's sides at vertices that count as below it.
+	EXPECT_EQ(closed, 400);
+}
+
+TEST(SimplifyTests, errorBoundTest)
+{
+	using point = point<double>;
+
+	// a raster of a smooth bump, simplified until every sample lies within the bound of the surface.
+	std::vector<point> points{};
+	std::vector<double> heights{};
+	for (auto i = 0; i <= 60; i++)
+	{
+		for (auto j = 0; j <= 60; j++)
+		{
+			points.emplace_back(i, j);
+			heights.push_back(20.0 * std::exp(-((i - 25) * (i - 25) + (j - 35) * (j - 35)) / 200.0) + 0.1 * i);
+		}
+	}
+	delaunay<point> del(points);
+	simplification_options options{};
+	options.max_error = 0.05;
+	const auto count = simplify(del.mesh(), heights, options);
+	const auto &mesh = del.mesh();
+	expect_valid_delaunay(mesh);
+
+	std::size_t inserted = 0;
+	const auto &triangles = mesh.triangles();
+	for (std::size_t v = 0; v < points.size(); v++)
+	{
+		if (mesh.is_inserted(v))
+		{
+			inserted++;
+			continue;
+		}
+		const auto t = mesh.locate(points[v]);
+		ASSERT_FALSE(mesh.is_ghost(t));
+		const auto &a = points[triangles[3 * t]];
+		const auto &b = points[triangles[3 * t + 1]];
+		const auto &c = points[triangles[3 * t + 2]];
+		const auto area = predicates::orient2d(a, b, c);
+		const auto wa = predicates::orient2d(b, c, points[v]) / area;
+		const auto wb = predicates::orient2d(c, a, points[v]) / area;
+		const auto wc = 1.0 - wa - wb;
+		const auto surface = wa * heights[triangles[3 * t]] + wb * heights[triangles[3 * t + 1]] + wc * heights[triangles[3 * t + 2]];
+		EXPECT_LE(std::abs(surface - heights[v]), options.max_error + 1e-9);
+	}
+	EXPECT_EQ(inserted, count);
+	EXPECT_GT(count, 4);
+	EXPECT_LT(count, points.size() / 4);
+	EXPECT_THROW(simplify(del.mesh(), std::vector<double>(3, 0.0)), std::runtime_error);
+}
+
+TEST(SimplifyTests, vertexBudgetTest)
+{
+	using point = point<double>;
+
+	// random samples of a rough surface: the budget stops the insertion, and a tighter budget gives a subset.
+	std::mt19937 generator(46);
+	std::uniform_real_distribution<double> coordinate(0.0, 100.0);
+	std::vector<point> points{};
+	std::vector<double> heights{};
+	for (auto i = 0; i < 5000; i++)
+	{
+		points.emplace_back(coordinate(generator), coordinate(generator));
+		heights.push_back(std::sin(points.back().x() * 0.3) * std::cos(points.back().y() * 0.2) * 10.0);
+	}
+	delaunay<point> del(points);
+	simplification_options options{};
+	options.max_vertices = 300;
+	EXPECT_EQ(simplify(del.mesh(), heights, options), 300);
+	expect_valid_delaunay(del.mesh());
+	std::vector<bool> large(points.size());
+	for (std::size_t v = 0; v < points.size(); v++)
+	{
+		large[v] = del.mesh().is_inserted(v);
+	}
+
+	// greedy insertion is deterministic, so the first 100 vertices are among the first 300.
+	options.max_vertices = 100;
+	EXPECT_EQ(simplify(del.mesh(), heights, options), 100);
+	std::size_t count = 0;
+	for (std::size_t v = 0; v < points.size(); v++)
+	{
+		if (del.mesh().is_inserted(v))
+		{
+			count++;
+			EXPECT_TRUE(large[v]);
+		}
+	}
+	EXPECT_EQ(count, 100);
+}
+
+TEST(SimplifyTests, repeatedPositionTest)
+{
+	using point = point<double>;
+
+	// samples on a small grid share positions with different heights; each position is inserted once.
+	std::mt19937 generator(24);
+	std::uniform_int_distribution<int> coordinate(0, 3);
+	std::uniform_real_distribution<double> height(0.0, 10.0);
+	std::vector<point> points{};
+	std::vector<double> heights{};
+	for (auto i = 0; i < 44; i++)
+	{
+		points.emplace_back(coordinate(generator), coordinate(generator));
+		heights.push_back(height(generator));
+	}
+	auto positions = points;
+	std::sort(positions.begin(), positions.end(), [](const point &a, const point &b)
+	{
+		return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());
+	});
+	const auto distinct = static_cast<std::size_t>(std::unique(positions.begin(), positions.end()) - positions.begin());
+
+	delaunay<point> del(points);
+	EXPECT_EQ(simplify(del.mesh(), heights), distinct);
+	expect_valid_delaunay(del.mesh());
+}
+
+template<typename MeshType, typename PointType>
+void expect_segment_cover(const MeshType &mesh, const PointType &a, const PointType &b,
+	const std::vector<segment_crossing> &crossings)
+{
+	// the crossings cover the segment in order, each over a piece inside its triangle.
+	ASSERT_FALSE(crossings.empty());
+	EXPECT_EQ(crossings.front().entry, 0.0);
+	EXPECT_EQ(crossings.back().exit, 1.0);
+	const auto &triangles = mesh.triangles();
+	for (std::size_t i = 0; i < crossings.size(); i++)
+	{
+		const auto &crossing = crossings[i];
+		EXPECT_LT(crossing.entry, crossing.exit);
+		if (i > 0)
+		{
+			EXPECT_EQ(crossing.entry, crossings[i - 1].exit);
+		}
+		ASSERT_FALSE(mesh.is_ghost(crossing.triangle));
+		const auto s = 0.5 * (crossing.entry + crossing.exit);
+		const auto x = a.x() + s * (b.x() - a.x());
+		const auto y = a.y() + s * (b.y() - a.y());
+		for (std::size_t k = 0; k < 3; k++)
+		{
+			const auto &u = mesh.vertex(triangles[3 * crossing.triangle + k]);
+			const auto &v = mesh.vertex(triangles[3 * crossing.triangle + (k + 1) % 3]);
+			EXPECT_GE((v.x() - u.x()) * (y - u.y()) - (v.y() - u.y()) * (x - u.x()), -1e-9);
+		}
+	}
+}
+
+TEST(SegmentWalkTests, randomSegmentsTest)
+{
+	using point = point<double>;
+
+	// segments between random points, and their crossings found by testing every triangle.
+	std::mt19937 generator(49);
+	std::uniform_real_distribution<double> coordinate(0.0, 100.0);
+	std::vector<point> points{ { 0.0, 0.0 }, { 100.0, 0.0 }, { 100.0, 100.0 }, { 0.0, 100.0 } };
+	for (auto i = 0; i < 1000; i++)
+	{
+		points.emplace_back(coordinate(generator), coordinate(generator));
+	}
+	delaunay<point> del(points);
+	del.triangulate();
+	const auto &mesh = del.mesh();
+	const auto &triangles = mesh.triangles();
+	std::vector<point> from{}, to{};
+	std::vector<segment_crossing> crossings{};
+	for (auto i = 0; i < 100; i++)
+	{
+		from.emplace_back(coordinate(generator), coordinate(generator));
+		to.emplace_back(coordinate(generator), coordinate(generator));
+		crossings.clear();
+		walk_segment(mesh, from.back(), to.back(), [&crossings](const segment_crossing &crossing)
+		{
+			crossings.push_back(crossing);
+		});
+		expect_segment_cover(mesh, from.back(), to.back(), crossings);
+
+		std::set<std::size_t> expected{};
+		for (std::size_t t = 0; t < mesh.triangle_count(); t++)
+		{
+			if (mesh.is_ghost(t))
+			{
+				continue;
+			}
+			// clip the segment's parameter range by the three edges.
+			auto low = 0.0, high = 1.0;
+			for (std::size_t k = 0; k < 3; k++)
+			{
+				const auto &u = points[triangles[3 * t + k]];
+				const auto &v = points[triangles[3 * t + (k + 1) % 3]];
+				const auto &p = from.back();
+				const auto &q = to.back();
+				const auto start = (v.x() - u.x()) * (p.y() - u.y()) - (v.y() - u.y()) * (p.x() - u.x());
+				const auto change = (v.x() - u.x()) * (q.y() - p.y()) - (v.y() - u.y()) * (q.x() - p.x());
+				if (change > 0.0)
+				{
+					low = std::max(low, -start / change);
+				}
+				else if (change < 0.0)
+				{
+					high = std::min(high, -start / change);
+				}
+				else if (start < 0.0)
+				{
+					high = -1.0;
+				}
+			}
+			if (high - low > 1e-9)
+			{
+				expected.insert(t);
+			}
+		}
+		std::set<std::size_t> found{};
+		for (const auto &crossing : crossings)
+		{
+			if (crossing.exit - crossing.entry > 1e-9)
+			{
+				found.insert(crossing.triangle);
+			}
+		}
+		EXPECT_EQ(found, expected);
+	}
+
+	// the batch gives the same crossings on any number of threads.
+	segment_walk_options options{};
+	options.threads = 3;
+	options.parallel_threshold = 0;
+	const auto batch = walk_segments(mesh, from, to, options);
+	const auto serial = walk_segments(mesh, from, to);
+	ASSERT_EQ(batch.offsets, serial.offsets);
+	ASSERT_EQ(batch.crossings.size(), serial.crossings.size());
+	for (std::size_t i = 0; i < batch.crossings.size(); i++)
+	{
+		EXPECT_EQ(batch.crossings[i].triangle, serial.crossings[i].triangle);
+		EXPECT_EQ(batch.crossings[i].exit, serial.crossings[i].exit);
+	}
+	EXPECT_THROW(walk_segments(mesh, from, std::vector<point>{}), std::runtime_error);
+}
+
+TEST(SegmentWalkTests, gridTest)
+{
+	using point = point<double>;
+
+	// segments through grid vertices and along grid edges, from vertices and from edges.
+	std::vector<point> points{};
+	for (auto i = 0; i <= 10; i++)
+	{
+		for (auto j = 0; j <= 10; j++)
+		{
+			points.emplace_back(i, j);
+		}
+	}
+	delaunay<point> del(points);
+	del.triangulate();
+	const auto &mesh = del.mesh();
+	const std::vector<std::pair<point, point>> segments{
+		{ { 0.0, 0.0 }, { 10.0, 10.0 } }, { { 10.0, 10.0 }, { 0.0, 0.0 } }, { { 0.0, 3.0 }, { 10.0, 3.0 } },
+		{ { 2.5, 3.0 }, { 2.5, 9.0 } }, { { 2.0, 3.5 }, { 7.0, 3.5 } }, { { 1.0, 1.0 }, { 9.0, 5.0 } },
+		{ { 0.5, 0.0 }, { 9.5, 0.0 } }, { { 3.0, 3.0 }, { 3.0, 3.5 } }, { { 4.0, 4.0 }, { 4.0, 4.0 } } };
+	for (const auto &segment : segments)
+	{
+		std::vector<segment_crossing> crossings{};
+		walk_segment(mesh, segment.first, segment.second, [&crossings](const segment_crossing &crossing)
+		{
+			crossings.push_back(crossing);
+		});
+		expect_segment_cover(mesh, segment.first, segment.second, crossings);
+	}
+
+	// leaving the hull stops the walk, and a start outside the hull crosses nothing.
+	std::vector<segment_crossing> crossings{};
+	walk_segment(mesh, point(5.0, 5.5), point(5.0, 20.0), [&crossings](const segment_crossing &crossing)
+	{
+		crossings.push_back(crossing);
+	});
+	ASSERT_FALSE(crossings.empty());
+	EXPECT_NEAR(crossings.back().exit, 4.5 / 14.5, 1e-12);
+	EXPECT_EQ(walk_segment(mesh, point(-1.0, 5.0), point(5.0, 5.0), [](const segment_crossing &) { FAIL(); }), invalid_index);
+}
+
+TEST(StreamingTests, matchesInMemoryTest)
+{
+	using point = point<double>;
+	using triangle_key = std::array<std::size_t, 3>;
+	auto make_key = [](std::size_t a, std::size_t b, std::size_t c)
+	{
+		triangle_key key{ { a, b, c } };
+		std::rotate(key.begin(), std::min_element(key.begin(), key.end()), key.end());
+		return key;
+	};
+
+	std::mt19937 generator(11);
+	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+	std::vector<point> data;
+	for (auto i = 0; i < 3000; i++)
+	{
+		data.emplace_back(20.0 * distribution(generator), distribution(generator));
+	}
+	std::sort(data.begin(), data.end(), [](const point &first, const point &second) { return first.x() < second.x(); });
+
+	mesh<point> reference(data);
+	reference.triangulate();
+	std::set<triangle_key> expected;
+	for (std::size_t t = 0; t < reference.triangle_count(); t++)
+	{
+		if (!reference.is_ghost(t))
+		{
+			expected.insert(make_key(reference.triangles()[3 * t], reference.triangles()[3 * t + 1], reference.triangles()[3 * t + 2]));
+		}
+	}
+
+	// without and with bounds, the latter also finishes the hull.
+	for (auto bounded = 0; bounded < 2; bounded++)
+	{
+		streaming_options options;
+		options.tile_size = 50;
+		if (bounded)
+		{
+			options.min_y = 0.0;
+			options.max_y = 1.0;
+			options.max_x = 20.0;
+		}
+		std::set<triangle_key> streamed;
+		streaming_delaunay<point> stream([&](std::size_t a, std::size_t b, std::size_t c)
+		{
+			EXPECT_TRUE(streamed.insert(make_key(a, b, c)).second);
+		}, options);
+		stream.push(data.begin(), data.end());
+		EXPECT_LT(stream.peak_working_set(), data.size() * 10);
+		stream.finish();
+		EXPECT_EQ(streamed, expected);
+	}
+}
+
+TEST(StreamingTests, degenerateInputTest)
+{
+	using point = point<double>;
+
+	// a grid streamed column by column, with duplicates.
+	std::vector<point> grid;
+	for (auto i = 0; i < 30; i++)
+	{
+		for (auto j = 0; j < 10; j++)
+		{
+			grid.emplace_back(i, j);
+			if (i == 15 && j == 3)
+			{
+				grid.emplace_back(i, j);
+			}
+		}
+	}
+	streaming_options options;
+	options.tile_size = 10;
+	std::size_t count = 0;
+	streaming_delaunay<point> stream([&count](std::size_t, std::size_t, std::size_t) { count++; }, options);
+	stream.push(grid.begin(), grid.end());
+	stream.finish();
+	EXPECT_EQ(count, 2 * 29 * 9);
+
+	// unsorted input and an exhausted budget are reported.
+	streaming_delaunay<point> unsorted([](std::size_t, std::size_t, std::size_t) {});
+	unsorted.push({ 1.0, 0.0 });
+	EXPECT_THROW(unsorted.push({ 0.0, 0.0 }), std::runtime_error);
+
+	options.memory_budget = 1000;
+	streaming_delaunay<point> small([](std::size_t, std::size_t, std::size_t) {}, options);
+	EXPECT_THROW(small.push(grid.begin(), grid.end()), std::runtime_error);
+}
+
+TEST(PredicateTests, orientation3dTest)
+{
+	const double a[3] = { 0.0, 0.0, 0.0 };
+	const double b[3] = { 1.0, 0.0, 0.0 };
+	const double c[3] = { 0.0, 1.0, 0.0 };
+	const double d[3] = { 0.0, 0.0, 1.0 };
+	const double inside[3] = { 0.2, 0.2, 0.2 };
+	const double on[3] = { 1.0, 1.0, 0.0 };
+	const double coplanar[3] = { 0.1, 0.3, 0.0 };
+	const double above[3] = { 0.1, 0.3, 1e-300 };
+	EXPECT_GT(predicates::orient3d(a, b, c, d), 0.0);
+	EXPECT_LT(predicates::orient3d(a, c, b, d), 0.0);
+	EXPECT_EQ(predicates::orient3d(a, b, c, coplanar), 0.0);
+	EXPECT_GT(predicates::orient3d(a, b, c, above), 0.0);
+	EXPECT_GT(predicates::insphere(a, b, c, d, inside), 0.0);
+	EXPECT_EQ(predicates::insphere(a, b, c, d, on), 0.0);
+	EXPECT_LT(predicates::insphere(a, c, b, d, inside), 0.0);
+}
+
+TEST(TetrahedralizationTests, randomCloudTest)
+{
+	using point = point<double, 3>;
+	using tetrahedralization = tetrahedralization<point>;
+
+	std::mt19937 generator(5);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+	std::vector<point> data;
+	for (auto i = 0; i < 400; i++)
+	{
+		data.emplace_back(distribution(generator), distribution(generator), distribution(generator));
+	}
+	tetrahedralization mesh(data);
+	mesh.tetrahedralize();
+
+	const auto &tetrahedra = mesh.tetrahedra();
+	const auto &neighbors = mesh.neighbors();
+	std::size_t finite = 0;
+	for (std::size_t t = 0; t < mesh.tetrahedron_count(); t++)
+	{
+		for (std::size_t i = 0; i < 4; i++)
+		{
+			ASSERT_EQ(neighbors[neighbors[4 * t + i]], 4 * t + i);
+		}
+		if (mesh.is_ghost(t))
+		{
+			continue;
+		}
+		finite++;
+		const auto &a = mesh.vertex(tetrahedra[4 * t]);
+		const auto &b = mesh.vertex(tetrahedra[4 * t + 1]);
+		const auto &c = mesh.vertex(tetrahedra[4 * t + 2]);
+		const auto &d = mesh.vertex(tetrahedra[4 * t + 3]);
+		ASSERT_GT(predicates::orient3d(a, b, c, d), 0.0);
+		for (std::size_t v = 0; v < mesh.vertex_count(); v++)
+		{
+			ASSERT_LE(predicates::insphere(a, b, c, d, mesh.vertex(v)), 0.0);
+		}
+	}
+	EXPECT_EQ(finite, mesh.finite_tetrahedron_count());
+	for (std::size_t v = 0; v < mesh.vertex_count(); v++)
+	{
+		EXPECT_TRUE(mesh.is_inserted(v));
+	}
+}
+
+TEST(TetrahedralizationTests, degenerateInputTest)
+{
+	using point = point<double, 3>;
+	using tetrahedralization = tetrahedralization<point>;
+
+	// cospherical grid points fill the cube.
+	std::vector<point> grid;
+	for (auto i = 0; i < 5; i++)
+	{
+		for (auto j = 0; j < 5; j++)
+		{
+			for (auto k = 0; k < 5; k++)
+			{
+				grid.emplace_back(i, j, k);
+			}
+		}
+	}
+	tetrahedralization cube(grid);
+	cube.tetrahedralize();
+	const auto &tetrahedra = cube.tetrahedra();
+	auto volume = 0.0;
+	for (std::size_t t = 0; t < cube.tetrahedron_count(); t++)
+	{
+		if (!cube.is_ghost(t))
+		{
+			volume += predicates::orient3d(cube.vertex(tetrahedra[4 * t]), cube.vertex(tetrahedra[4 * t + 1]),
+				cube.vertex(tetrahedra[4 * t + 2]), cube.vertex(tetrahedra[4 * t + 3])) / 6.0;
+		}
+	}
+	EXPECT_NEAR(volume, 64.0, 1e-9);
+
+	// coplanar points give no tetrahedra until a point leaves the plane; duplicates are ignored.
+	tetrahedralization flat({ { 0.0, 0.0, 0.0 }, { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 1.0, 1.0, 0.0 } });
+	flat.tetrahedralize();
+	EXPECT_EQ(flat.finite_tetrahedron_count(), 0);
+	auto apex = flat.add_vertex({ 0.5, 0.5, 1.0 });
+	flat.insert(apex);
+	EXPECT_EQ(flat.finite_tetrahedron_count(), 2);
+	auto duplicate = flat.add_vertex({ 1.0, 1.0, 0.0 });
+	EXPECT_EQ(flat.insert(duplicate), 3);
+	EXPECT_FALSE(flat.is_inserted(duplicate));
+}
+
+TEST(MeshIOTests, indexedBinaryRoundTrip)
+{
+	using point = point<double>;
+
+	delaunay<point> del({ { 0.0, 0.0 }, { 4.0, 0.0 }, { 4.0, 3.0 }, { 0.0, 3.0 }, { 2.0, 1.5 } });
+	del.triangulate();
+	const auto &mesh = del.mesh();
+
+	const std::string path = "delaunaypp_mesh_test.bin";
+	io::write_indexed_binary(path, mesh);
+	auto loaded = io::read_indexed_binary<point>(path);
+
+	// counts whose sizes wrap around are rejected before anything is allocated.
+	io::mesh_file_header header{};
+	std::string contents;
+	{
+		io::mapped_file file(path);
+		std::memcpy(&header, file.data(), sizeof(header));
+		contents.assign(file.data() + sizeof(header), file.size() - sizeof(header));
+	}
+	for (const auto &counts : { std::make_pair(header.vertex_count + (std::uint64_t(1) << 60), header.triangle_count),
+		std::make_pair(header.vertex_count, header.triangle_count + (std::uint64_t(1) << 62)) })
+	{
+		auto changed = header;
+		changed.vertex_count = counts.first;
+		changed.triangle_count = counts.second;
+		io::file_writer writer(path);
+		writer.write_value(changed);
+		writer.write(contents.data(), contents.size());
+		writer.close();
+		EXPECT_THROW(io::read_indexed_binary<point>(path), std::runtime_error);
+	}
+	std::remove(path.c_str());
+
+	EXPECT_EQ(loaded.vertices, mesh.vertices());
+	ASSERT_EQ(loaded.triangles.size(), 3 * mesh.finite_triangle_count());
+	for (std::size_t i = 0; i < loaded.triangles.size(); i += 3)
+	{
+		EXPECT_GT(predicates::orient2d(loaded.vertices[loaded.triangles[i]],
+			loaded.vertices[loaded.triangles[i + 1]], loaded.vertices[loaded.triangles[i + 2]]), 0.0);
+	}
+}
+
+TEST(MeshIOTests, snapshotTest)
+{
+	using point = point<double>;
+
+	std::mt19937 generator(37);
+	std::uniform_real_distribution<double> distribution(-5.0, 5.0);
+	std::vector<point> cloud;
+	for (auto i = 0; i < 3000; i++)
+	{
+		cloud.emplace_back(distribution(generator), distribution(generator));
+	}
+	cloud.push_back(cloud[10]);
+	mesh<point> triangulation(cloud);
+	triangulation.triangulate();
+
+	const std::string path = "delaunaypp_snapshot_test.bin";
+	io::write_snapshot(path, triangulation);
+	{
+		io::mapped_mesh<point> snapshot(path);
+		ASSERT_EQ(snapshot.vertex_count(), triangulation.vertex_count());
+		ASSERT_EQ(snapshot.triangle_count(), triangulation.triangle_count());
+		EXPECT_EQ(snapshot.finite_triangle_count(), triangulation.finite_triangle_count());
+		EXPECT_TRUE(std::equal(snapshot.triangles().begin(), snapshot.triangles().end(), triangulation.triangles().begin()));
+		EXPECT_TRUE(std::equal(snapshot.halfedges().begin(), snapshot.halfedges().end(), triangulation.halfedges().begin()));
+		for (std::size_t v = 0; v < cloud.size(); v++)
+		{
+			EXPECT_EQ(snapshot.vertex(v), cloud[v]);
+			EXPECT_EQ(snapshot.vertex_edge(v), triangulation.vertex_edge(v));
+		}
+		EXPECT_FALSE(snapshot.is_inserted(cloud.size() - 1));
+		EXPECT_EQ(snapshot.hull(), triangulation.hull());
+
+		// point location works straight from the mapping. Outside the hull any ghost of a visible hull edge
+		// may be returned.
+		for (auto i = 0; i < 200; i++)
+		{
+			const point query(1.2 * distribution(generator), 1.2 * distribution(generator));
+			const auto expected = triangulation.locate(query);
+			const auto actual = snapshot.locate(query);
+			if (triangulation.is_ghost(expected))
+			{
+				EXPECT_TRUE(snapshot.is_ghost(actual));
+			}
+			else
+			{
+				EXPECT_EQ(actual, expected);
+			}
+		}
+	}
+
+	// a file of the wrong kind or length is rejected.
+	io::write_indexed_binary(path, triangulation);
+	EXPECT_THROW(io::mapped_mesh<point> wrong(path), std::runtime_error);
+	io::write_snapshot(path, triangulation);
+	{
+		std::FILE *file = std::fopen(path.c_str(), "ab");
+		std::fputc(0, file);
+		std::fclose(file);
+	}
+	EXPECT_THROW(io::mapped_mesh<point> truncated(path), std::runtime_error);
+
+	// so is a triangle count whose size wraps around to the real one.
+	io::write_snapshot(path, triangulation);
+	io::snapshot_header header{};
+	std::string contents;
+	{
+		io::mapped_file file(path);
+		std::memcpy(&header, file.data(), sizeof(header));
+		contents.assign(file.data() + sizeof(header), file.size() - sizeof(header));
+	}
+	header.triangle_count += std::uint64_t(1) << 60;
+	{
+		io::file_writer writer(path);
+		writer.write_value(header);
+		writer.write(contents.data(), contents.size());
+		writer.close();
+	}
+	EXPECT_THROW(io::mapped_mesh<point> wrapped(path), std::runtime_error);
+	std::remove(path.c_str());
+}
+
+TEST(MeshIOTests, plyTest)
+{
+	using point = point<double>;
+
+	delaunay<point> del({ { 0.0, 0.0 }, { 4.0, 0.0 }, { 4.0, 3.0 }, { 0.0, 3.0 } });
+	del.triangulate();
+
+	const std::string path = "delaunaypp_mesh_test.ply";
+	io::write_ply(path, del.mesh());
+	std::string contents;
+	{
+		io::mapped_file file(path);
+		contents.assign(file.data(), file.size());
+	}
+	std::remove(path.c_str());
+
+	auto header_end = contents.find("end_header\n");
+	ASSERT_NE(header_end, std::string::npos);
+	EXPECT_NE(contents.find("element vertex 4"), std::string::npos);
+	EXPECT_NE(contents.find("element face 2"), std::string::npos);
+	EXPECT_EQ(contents.size() - header_end - 11, 4 * 3 * sizeof(double) + 2 * 13);
+}
+
+TEST(MeshIOTests, compressedRoundTrip)
+{
+	using point = point<double>;
+
+	// integer points spanning 0 ... 1023 quantize exactly at 10 bits, so vertices can be matched by position.
+	std::mt19937 generator(17);
+	std::vector<point> cloud{ { 0.0, 0.0 }, { 1023.0, 1023.0 } };
+	std::set<point> seen(cloud.begin(), cloud.end());
+	while (cloud.size() < 3000)
+	{
+		const point candidate(static_cast<double>(generator() % 1024), static_cast<double>(generator() % 1024));
+		if (seen.insert(candidate).second)
+		{
+			cloud.push_back(candidate);
+		}
+	}
+	// a repeated point stays out of the triangulation but is kept.
+	cloud.push_back(cloud[5]);
+	delaunay<point> del(cloud);
+	del.triangulate();
+	const auto &mesh = del.mesh();
+
+	io::mesh_codec_options options{};
+	options.bits = 10;
+	const auto data = io::encode_mesh(mesh, options);
+	const auto raw = sizeof(io::mesh_file_header) + 2 * sizeof(double) * mesh.vertex_count() + 3 * 4 * mesh.finite_triangle_count();
+	EXPECT_LT(5 * data.size(), raw);
+	const auto decoded = io::decode_mesh<point>(data);
+
+	auto sorted_vertices = decoded.vertices;
+	std::sort(sorted_vertices.begin(), sorted_vertices.end());
+	std::sort(cloud.begin(), cloud.end());
+	EXPECT_EQ(sorted_vertices, cloud);
+	auto corners = [](const std::vector<point> &vertices, const std::size_t &a, const std::size_t &b, const std::size_t &c)
+	{
+		std::array<point, 3> triangle{ vertices[a], vertices[b], vertices[c] };
+		std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+		return triangle;
+	};
+	std::set<std::array<point, 3>> expected{}, actual{};
+	const auto &triangles = mesh.triangles();
+	for (std::size_t t = 0; t < mesh.triangle_count(); t++)
+	{
+		if (!mesh.is_ghost(t))
+		{
+			expected.insert(corners(mesh.vertices(), triangles[3 * t], triangles[3 * t + 1], triangles[3 * t + 2]));
+		}
+	}
+	ASSERT_EQ(decoded.triangles.size(), 3 * mesh.finite_triangle_count());
+	for (std::size_t i = 0; i < decoded.triangles.size(); i += 3)
+	{
+		actual.insert(corners(decoded.vertices, decoded.triangles[i], decoded.triangles[i + 1], decoded.triangles[i + 2]));
+	}
+	EXPECT_EQ(actual, expected);
+
+	// arbitrary coordinates come back within a quantization step, through a file.
+	delaunay<point> small({ { 0.1, 0.2 }, { 4.3, -0.7 }, { 3.9, 3.3 }, { -0.2, 2.9 }, { 2.0, 1.5 } });
+	small.triangulate();
+	const std::string path = "delaunaypp_mesh_test.dppc";
+	io::write_compressed(path, small.mesh());
+	const auto loaded = io::read_compressed<point>(path);
+	std::remove(path.c_str());
+	ASSERT_EQ(loaded.vertices.size(), 5);
+	EXPECT_EQ(loaded.triangles.size(), 3 * small.mesh().finite_triangle_count());
+	for (const auto &vertex : small.mesh().vertices())
+	{
+		const auto nearest = *std::min_element(loaded.vertices.begin(), loaded.vertices.end(), [&vertex](const point &a, const point &b)
+		{
+			return delaunaypp::distance(a, vertex) < delaunaypp::distance(b, vertex);
+		});
+		EXPECT_NEAR(nearest.x(), vertex.x(), 4.5 / (1 << 20));
+		EXPECT_NEAR(nearest.y(), vertex.y(), 4.0 / (1 << 20));
+	}
+
+	// collinear points have no triangles, and damaged data is rejected.
+	delaunay<point> line({ { 0.0, 0.0 }, { 1.0, 1.0 }, { 2.0, 2.0 } });
+	line.triangulate();
+	const auto flat = io::decode_mesh<point>(io::encode_mesh(line.mesh()));
+	EXPECT_EQ(flat.vertices.size(), 3);
+	EXPECT_TRUE(flat.triangles.empty());
+	auto damaged = data;
+	damaged.resize(damaged.size() - 10);
+	EXPECT_THROW(io::decode_mesh<point>(damaged), std::runtime_error);
+	damaged[0] = 'X';
+	EXPECT_THROW(io::decode_mesh<point>(damaged), std::runtime_error);
+
+	// sizes in the header that the data cannot hold are rejected before anything is allocated.
+	io::compressed_mesh_header header{};
+	std::memcpy(&header, data.data(), sizeof(header));
+	auto crafted = [&](const io::compressed_mesh_header &changed)
+	{
+		auto copy = data;
+		std::memcpy(copy.data(), &changed, sizeof(changed));
+		return copy;
+	};
+	auto changed = header;
+	changed.vertex_count = std::uint64_t(1) << 40;
+	EXPECT_THROW(io::decode_mesh<point>(crafted(changed)), std::runtime_error);
+	changed = header;
+	changed.triangle_count = std::uint64_t(1) << 50;
+	EXPECT_THROW(io::decode_mesh<point>(crafted(changed)), std::runtime_error);
+	changed = header;
+	changed.connectivity_bytes = std::numeric_limits<std::uint64_t>::max() - 8;
+	EXPECT_THROW(io::decode_mesh<point>(crafted(changed)), std::runtime_error);
+	changed = header;
+	changed.dimension = 1u << 31;
+	EXPECT_THROW(io::decode_mesh<point>(crafted(changed)), std::runtime_error);
+}
+
+TEST(PointIOTests, binaryRoundTrip)
+{
+	using point = point<double>;
+
+	std::vector<point> data{ { 1.5, -2.25 }, { 1e-7, 3e12 }, { -0.1, 0.2 } };
+	const std::string path = "delaunaypp_points_test.bin";
+	io::write_binary_points(path, data);
+
+	{
+		io::mapped_points<point> mapped(path);
+		ASSERT_EQ(mapped.size(), data.size());
+		for (std::size_t i = 0; i < data.size(); i++)
+		{
+			EXPECT_EQ(mapped[i], data[i]);
+		}
+
+		const auto first = mapped.begin();
+		const auto last = mapped.end();
+		EXPECT_TRUE(last > first && first <= last && last >= first && !(first > first));
+		EXPECT_EQ(2 + first, first + 2);
+		EXPECT_EQ(first[2], *(last - 1));
+
+		// the mapped view feeds the triangulator directly.
+		delaunay<point> del(mapped.begin(), mapped.end());
+		EXPECT_EQ(del.triangulate().size(), 1);
+	}
+
+	// a count whose size wraps around is rejected, not mapped.
+	io::point_file_header header{};
+	{
+		io::mapped_file file(path);
+		std::memcpy(&header, file.data(), sizeof(header));
+	}
+	header.count = std::uint64_t(1) << 60;
+	{
+		io::file_writer writer(path);
+		writer.write_value(header);
+		writer.close();
+	}
+	EXPECT_THROW(io::mapped_points<point> wrapped(path), std::runtime_error);
+	std::remove(path.c_str());
+
+#if defined(__linux__)
+	// a failed flush still closes the file, once.
+	io::file_writer full("/dev/full");
+	const std::vector<char> block(1 << 16, 'x');
+	full.write(block.data(), block.size());
+	EXPECT_THROW(full.close(), std::runtime_error);
+	EXPECT_NO_THROW(full.close());
+#endif
+}
+
+TEST(PointIOTests, parseText)
+{
+	using point = point<double>;
+
+	const std::string text = "1\t2\n-3.5 4e2\r\n\n0.000125,-7.25E-3\n+6 +0.5e+1\n";
+	auto points = io::parse_text_points<point>(text.data(), text.data() + text.size());
+
+	ASSERT_EQ(points.size(), 4);
+	EXPECT_DOUBLE_EQ(points[0].x(), 1.0);
+	EXPECT_DOUBLE_EQ(points[0].y(), 2.0);
+	EXPECT_DOUBLE_EQ(points[1].x(), -3.5);
+	EXPECT_DOUBLE_EQ(points[1].y(), 400.0);
+	EXPECT_DOUBLE_EQ(points[2].x(), 0.000125);
+	EXPECT_DOUBLE_EQ(points[2].y(), -7.25e-3);
+	EXPECT_DOUBLE_EQ(points[3].x(), 6.0);
+	EXPECT_DOUBLE_EQ(points[3].y(), 5.0);
+
+	const std::string bad = "1\t\n";
+	EXPECT_THROW(io::parse_text_points<point>(bad.data(), bad.data() + bad.size()), std::runtime_error);
+	const std::string signs = "+-1 2\n";
+	EXPECT_THROW(io::parse_text_points<point>(signs.data(), signs.data() + signs.size()), std::runtime_error);
+}
+
+TEST(PointIOTests, textRoundTrip)
+{
+	using point = point<double>;
+
+	std::vector<point> data{ { 0.1, 1.0 / 3.0 }, { -123456.789, 2e-300 } };
+	const std::string path = "delaunaypp_points_test.txt";
+	io::write_text_points(path, data);
+	auto points = io::read_text_points<point>(path);
+	std::remove(path.c_str());
+
+	ASSERT_EQ(points.size(), data.size());
+	EXPECT_EQ(points[0], data[0]);
+	EXPECT_EQ(points[1], data[1]);
+}
@@ -5,6 +5,8 @@
 
 #include "demo/window.h"
 #include "delaunaypp/delaunay.h"
+#include "delaunaypp/graph.h"
+#include "delaunaypp/pointio.h"
 
 /**
 * Canvas class to draw points and triangles.
@@ -129,41 +131,33 @@ Window::Window(QWidget *parent) :
 void Window::onOpen()
 {
 	auto filename = QFileDialog::getOpenFileName(
-                this, "Load point .txt file", QString(), "*.txt");
+                this, "Load point file", QString(), "Point files (*.txt *.bin)");
+	if (filename.isEmpty()) {
+		return;
+	}
 
-	auto points = loadPoints(filename);	
-	canvas->addPoints(points, false);
+	try {
+		auto points = loadPoints(filename);
+		canvas->addPoints(points, false);
+	}
+	catch (const std::exception &error) {
+		QMessageBox::warning(this, "Error", error.what());
+	}
 }
 
 std::vector<Window::PointType> Window::loadPoints(QString filename) const
 {
-	std::vector<PointType> points;
-	QFile file(filename);
-	file.open(QIODevice::ReadOnly);
-	QTextStream stream(&file);
-	while (!stream.atEnd()){
-		auto line = stream.readLine();
-		auto list = line.split('\t');
-		if (list.length() > 0) {
-			auto x = list.at(0).toDouble();
-			auto y = list.at(1).toDouble();
-			PointType p(x, y);
-			points.push_back(p);
-		}
+	auto path = filename.toStdString();
+	if (filename.endsWith(".bin", Qt::CaseInsensitive)) {
+		delaunaypp::io::mapped_points<PointType> mapped(path);
+		return std::vector<PointType>(mapped.begin(), mapped.end());
 	}
-	file.close();
-	return points;
+	return delaunaypp::io::read_text_points<PointType>(path);
 }
 
 void Window::onSavePoints() {
 	auto points = canvas->getPoints();
-	QFile output("points.txt");
-	output.open(QIODevice::WriteOnly);
-	QTextStream ts(&output);
-	for (auto p : points) {
-		ts << QString::number(p.x()) << '\t' << QString::number(p.y()) << endl;
-	}
-	output.close();
+	delaunaypp::io::write_text_points("points.txt", points);
 	QMessageBox::about(this, "Success", "Point file saved successfully");
 }
 
@@ -183,15 +177,14 @@ void Window::onTriangulate() const
 	//get points and triangulate and redraw.
 	auto points = canvas->getPoints();
 	delaunaypp::delaunay<PointType> delaunay(points);
-	auto tris = delaunay.triangulate();
+	// triangulate the mesh directly, the triangle list delaunay::triangulate() builds is not needed.
+	auto &mesh = delaunay.mesh();
+	mesh.triangulate();
+	// draw every edge once instead of once per triangle.
 	std::vector<Canvas::EdgeType> edges;
-	for(const auto& tri: tris)
+	for(const auto& e: delaunaypp::unique_edges(mesh))
 	{
-		const auto tri_edges = tri.edges();
-		for(const auto& t_e: tri_edges)
-		{
-			edges.emplace_back(t_e);
-		}
+		edges.emplace_back(mesh.vertex(e.first), mesh.vertex(e.second));
 	}
 	canvas->drawSegments(edges);
 }